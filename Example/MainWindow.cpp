@@ -5,6 +5,7 @@
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QThread>
+#include <limits>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -13,6 +14,7 @@ MainWindow::MainWindow(QWidget* parent)
     m_columnCount(8)
     , // 默认8列
     m_useSampleData(true) // 默认使用示例数据
+    , m_pendingValueColumn(-1)
 {
     // 设置窗口标题和大小
     setWindowTitle("虚拟表格控件 - 千万级数据演示");
@@ -56,14 +58,18 @@ void MainWindow::onDataSizeChanged(int index)
     case 2: // 1000万条
         m_currentDataSize = 10000000;
         break;
-    case 3: // 自定义
+    case 3: // 10亿条
+        m_currentDataSize = 1000000000;
+        break;
+    case 4: // 自定义
+        // 上限是行索引（int）能表示的最大行数，滚动位置已是64位，不再受像素高度限制
         bool ok;
         int customSize = QInputDialog::getInt(this, "自定义数据量",
             "请输入数据量（条）:",
-            m_currentDataSize, 1000, 100000000, 1000, &ok);
+            m_currentDataSize, 1000, std::numeric_limits<int>::max(), 1000, &ok);
         if (ok) {
             m_currentDataSize = customSize;
-            m_dataSizeComboBox->setItemText(3, QString("自定义: %1条").arg(m_currentDataSize));
+            m_dataSizeComboBox->setItemText(4, QString("自定义: %1条").arg(m_currentDataSize));
         }
         return;
     }
@@ -82,8 +88,9 @@ void MainWindow::onOpenCsvFile()
         return;
     }
 
-    // 设置CSV文件路径
+    // 设置CSV文件路径，从文件开头的样本推断分隔符、引号和是否有表头
     m_csvFilePath = filePath;
+    m_csvDialect = CsvDialect::sniff(filePath);
     m_useSampleData = false;
 
     // 禁用数据量选择
@@ -143,6 +150,7 @@ void MainWindow::onBufferSizeChanged(int value)
 
     // 更新缓冲区大小
     m_tableView->setBufferSize(value);
+    m_gridView->setBufferSize(value);
 }
 
 void MainWindow::onJumpToRow()
@@ -152,12 +160,68 @@ void MainWindow::onJumpToRow()
 
     int rowIndex = m_jumpToRowSpinBox->value() - 1; // 转换为0-based索引
     if (rowIndex >= 0 && rowIndex < m_tableModel->rowCount()) {
-        m_tableView->jumpToRow(rowIndex);
+        if (isGridViewActive()) {
+            m_gridView->jumpToRow(rowIndex);
+        } else {
+            m_tableView->jumpToRow(rowIndex);
+        }
     } else {
         QMessageBox::warning(this, "警告", "无效的行号！");
     }
 }
 
+void MainWindow::onJumpToValue()
+{
+    int column = m_valueColumnComboBox->currentIndex();
+    QString value = m_jumpValueEdit->text().trimmed();
+    if (!m_tableModel || column < 0 || value.isEmpty())
+        return;
+
+    // 还没有索引时先建立，完成后再跳转
+    if (!m_tableModel->columnIndex(column)) {
+        if (m_tableModel->buildColumnIndex(column)) {
+            m_pendingValueColumn = column;
+            statusBar()->showMessage(QString("正在为列 \"%1\" 建立索引...").arg(m_valueColumnComboBox->currentText()));
+        }
+        return;
+    }
+
+    ColumnIndex::Match match = m_valueMatchComboBox->currentIndex() == 0
+        ? ColumnIndex::Match::Equal
+        : ColumnIndex::Match::GreaterOrEqual;
+    int row = isGridViewActive()
+        ? m_gridView->jumpToValue(column, value, match)
+        : m_tableView->jumpToValue(column, value, match);
+    if (row == VirtualTableModel::SearchPending) {
+        statusBar()->showMessage("正在后台查找...", 5000);
+    } else if (row < 0) {
+        statusBar()->showMessage("没有找到匹配的行", 5000);
+    } else {
+        statusBar()->showMessage(QString("跳转到第 %1 行").arg(row + 1), 5000);
+    }
+}
+
+void MainWindow::onColumnIndexReady(int column, bool success)
+{
+    if (column != m_pendingValueColumn)
+        return;
+
+    m_pendingValueColumn = -1;
+    if (!success) {
+        statusBar()->showMessage("建立索引失败", 5000);
+        return;
+    }
+    if (m_valueColumnComboBox->currentIndex() == column) {
+        onJumpToValue();
+    }
+}
+
+void MainWindow::onViewModeChanged(int index)
+{
+    m_viewStack->setCurrentIndex(index);
+    attachModelToActiveView();
+}
+
 void MainWindow::onLoadingStatusChanged(LoadingStatus status)
 {
     // 根据加载状态更新UI
@@ -165,6 +229,8 @@ void MainWindow::onLoadingStatusChanged(LoadingStatus status)
     case LoadingStatus::Idle:
         m_loadingProgressBar->setVisible(false);
         m_loadingProgressBar->setValue(0);
+        m_loadAllButton->setText(m_tableModel && m_tableModel->isFullyLoaded() ? "已全部加载" : "加载全部");
+        m_loadAllButton->setEnabled(!m_tableModel || !m_tableModel->isFullyLoaded());
         break;
     case LoadingStatus::LoadingVisible:
         m_loadingProgressBar->setVisible(true);
@@ -175,20 +241,33 @@ void MainWindow::onLoadingStatusChanged(LoadingStatus status)
         m_loadingProgressBar->setValue(66);
         break;
     case LoadingStatus::LoadingAll:
+        // 实际进度由loadingProgress信号更新
         m_loadingProgressBar->setVisible(true);
-        m_loadingProgressBar->setValue(100);
+        m_loadAllButton->setText("取消加载全部");
         break;
     }
 }
 
+void MainWindow::onLoadAll()
+{
+    if (!m_tableModel)
+        return;
+
+    if (m_tableModel->loadingStatus() == LoadingStatus::LoadingAll) {
+        m_tableModel->cancelLoadAll();
+        return;
+    }
+    m_tableModel->loadAll();
+}
+
 void MainWindow::updateStatusInfo()
 {
     if (!m_tableView || !m_tableModel)
         return;
 
     // 更新可见范围信息
-    int startRow = m_tableView->visibleStartRow();
-    int endRow = m_tableView->visibleEndRow();
+    int startRow = isGridViewActive() ? m_gridView->visibleStartRow() : m_tableView->visibleStartRow();
+    int endRow = isGridViewActive() ? m_gridView->visibleEndRow() : m_tableView->visibleEndRow();
     m_visibleRangeLabel->setText(QString("可见范围: 第 %1-%2 行").arg(startRow + 1).arg(endRow + 1));
 
     // 更新状态标签
@@ -225,7 +304,30 @@ void MainWindow::initializeUI()
     // 创建表格视图
     m_tableView = new VirtualTableView(this);
     m_tableView->setFixedRowHeight(25); // 设置固定行高
-    mainLayout->addWidget(m_tableView, 1);
+    m_tableView->setKineticScrollingEnabled(true); // 启用惯性滚动
+
+    // 创建轻量视图，行高与标准视图一致
+    m_gridView = new VirtualGridView(this);
+    m_gridView->setRowHeight(25);
+
+    // Ctrl+C复制的结果显示在状态栏，包括超过复制上限时的提示
+    for (TableExporter* exporter : { m_tableView->exporter(), m_gridView->exporter() }) {
+        connect(exporter, &TableExporter::finished, this, [this](bool success, const QString &errorString) {
+            statusBar()->showMessage(success ? QString("已复制到剪贴板") : QString("复制失败: %1").arg(errorString), 5000);
+        });
+    }
+
+    // 汇总结果中双击一行展开该分组
+    connect(m_tableView, &QTableView::doubleClicked, this, [this](const QModelIndex &index) {
+        if (m_groupSource && m_tableModel && m_tableModel->dataSource() == m_groupSource) {
+            expandGroupRow(index.row());
+        }
+    });
+
+    m_viewStack = new QStackedWidget(this);
+    m_viewStack->addWidget(m_tableView);
+    m_viewStack->addWidget(m_gridView);
+    mainLayout->addWidget(m_viewStack, 1);
 
     // 创建状态栏
     statusBar()->addWidget(m_statusLabel);
@@ -245,6 +347,7 @@ QVBoxLayout* MainWindow::createControlPanel()
     m_dataSizeComboBox->addItem("10万条");
     m_dataSizeComboBox->addItem("100万条");
     m_dataSizeComboBox->addItem("1000万条");
+    m_dataSizeComboBox->addItem("10亿条");
     m_dataSizeComboBox->addItem("自定义");
     m_dataSizeComboBox->setCurrentIndex(1); // 默认100万条
     connect(m_dataSizeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -267,9 +370,49 @@ QVBoxLayout* MainWindow::createControlPanel()
     connect(useSampleButton, &QPushButton::clicked, this, &MainWindow::onUseSampleData);
     dataSourceLayout->addWidget(useSampleButton);
 
+    // 导出按钮，直接从数据源流式导出，不经过模型缓存
+    m_exporter = new TableExporter(this);
+    connect(m_exporter, &TableExporter::progressChanged, this, &MainWindow::onExportProgress);
+    connect(m_exporter, &TableExporter::finished, this, &MainWindow::onExportFinished);
+    m_exportButton = new QPushButton("导出数据");
+    connect(m_exportButton, &QPushButton::clicked, this, &MainWindow::onExportData);
+    dataSourceLayout->addWidget(m_exportButton);
+
+    // 加载全部：后台把整个数据源读入列式缓存，超出内存预算的部分写入临时文件
+    m_loadAllButton = new QPushButton("加载全部");
+    connect(m_loadAllButton, &QPushButton::clicked, this, &MainWindow::onLoadAll);
+    dataSourceLayout->addWidget(m_loadAllButton);
+
     dataSourceGroup->setLayout(dataSourceLayout);
     layout->addWidget(dataSourceGroup);
 
+    // 分组汇总：后台并行汇总，结果和分组成员都在同一个视图中显示
+    QGroupBox* groupByGroup = new QGroupBox("分组汇总");
+    QVBoxLayout* groupByLayout = new QVBoxLayout();
+    QHBoxLayout* groupColumnLayout = new QHBoxLayout();
+    groupColumnLayout->addWidget(new QLabel("分组列:"));
+    m_groupColumnComboBox = new QComboBox();
+    groupColumnLayout->addWidget(m_groupColumnComboBox);
+    groupByLayout->addLayout(groupColumnLayout);
+
+    m_aggregator = new GroupByAggregator(this);
+    connect(m_aggregator, &GroupByAggregator::progressChanged, this, &MainWindow::onGroupProgress);
+    connect(m_aggregator, &GroupByAggregator::finished, this, &MainWindow::onGroupFinished);
+    m_groupButton = new QPushButton("分组");
+    connect(m_groupButton, &QPushButton::clicked, this, &MainWindow::onGroupBy);
+    groupByLayout->addWidget(m_groupButton);
+    m_expandGroupButton = new QPushButton("展开选中分组");
+    m_expandGroupButton->setEnabled(false);
+    connect(m_expandGroupButton, &QPushButton::clicked, this, &MainWindow::onExpandGroup);
+    groupByLayout->addWidget(m_expandGroupButton);
+    m_showSourceButton = new QPushButton("返回原始数据");
+    m_showSourceButton->setEnabled(false);
+    connect(m_showSourceButton, &QPushButton::clicked, this, &MainWindow::onShowSourceData);
+    groupByLayout->addWidget(m_showSourceButton);
+
+    groupByGroup->setLayout(groupByLayout);
+    layout->addWidget(groupByGroup);
+
     // 性能设置
     QGroupBox* performanceGroup = new QGroupBox("性能设置");
     QVBoxLayout* performanceLayout = new QVBoxLayout();
@@ -311,6 +454,34 @@ QVBoxLayout* MainWindow::createControlPanel()
     bufferSizeLayout->addWidget(m_bufferSizeSpinBox);
     performanceLayout->addLayout(bufferSizeLayout);
 
+    // 视图模式
+    QHBoxLayout* viewModeLayout = new QHBoxLayout();
+    viewModeLayout->addWidget(new QLabel("视图:"));
+    m_viewModeComboBox = new QComboBox();
+    m_viewModeComboBox->addItem("标准视图");
+    m_viewModeComboBox->addItem("轻量视图");
+    m_viewModeComboBox->setCurrentIndex(0); // 默认标准视图
+    connect(m_viewModeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &MainWindow::onViewModeChanged);
+    viewModeLayout->addWidget(m_viewModeComboBox);
+    performanceLayout->addLayout(viewModeLayout);
+
+    // 性能叠加层：逐帧绘制耗时、data()调用、占位符和滚动到数据的延迟
+    QHBoxLayout* frameStatsLayout = new QHBoxLayout();
+    m_frameStatsCheckBox = new QCheckBox("性能叠加层");
+    connect(m_frameStatsCheckBox, &QCheckBox::toggled, this, &MainWindow::onFrameStatsToggled);
+    frameStatsLayout->addWidget(m_frameStatsCheckBox);
+    QPushButton* dumpFrameStatsButton = new QPushButton("输出帧统计");
+    connect(dumpFrameStatsButton, &QPushButton::clicked, this, [this]() {
+        if (isGridViewActive()) {
+            m_gridView->dumpFrameStats();
+        } else {
+            m_tableView->dumpFrameStats();
+        }
+    });
+    frameStatsLayout->addWidget(dumpFrameStatsButton);
+    performanceLayout->addLayout(frameStatsLayout);
+
     performanceGroup->setLayout(performanceLayout);
     layout->addWidget(performanceGroup);
 
@@ -325,7 +496,27 @@ QVBoxLayout* MainWindow::createControlPanel()
     m_jumpButton = new QPushButton("跳转");
     connect(m_jumpButton, &QPushButton::clicked, this, &MainWindow::onJumpToRow);
     jumpLayout->addWidget(m_jumpButton);
-    jumpGroup->setLayout(jumpLayout);
+
+    // 按列值跳转，使用列的二级索引
+    QHBoxLayout* valueLayout = new QHBoxLayout();
+    m_valueColumnComboBox = new QComboBox();
+    valueLayout->addWidget(m_valueColumnComboBox);
+    m_valueMatchComboBox = new QComboBox();
+    m_valueMatchComboBox->addItem("=");
+    m_valueMatchComboBox->addItem(">=");
+    valueLayout->addWidget(m_valueMatchComboBox);
+    m_jumpValueEdit = new QLineEdit();
+    m_jumpValueEdit->setPlaceholderText("值");
+    connect(m_jumpValueEdit, &QLineEdit::returnPressed, this, &MainWindow::onJumpToValue);
+    valueLayout->addWidget(m_jumpValueEdit);
+    QPushButton* jumpValueButton = new QPushButton("查找");
+    connect(jumpValueButton, &QPushButton::clicked, this, &MainWindow::onJumpToValue);
+    valueLayout->addWidget(jumpValueButton);
+
+    QVBoxLayout* jumpGroupLayout = new QVBoxLayout();
+    jumpGroupLayout->addLayout(jumpLayout);
+    jumpGroupLayout->addLayout(valueLayout);
+    jumpGroup->setLayout(jumpGroupLayout);
     layout->addWidget(jumpGroup);
 
     // 加载进度
@@ -360,18 +551,32 @@ void MainWindow::updateDataModel()
             return;
         }
 
-        auto csvDataSource = std::make_shared<CsvDataSource>(m_csvFilePath);
+        auto csvDataSource = std::make_shared<CsvDataSource>(m_csvFilePath, m_csvDialect);
         if (!csvDataSource->isValid()) {
             QMessageBox::critical(this, "错误", QString("无法加载CSV文件: %1").arg(csvDataSource->errorString()));
             return;
         }
 
         m_dataSource = csvDataSource;
+        const CsvDialect dialect = csvDataSource->dialect();
+        statusBar()->showMessage(QString("编码: %1，分隔符: %2，%3")
+                                     .arg(QString::fromLatin1(csvDataSource->encoding()))
+                                     .arg(dialect.delimiter == "\t" ? QString("Tab") : QString::fromLatin1(dialect.delimiter))
+                                     .arg(dialect.hasHeader ? "有表头" : "无表头"),
+            5000);
         // 更新列数和行数
         m_columnCount = csvDataSource->columnCount();
         m_currentDataSize = csvDataSource->rowCount();
     }
 
+    // 新数据源上没有分组结果
+    m_aggregator->cancel();
+    m_groupSource.reset();
+    m_expandGroupButton->setEnabled(false);
+    m_showSourceButton->setEnabled(false);
+    m_groupColumnComboBox->clear();
+    m_groupColumnComboBox->addItems(m_dataSource->headerData());
+
     // 创建新的模型
     if (m_tableModel) {
         delete m_tableModel;
@@ -386,9 +591,34 @@ void MainWindow::updateDataModel()
     // 连接加载状态变化信号
     connect(m_tableModel, &VirtualTableModel::loadingStatusChanged,
         this, &MainWindow::onLoadingStatusChanged);
+    connect(m_tableModel, &VirtualTableModel::loadingProgress,
+        m_loadingProgressBar, &QProgressBar::setValue);
+    m_loadAllButton->setText("加载全部");
+    m_loadAllButton->setEnabled(true);
+    connect(m_tableModel, &VirtualTableModel::columnIndexReady,
+        this, &MainWindow::onColumnIndexReady);
+    m_pendingValueColumn = -1;
+    m_valueColumnComboBox->clear();
+    m_valueColumnComboBox->addItems(m_dataSource->headerData());
+
+    // 文件数据源在后台统计各段的最小/最大值，统计结果保存在文件旁边，查找和展开分组时跳过不可能匹配的段
+    m_zoneMap.reset();
+    connect(m_tableModel, &VirtualTableModel::zoneMapReady, this, [this](bool success) {
+        if (success && m_tableModel->dataSource() == m_dataSource) {
+            m_zoneMap = m_tableModel->zoneMap();
+        }
+    });
+    if (!m_dataSource->persistentPath().isEmpty()) {
+        m_tableModel->buildZoneMap();
+    }
+
+    // QTableView的行表头会为每一行保存状态，超大数据量自动切换到轻量视图
+    if (m_currentDataSize > 50000000 && !isGridViewActive()) {
+        m_viewModeComboBox->setCurrentIndex(1);
+    }
 
     // 设置模型到视图
-    m_tableView->setVirtualModel(m_tableModel);
+    attachModelToActiveView();
 
     // 更新跳转行号的范围
     m_jumpToRowSpinBox->setRange(1, m_currentDataSize);
@@ -397,10 +627,221 @@ void MainWindow::updateDataModel()
     // 延迟执行跳转操作，确保视图已经完全初始化
     QTimer::singleShot(20, [this]() {
         if (m_tableView && m_tableModel) {
-            m_tableView->jumpToRow(0);
+            if (isGridViewActive()) {
+                m_gridView->jumpToRow(0);
+            } else {
+                m_tableView->jumpToRow(0);
+            }
         }
     });
 
     // 更新状态信息
     updateStatusInfo();
 }
+
+void MainWindow::attachModelToActiveView()
+{
+    // 两个视图不同时持有模型，避免隐藏的视图也维护行状态
+    if (isGridViewActive()) {
+        m_tableView->setVirtualModel(nullptr);
+        m_gridView->setVirtualModel(m_tableModel);
+    } else {
+        m_gridView->setVirtualModel(nullptr);
+        m_tableView->setVirtualModel(m_tableModel);
+    }
+}
+
+void MainWindow::onExportData()
+{
+    // 再次点击取消正在进行的导出
+    if (m_exporter->isRunning()) {
+        m_exporter->cancel();
+        return;
+    }
+
+    // 导出当前显示的数据（原始数据、汇总结果或分组成员）
+    std::shared_ptr<DataSource> source = m_tableModel ? m_tableModel->dataSource() : nullptr;
+    if (!source)
+        return;
+
+    QString filePath = QFileDialog::getSaveFileName(this, "导出数据", "",
+        "CSV Files (*.csv);;TSV Files (*.tsv *.txt)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    TableExporter::Format format = TableExporter::Format::Csv;
+    if (filePath.endsWith(".tsv", Qt::CaseInsensitive) || filePath.endsWith(".txt", Qt::CaseInsensitive)) {
+        format = TableExporter::Format::Tsv;
+    }
+
+    // 有选中行时只导出选中行
+    VirtualSelectionModel *selectionModel = isGridViewActive()
+        ? m_gridView->virtualSelectionModel()
+        : m_tableView->virtualSelectionModel();
+    RowRangeSet rows = selectionModel ? selectionModel->selectedRowSet() : RowRangeSet();
+
+    if (m_exporter->exportToFile(source, filePath, format, rows)) {
+        m_exportButton->setText("取消导出");
+        statusBar()->showMessage("正在导出...");
+    }
+}
+
+void MainWindow::onFrameStatsToggled(bool checked)
+{
+    m_tableView->setFrameStatsEnabled(checked);
+    m_tableView->setFrameStatsOverlayVisible(checked);
+    m_gridView->setFrameStatsEnabled(checked);
+    m_gridView->setFrameStatsOverlayVisible(checked);
+}
+
+void MainWindow::onExportProgress(qint64 rowsWritten, qint64 totalRows)
+{
+    int percent = totalRows > 0 ? static_cast<int>(rowsWritten * 100 / totalRows) : 100;
+    statusBar()->showMessage(QString("正在导出: %1/%2 行 (%3%)").arg(rowsWritten).arg(totalRows).arg(percent));
+}
+
+void MainWindow::onExportFinished(bool success, const QString &errorString)
+{
+    m_exportButton->setText("导出数据");
+    if (success) {
+        statusBar()->showMessage("导出完成", 5000);
+    } else {
+        statusBar()->showMessage(QString("导出失败: %1").arg(errorString), 5000);
+    }
+}
+
+void MainWindow::onGroupBy()
+{
+    // 再次点击取消正在进行的汇总
+    if (m_aggregator->isRunning()) {
+        m_aggregator->cancel();
+        return;
+    }
+
+    int keyColumn = m_groupColumnComboBox->currentIndex();
+    if (!m_dataSource || keyColumn < 0)
+        return;
+
+    // 其余各列都计算合计和平均，非数值列的结果为空
+    QVector<int> valueColumns;
+    for (int column = 0; column < m_dataSource->columnCount(); ++column) {
+        if (column != keyColumn)
+            valueColumns.append(column);
+    }
+
+    if (m_aggregator->aggregate(m_dataSource, keyColumn, valueColumns)) {
+        m_groupButton->setText("取消分组");
+        statusBar()->showMessage("正在分组汇总...");
+    }
+}
+
+void MainWindow::onExpandGroup()
+{
+    VirtualSelectionModel *selectionModel = isGridViewActive()
+        ? m_gridView->virtualSelectionModel()
+        : m_tableView->virtualSelectionModel();
+    RowRangeSet rows = selectionModel ? selectionModel->selectedRowSet() : RowRangeSet();
+    if (rows.isEmpty()) {
+        QMessageBox::information(this, "提示", "请先选中一个分组！");
+        return;
+    }
+
+    expandGroupRow(rows.ranges().first().first);
+}
+
+void MainWindow::expandGroupRow(int groupRow)
+{
+    if (!m_groupSource || m_aggregator->isRunning())
+        return;
+
+    if (m_aggregator->expandGroup(m_groupSource, groupRow, m_zoneMap)) {
+        m_groupButton->setText("取消分组");
+        statusBar()->showMessage(QString("正在查找分组 \"%1\" 的成员行...").arg(m_groupSource->groupKey(groupRow)));
+    }
+}
+
+void MainWindow::onShowSourceData()
+{
+    // 有分组结果时先回到汇总，再回到原始数据
+    if (m_groupSource && m_tableModel->dataSource() != m_groupSource) {
+        showDataSource(m_groupSource);
+        m_expandGroupButton->setEnabled(true);
+        return;
+    }
+
+    showDataSource(m_dataSource);
+    m_expandGroupButton->setEnabled(false);
+    m_showSourceButton->setEnabled(false);
+}
+
+void MainWindow::onGroupProgress(qint64 rowsProcessed, qint64 totalRows)
+{
+    int percent = totalRows > 0 ? static_cast<int>(rowsProcessed * 100 / totalRows) : 100;
+    statusBar()->showMessage(QString("正在分组: %1/%2 行 (%3%)").arg(rowsProcessed).arg(totalRows).arg(percent));
+}
+
+void MainWindow::onGroupFinished(bool success, const QString &errorString)
+{
+    m_groupButton->setText("分组");
+    if (!success) {
+        statusBar()->showMessage(QString("分组失败: %1").arg(errorString), 5000);
+        return;
+    }
+
+    std::shared_ptr<DataSource> result = m_aggregator->result();
+    auto groups = std::dynamic_pointer_cast<AggregateDataSource>(result);
+    auto members = std::dynamic_pointer_cast<RowSubsetDataSource>(result);
+
+    // 任务结束前已经切换了数据源，结果作废
+    std::shared_ptr<DataSource> base = groups ? groups->sourceDataSource()
+                                              : (members ? members->sourceDataSource() : nullptr);
+    if (base != m_dataSource)
+        return;
+    if (groups) {
+        // 汇总结果
+        m_groupSource = groups;
+        m_expandGroupButton->setEnabled(true);
+        statusBar()->showMessage(QString("分组完成: %1 个分组").arg(groups->rowCount()), 5000);
+    } else {
+        // 分组成员
+        m_expandGroupButton->setEnabled(false);
+        statusBar()->showMessage(QString("分组成员: %1 行").arg(result->rowCount()), 5000);
+    }
+    m_showSourceButton->setEnabled(true);
+    showDataSource(result);
+}
+
+void MainWindow::showDataSource(std::shared_ptr<DataSource> source)
+{
+    if (!m_tableModel || !source)
+        return;
+
+    m_tableModel->setDataSource(source);
+    m_loadAllButton->setText("加载全部");
+    m_loadAllButton->setEnabled(true);
+
+    // 列索引属于数据源，切换后按新的列重新选择
+    m_pendingValueColumn = -1;
+    m_valueColumnComboBox->clear();
+    m_valueColumnComboBox->addItems(source->headerData());
+    if (source == m_dataSource) {
+        m_tableModel->setZoneMap(m_zoneMap);
+    }
+
+    // 列数和内容都变了，重新估算列宽
+    if (isGridViewActive()) {
+        m_gridView->resizeColumnsToSampledContents();
+        m_gridView->jumpToRow(0);
+    } else {
+        m_tableView->resizeColumnsToSampledContents();
+        m_tableView->jumpToRow(0);
+    }
+    m_jumpToRowSpinBox->setRange(1, std::max(1, source->rowCount()));
+    updateStatusInfo();
+}
+
+bool MainWindow::isGridViewActive() const
+{
+    return m_viewStack && m_viewStack->currentIndex() == 1;
+}
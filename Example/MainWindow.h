@@ -13,10 +13,17 @@
 #include <QTimer>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QStackedWidget>
+#include <QCheckBox>
+#include <QLineEdit>
 #include "VirtualTableView.h"
+#include "VirtualGridView.h"
 #include "VirtualTableModel.h"
 #include "SampleDataSource.h"
 #include "CsvDataSource.h"
+#include "TableExporter.h"
+#include "GroupByAggregator.h"
+#include "RowSubsetDataSource.h"
 
 /**
  * @brief 主窗口类，用于展示虚拟表格控件的功能
@@ -73,6 +80,83 @@ private slots:
      */
     void onJumpToRow();
 
+    /**
+     * @brief 按列值跳转，列还没有索引时先在后台建立
+     */
+    void onJumpToValue();
+
+    /**
+     * @brief 处理列索引建立完成
+     * @param column 列索引
+     * @param success 是否成功
+     */
+    void onColumnIndexReady(int column, bool success);
+
+    /**
+     * @brief 处理视图模式变化
+     * @param index 选择的索引（0为标准视图，1为轻量视图）
+     */
+    void onViewModeChanged(int index);
+
+    /**
+     * @brief 导出选中行（未选中时为全部行）到文件，导出进行中时取消导出
+     */
+    void onExportData();
+
+    /**
+     * @brief 切换性能叠加层
+     * @param checked 是否显示
+     */
+    void onFrameStatsToggled(bool checked);
+
+    /**
+     * @brief 处理导出进度
+     * @param rowsWritten 已导出的行数
+     * @param totalRows 总行数
+     */
+    void onExportProgress(qint64 rowsWritten, qint64 totalRows);
+
+    /**
+     * @brief 处理导出结束
+     * @param success 是否成功
+     * @param errorString 失败原因
+     */
+    void onExportFinished(bool success, const QString &errorString);
+
+    /**
+     * @brief 按选择的列分组汇总，汇总进行中时取消
+     */
+    void onGroupBy();
+
+    /**
+     * @brief 展开当前选中的分组，显示其成员行
+     */
+    void onExpandGroup();
+
+    /**
+     * @brief 返回原始数据
+     */
+    void onShowSourceData();
+
+    /**
+     * @brief 处理分组汇总进度
+     * @param rowsProcessed 已处理的行数
+     * @param totalRows 总行数
+     */
+    void onGroupProgress(qint64 rowsProcessed, qint64 totalRows);
+
+    /**
+     * @brief 处理分组汇总或展开结束
+     * @param success 是否成功
+     * @param errorString 失败原因
+     */
+    void onGroupFinished(bool success, const QString &errorString);
+
+    /**
+     * @brief 开始或取消把整个数据源读入内存
+     */
+    void onLoadAll();
+
     /**
      * @brief 处理模型加载状态变化
      * @param status 新的加载状态
@@ -102,20 +186,62 @@ private:
      */
     void updateDataModel();
 
+    /**
+     * @brief 把当前模型设置到正在显示的视图上，另一个视图解除模型
+     */
+    void attachModelToActiveView();
+
+    /**
+     * @brief 当前是否使用轻量视图
+     * @return 是否为轻量视图
+     */
+    bool isGridViewActive() const;
+
+    /**
+     * @brief 在当前模型中显示另一个数据源（汇总结果、分组成员或原始数据）
+     * @param source 数据源
+     */
+    void showDataSource(std::shared_ptr<DataSource> source);
+
+    /**
+     * @brief 展开分组汇总结果中的一行
+     * @param groupRow 分组所在行
+     */
+    void expandGroupRow(int groupRow);
+
     // 私有成员变量
     VirtualTableView *m_tableView;         // 虚拟表格视图
+    VirtualGridView *m_gridView;           // 固定行高的轻量视图，支持十亿级行数
+    QStackedWidget *m_viewStack;           // 视图切换容器
     VirtualTableModel *m_tableModel;       // 虚拟表格模型
     std::shared_ptr<DataSource> m_dataSource; // 数据源（基类指针，可指向SampleDataSource或CsvDataSource）
     QString m_csvFilePath;                 // CSV文件路径
+    CsvDialect m_csvDialect;               // 打开时推断出的CSV格式
     bool m_useSampleData;                  // 是否使用示例数据（true）或CSV数据（false）
 
     // 控制组件
     QComboBox *m_dataSizeComboBox;         // 数据量选择下拉框
     QComboBox *m_preloadPolicyComboBox;    // 预加载策略选择下拉框
+    QComboBox *m_viewModeComboBox;         // 视图模式选择下拉框
+    QCheckBox *m_frameStatsCheckBox;       // 性能叠加层开关
     QSpinBox *m_blockSizeSpinBox;          // 块大小输入框
     QSpinBox *m_bufferSizeSpinBox;         // 缓冲区大小输入框
     QSpinBox *m_jumpToRowSpinBox;          // 跳转行号输入框
     QPushButton *m_jumpButton;             // 跳转按钮
+    QComboBox *m_valueColumnComboBox;      // 按值跳转的列
+    QComboBox *m_valueMatchComboBox;       // 按值跳转的查找方式
+    QLineEdit *m_jumpValueEdit;            // 按值跳转的值
+    int m_pendingValueColumn;              // 等待索引建立完成后跳转的列，-1表示没有
+    QPushButton *m_exportButton;           // 导出按钮
+    QPushButton *m_loadAllButton;          // 加载全部按钮
+    TableExporter *m_exporter;             // 流式导出器
+    QComboBox *m_groupColumnComboBox;      // 分组列选择下拉框
+    QPushButton *m_groupButton;            // 分组汇总按钮
+    QPushButton *m_expandGroupButton;      // 展开分组按钮
+    QPushButton *m_showSourceButton;       // 返回原始数据按钮
+    GroupByAggregator *m_aggregator;       // 分组汇总引擎
+    std::shared_ptr<AggregateDataSource> m_groupSource; // 最近一次分组汇总结果
+    std::shared_ptr<const ZoneMap> m_zoneMap; // 原始数据源的区间统计，切换到汇总结果后仍保留
     QProgressBar *m_loadingProgressBar;    // 加载进度条
     QLabel *m_statusLabel;                 // 状态标签
     QLabel *m_visibleRangeLabel;           // 可见范围标签
@@ -16,6 +16,26 @@ SOURCES += \
     $$PWD/MainWindow.cpp \
     $$PWD/../VirtualTable/VirtualTableView.cpp \
     $$PWD/../VirtualTable/VirtualTableModel.cpp \
+    $$PWD/../VirtualTable/VirtualTableDelegate.cpp \
+    $$PWD/../VirtualTable/VirtualGridView.cpp \
+    $$PWD/../VirtualTable/VirtualScrollMapper.cpp \
+    $$PWD/../VirtualTable/RowRangeSet.cpp \
+    $$PWD/../VirtualTable/VirtualSelectionModel.cpp \
+    $$PWD/../VirtualTable/TableExporter.cpp \
+    $$PWD/../VirtualTable/ColumnWidthEstimator.cpp \
+    $$PWD/../VirtualTable/VirtualViewHelper.cpp \
+    $$PWD/../VirtualTable/FrameStats.cpp \
+    $$PWD/../VirtualTable/ColumnFormat.cpp \
+    $$PWD/../VirtualTable/ColumnIndex.cpp \
+    $$PWD/../VirtualTable/ZoneMap.cpp \
+    $$PWD/../VirtualTable/ColumnarCache.cpp \
+    $$PWD/../VirtualTable/CsvTokenizer.cpp \
+    $$PWD/../VirtualTable/CsvEncoding.cpp \
+    $$PWD/../VirtualTable/CsvDialect.cpp \
+    $$PWD/../VirtualTable/ConditionalFormat.cpp \
+    $$PWD/../VirtualTable/GroupByAggregator.cpp \
+    $$PWD/../VirtualTable/AggregateDataSource.cpp \
+    $$PWD/../VirtualTable/RowSubsetDataSource.cpp \
     $$PWD/../VirtualTable/SampleDataSource.cpp \
     $$PWD/../VirtualTable/CsvDataSource.cpp
 
@@ -25,6 +45,26 @@ HEADERS += \
     $$PWD/MainWindow.h \
     $$PWD/../VirtualTable/VirtualTableView.h \
     $$PWD/../VirtualTable/VirtualTableModel.h \
+    $$PWD/../VirtualTable/VirtualTableDelegate.h \
+    $$PWD/../VirtualTable/VirtualGridView.h \
+    $$PWD/../VirtualTable/VirtualScrollMapper.h \
+    $$PWD/../VirtualTable/RowRangeSet.h \
+    $$PWD/../VirtualTable/VirtualSelectionModel.h \
+    $$PWD/../VirtualTable/TableExporter.h \
+    $$PWD/../VirtualTable/ColumnWidthEstimator.h \
+    $$PWD/../VirtualTable/VirtualViewHelper.h \
+    $$PWD/../VirtualTable/FrameStats.h \
+    $$PWD/../VirtualTable/ColumnFormat.h \
+    $$PWD/../VirtualTable/ColumnIndex.h \
+    $$PWD/../VirtualTable/ZoneMap.h \
+    $$PWD/../VirtualTable/ColumnarCache.h \
+    $$PWD/../VirtualTable/CsvTokenizer.h \
+    $$PWD/../VirtualTable/CsvEncoding.h \
+    $$PWD/../VirtualTable/CsvDialect.h \
+    $$PWD/../VirtualTable/ConditionalFormat.h \
+    $$PWD/../VirtualTable/GroupByAggregator.h \
+    $$PWD/../VirtualTable/AggregateDataSource.h \
+    $$PWD/../VirtualTable/RowSubsetDataSource.h \
     $$PWD/../VirtualTable/DataSource.h \
     $$PWD/../VirtualTable/SampleDataSource.h \
     $$PWD/../VirtualTable/CsvDataSource.h
@@ -0,0 +1,166 @@
+#include "AggregateDataSource.h"
+#include <QDataStream>
+#include <QMutexLocker>
+#include <algorithm>
+
+AggregateDataSource::AggregateDataSource(std::shared_ptr<DataSource> source, int keyColumn,
+    const QVector<int>& valueColumns, QVector<QString> keys, QVector<qint64> counts,
+    QVector<double> sums, QVector<qint64> numericCounts)
+    : m_source(std::move(source))
+    , m_keyColumn(keyColumn)
+    , m_valueColumns(valueColumns)
+    , m_groupCount(keys.size())
+    , m_keys(std::move(keys))
+    , m_counts(std::move(counts))
+    , m_sums(std::move(sums))
+    , m_numericCounts(std::move(numericCounts))
+{
+    buildHeaders();
+}
+
+AggregateDataSource::AggregateDataSource(std::shared_ptr<DataSource> source, int keyColumn,
+    const QVector<int>& valueColumns, std::unique_ptr<QFile> groupFile, int groupCount, QVector<qint64> rowOffsets)
+    : m_source(std::move(source))
+    , m_keyColumn(keyColumn)
+    , m_valueColumns(valueColumns)
+    , m_groupCount(groupCount)
+    , m_groupFile(std::move(groupFile))
+    , m_rowOffsets(std::move(rowOffsets))
+{
+    buildHeaders();
+}
+
+void AggregateDataSource::buildHeaders()
+{
+    // 表头沿用原始列名
+    const QList<QString> sourceHeaders = m_source ? m_source->headerData() : QList<QString>();
+    auto columnName = [&sourceHeaders](int column) {
+        return column < sourceHeaders.size() ? sourceHeaders[column] : QString("列%1").arg(column + 1);
+    };
+
+    m_headers.append(columnName(m_keyColumn));
+    m_headers.append(QStringLiteral("行数"));
+    for (int column : m_valueColumns) {
+        m_headers.append(QString("%1 合计").arg(columnName(column)));
+        m_headers.append(QString("%1 平均").arg(columnName(column)));
+    }
+}
+
+int AggregateDataSource::rowCount() const
+{
+    return m_groupCount;
+}
+
+int AggregateDataSource::columnCount() const
+{
+    return m_headers.size();
+}
+
+QList<QList<QVariant>> AggregateDataSource::loadData(int startRow, int count)
+{
+    QList<QList<QVariant>> result;
+    const int endRow = std::min(startRow + count, rowCount());
+    if (startRow < 0 || startRow >= endRow)
+        return result;
+
+    QVector<QString> keys;
+    QVector<qint64> counts;
+    QVector<double> sums;
+    QVector<qint64> numericCounts;
+    if (!readGroups(startRow, endRow - startRow, &keys, &counts, &sums, &numericCounts))
+        return result;
+
+    const int valueCount = m_valueColumns.size();
+    result.reserve(keys.size());
+    for (int row = 0; row < keys.size(); ++row) {
+        QList<QVariant> rowData;
+        rowData.reserve(columnCount());
+        rowData.append(keys[row]);
+        rowData.append(counts[row]);
+        for (int i = 0; i < valueCount; ++i) {
+            const int offset = row * valueCount + i;
+            const qint64 numeric = numericCounts[offset];
+            // 没有数值的分组合计和平均都留空
+            rowData.append(numeric > 0 ? QVariant(sums[offset]) : QVariant());
+            rowData.append(numeric > 0 ? QVariant(sums[offset] / numeric) : QVariant());
+        }
+        result.append(rowData);
+    }
+    return result;
+}
+
+QList<QString> AggregateDataSource::headerData() const
+{
+    return m_headers;
+}
+
+std::shared_ptr<DataSource> AggregateDataSource::sourceDataSource() const
+{
+    return m_source;
+}
+
+int AggregateDataSource::keyColumn() const
+{
+    return m_keyColumn;
+}
+
+QString AggregateDataSource::groupKey(int row) const
+{
+    QVector<QString> keys;
+    if (row < 0 || row >= m_groupCount || !readGroups(row, 1, &keys, nullptr, nullptr, nullptr))
+        return QString();
+    return keys.value(0);
+}
+
+qint64 AggregateDataSource::groupRowCount(int row) const
+{
+    QVector<qint64> counts;
+    if (row < 0 || row >= m_groupCount || !readGroups(row, 1, nullptr, &counts, nullptr, nullptr))
+        return 0;
+    return counts.value(0);
+}
+
+bool AggregateDataSource::readGroups(int startRow, int count, QVector<QString>* keys, QVector<qint64>* counts,
+    QVector<double>* sums, QVector<qint64>* numericCounts) const
+{
+    const int valueCount = m_valueColumns.size();
+    if (!m_groupFile) {
+        if (keys)
+            *keys = m_keys.mid(startRow, count);
+        if (counts)
+            *counts = m_counts.mid(startRow, count);
+        if (sums)
+            *sums = m_sums.mid(startRow * valueCount, count * valueCount);
+        if (numericCounts)
+            *numericCounts = m_numericCounts.mid(startRow * valueCount, count * valueCount);
+        return true;
+    }
+
+    // 从最近的偏移开始顺序读，跳过前面不需要的分组
+    QMutexLocker locker(&m_fileMutex);
+    const int indexSlot = startRow / RowsPerOffset;
+    if (indexSlot >= m_rowOffsets.size() || !m_groupFile->seek(m_rowOffsets[indexSlot]))
+        return false;
+
+    QDataStream stream(m_groupFile.get());
+    QString key;
+    qint64 groupCount = 0;
+    QVector<double> groupSums;
+    QVector<qint64> groupNumericCounts;
+    for (int row = indexSlot * RowsPerOffset; row < startRow + count; ++row) {
+        stream >> key >> groupCount >> groupSums >> groupNumericCounts;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        if (row < startRow)
+            continue;
+        if (keys)
+            keys->append(key);
+        if (counts)
+            counts->append(groupCount);
+        if (sums)
+            *sums += groupSums;
+        if (numericCounts)
+            *numericCounts += groupNumericCounts;
+    }
+    return true;
+}
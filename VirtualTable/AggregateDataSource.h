@@ -0,0 +1,115 @@
+#ifndef AGGREGATEDATASOURCE_H
+#define AGGREGATEDATASOURCE_H
+
+#include "DataSource.h"
+#include <QFile>
+#include <QMutex>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief 分组汇总结果数据源
+ *
+ * 每个分组一行：分组键、行数，以及每个汇总列的合计和平均值。
+ * 结果按列连续保存（键、行数、合计、数值个数各一个数组），构造后只读，可以被多个加载线程同时读取。
+ * 分组汇总溢出到临时文件时，结果也留在按键排序的结果文件中，内存里只保留每RowsPerOffset个分组一个的偏移索引，
+ * 读取时从最近的偏移开始顺序读出。
+ * 同时保留原始数据源和分组列，展开分组时据此查找成员行。
+ */
+class AggregateDataSource : public DataSource
+{
+public:
+    // 结果文件中每隔多少个分组记录一次偏移
+    static constexpr int RowsPerOffset = 64;
+
+    /**
+     * @brief 构造函数，结果全部在内存中
+     * @param source 原始数据源
+     * @param keyColumn 分组列
+     * @param valueColumns 汇总列
+     * @param keys 各分组的键
+     * @param counts 各分组的行数
+     * @param sums 各分组各汇总列的合计，按分组优先排列（分组 * 汇总列数 + 汇总列）
+     * @param numericCounts 参与合计的数值个数，布局与sums相同
+     */
+    AggregateDataSource(std::shared_ptr<DataSource> source, int keyColumn, const QVector<int>& valueColumns,
+        QVector<QString> keys, QVector<qint64> counts, QVector<double> sums, QVector<qint64> numericCounts);
+
+    /**
+     * @brief 构造函数，结果保存在文件中
+     * @param source 原始数据源
+     * @param keyColumn 分组列
+     * @param valueColumns 汇总列
+     * @param groupFile 已打开的结果文件，每个分组依次写入键、行数、合计数组和数值个数数组（QDataStream格式）
+     * @param groupCount 分组数
+     * @param rowOffsets 第0、RowsPerOffset、2 * RowsPerOffset……个分组在文件中的偏移
+     */
+    AggregateDataSource(std::shared_ptr<DataSource> source, int keyColumn, const QVector<int>& valueColumns,
+        std::unique_ptr<QFile> groupFile, int groupCount, QVector<qint64> rowOffsets);
+    ~AggregateDataSource() override = default;
+
+    int rowCount() const override;
+    int columnCount() const override;
+    QList<QList<QVariant>> loadData(int startRow, int count) override;
+    QList<QString> headerData() const override;
+
+    /**
+     * @brief 获取原始数据源
+     * @return 原始数据源
+     */
+    std::shared_ptr<DataSource> sourceDataSource() const;
+
+    /**
+     * @brief 获取分组列
+     * @return 原始数据源中的列索引
+     */
+    int keyColumn() const;
+
+    /**
+     * @brief 获取分组键
+     * @param row 分组所在行
+     * @return 分组键，行无效时为空
+     */
+    QString groupKey(int row) const;
+
+    /**
+     * @brief 获取分组的行数
+     * @param row 分组所在行
+     * @return 成员行数，行无效时为0
+     */
+    qint64 groupRowCount(int row) const;
+
+private:
+    /**
+     * @brief 读取一段分组，结果在内存中时直接复制
+     * @param startRow 起始分组
+     * @param count 分组数，调用方保证不越界
+     * @param keys 输出各分组的键
+     * @param counts 输出各分组的行数
+     * @param sums 输出合计，布局与构造参数相同
+     * @param numericCounts 输出数值个数，布局与sums相同
+     * @return 是否读取成功
+     */
+    bool readGroups(int startRow, int count, QVector<QString>* keys, QVector<qint64>* counts,
+        QVector<double>* sums, QVector<qint64>* numericCounts) const;
+
+    /**
+     * @brief 根据源表头生成结果表头
+     */
+    void buildHeaders();
+
+    std::shared_ptr<DataSource> m_source; // 原始数据源
+    int m_keyColumn; // 分组列
+    QVector<int> m_valueColumns; // 汇总列
+    QList<QString> m_headers; // 表头信息
+    int m_groupCount; // 分组数
+    QVector<QString> m_keys; // 各分组的键
+    QVector<qint64> m_counts; // 各分组的行数
+    QVector<double> m_sums; // 各汇总列的合计
+    QVector<qint64> m_numericCounts; // 参与合计的数值个数
+    std::unique_ptr<QFile> m_groupFile; // 结果文件，为空时结果在内存中
+    QVector<qint64> m_rowOffsets; // 结果文件中每RowsPerOffset个分组的起始偏移
+    mutable QMutex m_fileMutex; // 保护结果文件的读取位置
+};
+
+#endif // AGGREGATEDATASOURCE_H
@@ -0,0 +1,136 @@
+#include "ColumnFormat.h"
+#include <QDateTime>
+#include <algorithm>
+
+ColumnFormat::ColumnFormat()
+    : m_type(Type::Text)
+    , m_precision(-1)
+    , m_thousandsSeparator(false)
+{
+}
+
+ColumnFormat ColumnFormat::number(int precision, bool thousandsSeparator)
+{
+    ColumnFormat format;
+    format.m_type = Type::Number;
+    format.m_precision = std::min(precision, 15);
+    format.m_thousandsSeparator = thousandsSeparator;
+    return format;
+}
+
+ColumnFormat ColumnFormat::dateTime(const QString& displayFormat, const QString& sourceFormat)
+{
+    ColumnFormat format;
+    format.m_type = Type::DateTime;
+    format.m_displayFormat = displayFormat;
+    format.m_sourceFormat = sourceFormat;
+    return format;
+}
+
+ColumnFormat::Type ColumnFormat::type() const
+{
+    return m_type;
+}
+
+bool ColumnFormat::isText() const
+{
+    return m_type == Type::Text;
+}
+
+QString ColumnFormat::format(const QVariant& value) const
+{
+    if (m_type == Type::Text)
+        return value.toString();
+
+    return formatWith(makeLocale(), value);
+}
+
+void ColumnFormat::formatColumn(const QList<QList<QVariant>>& rows, int column, QString* out, int stride) const
+{
+    // 区域设置只准备一次，整列复用
+    const QLocale locale = makeLocale();
+    for (const QList<QVariant>& row : rows) {
+        if (column < row.size()) {
+            *out = (m_type == Type::Text) ? row[column].toString() : formatWith(locale, row[column]);
+        }
+        out += stride;
+    }
+}
+
+bool ColumnFormat::operator==(const ColumnFormat& other) const
+{
+    return m_type == other.m_type
+        && m_precision == other.m_precision
+        && m_thousandsSeparator == other.m_thousandsSeparator
+        && m_displayFormat == other.m_displayFormat
+        && m_sourceFormat == other.m_sourceFormat;
+}
+
+bool ColumnFormat::operator!=(const ColumnFormat& other) const
+{
+    return !(*this == other);
+}
+
+QLocale ColumnFormat::makeLocale() const
+{
+    // C区域默认不输出千位分隔符，需要分隔符时使用系统区域
+    if (m_type == Type::Number && m_thousandsSeparator) {
+        QLocale locale = QLocale::system();
+        locale.setNumberOptions(QLocale::DefaultNumberOptions);
+        return locale;
+    }
+    return QLocale::c();
+}
+
+QString ColumnFormat::formatWith(const QLocale& locale, const QVariant& value) const
+{
+    if (m_type == Type::Number) {
+        const QString text = value.toString();
+        bool ok = false;
+
+        // 整数先按64位整数处理，避免超过2^53后经过double丢失精度
+        if (m_precision <= 0) {
+            qlonglong integer = value.toLongLong(&ok);
+            if (ok)
+                return locale.toString(integer);
+        }
+
+        double number = value.toDouble(&ok);
+        if (!ok)
+            return text;
+
+        int precision = m_precision;
+        if (precision < 0) {
+            // 保留原文本中的小数位数
+            int dot = text.indexOf(QLatin1Char('.'));
+            precision = dot < 0 ? 0 : std::min(15, text.size() - dot - 1);
+        }
+        return locale.toString(number, 'f', precision);
+    }
+
+    if (m_type == Type::DateTime) {
+        QDateTime dateTime;
+        if (value.type() == QVariant::DateTime) {
+            dateTime = value.toDateTime();
+        } else if (value.type() == QVariant::Date) {
+            dateTime = value.toDate().startOfDay();
+        } else {
+            const QString text = value.toString();
+            dateTime = m_sourceFormat.isEmpty()
+                ? QDateTime::fromString(text, Qt::ISODate)
+                : QDateTime::fromString(text, m_sourceFormat);
+            if (!dateTime.isValid()) {
+                // 只有日期部分的文本
+                QDate date = m_sourceFormat.isEmpty()
+                    ? QDate::fromString(text, Qt::ISODate)
+                    : QDate::fromString(text, m_sourceFormat);
+                if (!date.isValid())
+                    return text;
+                dateTime = date.startOfDay();
+            }
+        }
+        return dateTime.toString(m_displayFormat);
+    }
+
+    return value.toString();
+}
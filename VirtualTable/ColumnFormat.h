@@ -0,0 +1,100 @@
+#ifndef COLUMNFORMAT_H
+#define COLUMNFORMAT_H
+
+#include <QList>
+#include <QLocale>
+#include <QString>
+#include <QVariant>
+
+/**
+ * @brief 列显示格式
+ *
+ * 描述一列数据如何转换为显示文本：数字的小数位数和千位分隔符、日期时间的输出格式。
+ * 格式在加载线程中按列批量应用，结果保存在数据块的显示文本中，重绘时只做查找。
+ * 无法按格式解析的值保持原文本。
+ */
+class ColumnFormat {
+public:
+    /**
+     * @brief 格式类型
+     */
+    enum class Type {
+        Text, // 原样显示
+        Number, // 数字
+        DateTime // 日期时间
+    };
+
+    /**
+     * @brief 构造原样显示的格式
+     */
+    ColumnFormat();
+
+    /**
+     * @brief 创建数字格式
+     * @param precision 小数位数，-1表示保留原有位数
+     * @param thousandsSeparator 是否使用千位分隔符
+     * @return 列格式
+     */
+    static ColumnFormat number(int precision, bool thousandsSeparator = false);
+
+    /**
+     * @brief 创建日期时间格式
+     * @param displayFormat 输出格式，如"yyyy-MM-dd HH:mm"
+     * @param sourceFormat 文本值的解析格式，为空时按ISO 8601解析
+     * @return 列格式
+     */
+    static ColumnFormat dateTime(const QString& displayFormat, const QString& sourceFormat = QString());
+
+    /**
+     * @brief 获取格式类型
+     * @return 格式类型
+     */
+    Type type() const;
+
+    /**
+     * @brief 是否为原样显示
+     * @return 是否为Text类型
+     */
+    bool isText() const;
+
+    /**
+     * @brief 格式化单个值
+     * @param value 原始值
+     * @return 显示文本
+     */
+    QString format(const QVariant& value) const;
+
+    /**
+     * @brief 批量格式化一个数据块中的一列
+     *
+     * 区域设置等准备工作每列只做一次，适合在加载线程中调用
+     * @param rows 数据块的行数据
+     * @param column 列索引
+     * @param out 第一行该列显示文本的位置
+     * @param stride 相邻两行显示文本之间的间隔（通常为列数）
+     */
+    void formatColumn(const QList<QList<QVariant>>& rows, int column, QString* out, int stride) const;
+
+    bool operator==(const ColumnFormat& other) const;
+    bool operator!=(const ColumnFormat& other) const;
+
+private:
+    /**
+     * @brief 创建格式化使用的区域设置
+     * @return 区域设置
+     */
+    QLocale makeLocale() const;
+
+    /**
+     * @brief 使用已准备好的区域设置格式化单个值
+     */
+    QString formatWith(const QLocale& locale, const QVariant& value) const;
+
+    Type m_type; // 格式类型
+    int m_precision; // 小数位数，-1表示保留原有位数
+    bool m_thousandsSeparator; // 是否使用千位分隔符
+    QString m_displayFormat; // 日期时间输出格式
+    QString m_sourceFormat; // 日期时间解析格式
+};
+
+#endif // COLUMNFORMAT_H
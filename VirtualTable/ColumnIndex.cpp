@@ -0,0 +1,637 @@
+#include "ColumnIndex.h"
+#include <QMutex>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace {
+
+// 索引文件格式
+constexpr quint32 IndexMagic = 0x56544958; // "VTIX"
+constexpr quint32 IndexVersion = 2;
+
+// 文本记录内联的UTF-16码元数，更长的键另存于堆中
+constexpr int PrefixUnits = 8;
+
+/**
+ * @brief 索引文件头，按本机字节序保存
+ *
+ * 文件依次为：文件头、定长记录数组、后缀最小行号数组（按8字节对齐）、长文本键的堆
+ */
+struct IndexHeader {
+    quint32 magic; // 文件标识
+    quint32 version; // 格式版本
+    qint64 sourceSize; // 数据源文件大小，新建立的索引为0
+    qint64 sourceModified; // 数据源修改时间，新建立的索引为0
+    qint32 rowCount; // 数据源行数
+    qint32 column; // 列索引
+    qint32 keyType; // 键类型
+    qint32 entryCount; // 条目数
+    qint64 heapBytes; // 堆的字节数
+    char reserved[16]; // 保留
+};
+static_assert(sizeof(IndexHeader) == 64, "IndexHeader must be 64 bytes");
+
+/**
+ * @brief 数值索引的记录
+ */
+struct NumberRecord {
+    double key; // 键
+    qint32 row; // 行号
+    qint32 reserved; // 对齐
+};
+static_assert(sizeof(NumberRecord) == 16, "NumberRecord must be 16 bytes");
+
+/**
+ * @brief 文本索引的记录
+ */
+struct TextRecord {
+    quint16 prefix[PrefixUnits]; // 键的前几个码元，不足时补0
+    qint64 offset; // 键长于PrefixUnits时，完整键在文件中的位置
+    qint32 length; // 键的码元数
+    qint32 row; // 行号
+};
+static_assert(sizeof(TextRecord) == 32, "TextRecord must be 32 bytes");
+
+qint64 align8(qint64 value)
+{
+    return (value + 7) & ~static_cast<qint64>(7);
+}
+
+/**
+ * @brief 索引文件各部分的位置
+ */
+struct IndexLayout {
+    qint64 recordSize; // 每条记录的字节数
+    qint64 suffixOffset; // 后缀最小行号数组的位置
+    qint64 heapOffset; // 堆的位置
+    qint64 fileSize; // 文件大小
+
+    IndexLayout(ColumnIndex::KeyType keyType, qint64 entryCount, qint64 heapBytes)
+        : recordSize(keyType == ColumnIndex::KeyType::Number ? sizeof(NumberRecord) : sizeof(TextRecord))
+        , suffixOffset(sizeof(IndexHeader) + entryCount * recordSize)
+        , heapOffset(align8(suffixOffset + entryCount * static_cast<qint64>(sizeof(qint32))))
+        , fileSize(heapOffset + heapBytes)
+    {
+    }
+};
+
+/**
+ * @brief 索引条目，按（键，行号）排序
+ */
+template <typename Key>
+struct Entry {
+    Key key; // 键
+    int row; // 行号
+
+    bool operator<(const Entry& other) const
+    {
+        if (key < other.key)
+            return true;
+        if (other.key < key)
+            return false;
+        return row < other.row;
+    }
+};
+
+template <typename Key>
+using Run = std::vector<Entry<Key>>;
+
+/**
+ * @brief 比较两个码元序列，规则与QString的operator<相同
+ */
+int compareUnits(const quint16* a, int lengthA, const quint16* b, int lengthB)
+{
+    const int length = std::min(lengthA, lengthB);
+    for (int i = 0; i < length; ++i) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return lengthA < lengthB ? -1 : (lengthA > lengthB ? 1 : 0);
+}
+
+/**
+ * @brief 比较两个文本键：先比较内联的前缀，只有前缀相同且键更长时才读取完整键
+ */
+int compareKeys(const quint16* prefixA, const quint16* unitsA, int lengthA,
+    const quint16* prefixB, const quint16* unitsB, int lengthB)
+{
+    const int result = compareUnits(prefixA, std::min(lengthA, PrefixUnits), prefixB, std::min(lengthB, PrefixUnits));
+    if (result != 0 || (lengthA <= PrefixUnits && lengthB <= PrefixUnits))
+        return result;
+    return compareUnits(unitsA, lengthA, unitsB, lengthB);
+}
+
+/**
+ * @brief 获取文本记录的完整键
+ * @param base 记录所在文件的起始地址
+ * @param record 记录
+ */
+const quint16* keyUnits(const uchar* base, const TextRecord& record)
+{
+    return record.length <= PrefixUnits ? record.prefix : reinterpret_cast<const quint16*>(base + record.offset);
+}
+
+int compareRecords(const uchar* base, const TextRecord& a, const TextRecord& b)
+{
+    return compareKeys(a.prefix, keyUnits(base, a), a.length, b.prefix, keyUnits(base, b), b.length);
+}
+
+/**
+ * @brief 把排好序的文本条目编码为定长记录，长键写入堆，偏移量相对于堆的起始位置
+ */
+void encodeTextRun(const Run<QString>& run, QByteArray* records, QByteArray* heap)
+{
+    records->resize(static_cast<int>(run.size() * sizeof(TextRecord)));
+    TextRecord* out = reinterpret_cast<TextRecord*>(records->data());
+    for (size_t i = 0; i < run.size(); ++i) {
+        const QString& key = run[i].key;
+        TextRecord& record = out[i];
+        std::memset(&record, 0, sizeof(TextRecord));
+        record.length = key.size();
+        record.row = run[i].row;
+        std::memcpy(record.prefix, key.utf16(), std::min(key.size(), PrefixUnits) * sizeof(quint16));
+        if (key.size() > PrefixUnits) {
+            record.offset = heap->size();
+            heap->append(reinterpret_cast<const char*>(key.utf16()), key.size() * static_cast<int>(sizeof(quint16)));
+        }
+    }
+}
+
+void encodeNumberRun(const Run<double>& run, QByteArray* records)
+{
+    records->resize(static_cast<int>(run.size() * sizeof(NumberRecord)));
+    NumberRecord* out = reinterpret_cast<NumberRecord*>(records->data());
+    for (size_t i = 0; i < run.size(); ++i)
+        out[i] = { run[i].key, run[i].row, 0 };
+}
+
+/**
+ * @brief 临时文件中的一组有序段，各分块任务并行追加，全部写完后映射读取
+ */
+class RunFile {
+public:
+    /**
+     * @brief 一个有序段
+     */
+    struct Span {
+        qint64 offset; // 记录数组的位置
+        int count; // 记录数
+        qint64 heapBytes; // 段内长文本键的字节数
+    };
+
+    bool open()
+    {
+        return m_file.open();
+    }
+
+    /**
+     * @brief 追加一个有序段，文本段的堆偏移量在这里改为文件中的位置
+     * @param records 记录数组
+     * @param count 记录数
+     * @param heap 长文本键的堆，数值段为空
+     * @return 是否写入成功
+     */
+    bool append(QByteArray records, int count, const QByteArray& heap)
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 heapBase = m_size + records.size();
+        if (!heap.isEmpty()) {
+            TextRecord* out = reinterpret_cast<TextRecord*>(records.data());
+            for (int i = 0; i < count; ++i) {
+                if (out[i].length > PrefixUnits)
+                    out[i].offset += heapBase;
+            }
+        }
+
+        // 每段按8字节对齐，映射后可以直接按记录访问
+        const QByteArray padding(static_cast<int>(align8(heap.size()) - heap.size()), '\0');
+        if (m_file.write(records) != records.size() || m_file.write(heap) != heap.size()
+            || m_file.write(padding) != padding.size())
+            return false;
+
+        m_spans.append({ m_size, count, heap.size() });
+        m_size = heapBase + heap.size() + padding.size();
+        return true;
+    }
+
+    bool map()
+    {
+        if (!m_file.flush())
+            return false;
+        if (m_size == 0)
+            return true;
+        m_data = m_file.map(0, m_size);
+        return m_data != nullptr;
+    }
+
+    const uchar* data() const { return m_data; }
+    const QVector<Span>& spans() const { return m_spans; }
+
+private:
+    QTemporaryFile m_file; // 临时文件，随对象删除
+    QMutex m_mutex; // 保护追加
+    QVector<Span> m_spans; // 已写入的段
+    qint64 m_size = 0; // 已写入的字节数
+    uchar* m_data = nullptr; // 映射的内容
+};
+
+/**
+ * @brief 多路归并各有序段，按顺序把每条记录交给output
+ * @return 是否完成，取消时返回false
+ */
+template <typename Record, typename Less, typename Output>
+bool mergeRuns(const RunFile& runs, const std::atomic<bool>& cancelled, Less less, Output output)
+{
+    struct Cursor {
+        const Record* next; // 段内下一条记录
+        const Record* end; // 段末尾
+    };
+    QVector<Cursor> cursors;
+    for (const RunFile::Span& span : runs.spans()) {
+        const Record* first = reinterpret_cast<const Record*>(runs.data() + span.offset);
+        cursors.append({ first, first + span.count });
+    }
+
+    auto greater = [&cursors, less](int a, int b) { return less(*cursors[b].next, *cursors[a].next); };
+    std::priority_queue<int, std::vector<int>, decltype(greater)> heap(greater);
+    for (int i = 0; i < cursors.size(); ++i)
+        heap.push(i);
+
+    qint64 merged = 0;
+    while (!heap.empty()) {
+        if ((++merged & 0xFFFF) == 0 && cancelled)
+            return false;
+        const int i = heap.top();
+        heap.pop();
+        output(*cursors[i].next);
+        if (++cursors[i].next != cursors[i].end)
+            heap.push(i);
+    }
+    return true;
+}
+}
+
+ColumnIndex::ColumnIndex()
+    : m_column(-1)
+    , m_keyType(KeyType::Text)
+    , m_size(0)
+    , m_data(nullptr)
+    , m_fileSize(0)
+{
+}
+
+int ColumnIndex::column() const
+{
+    return m_column;
+}
+
+ColumnIndex::KeyType ColumnIndex::keyType() const
+{
+    return m_keyType;
+}
+
+int ColumnIndex::size() const
+{
+    return m_size;
+}
+
+int ColumnIndex::findFirstRow(const QString& value, Match match) const
+{
+    bool ok = false;
+    const int position = lowerBound(value, &ok);
+    if (!ok || position >= m_size)
+        return -1;
+
+    if (match == Match::GreaterOrEqual)
+        return suffixMinRows()[position];
+
+    // 相同键按行号排序，第一个就是行号最小的
+    bool equal = false;
+    if (m_keyType == KeyType::Number) {
+        const NumberRecord* records = reinterpret_cast<const NumberRecord*>(m_data + sizeof(IndexHeader));
+        equal = records[position].key == value.trimmed().toDouble();
+    } else {
+        const TextRecord* records = reinterpret_cast<const TextRecord*>(m_data + sizeof(IndexHeader));
+        const TextRecord& record = records[position];
+        const quint16* units = value.utf16();
+        equal = compareKeys(record.prefix, keyUnits(m_data, record), record.length, units, units, value.size()) == 0;
+    }
+    return equal ? rowAt(position) : -1;
+}
+
+std::shared_ptr<ColumnIndex> ColumnIndex::build(std::shared_ptr<DataSource> source, int column,
+    QThreadPool* pool, const std::atomic<bool>& cancelled, int chunkSize)
+{
+    if (!source || column < 0 || column >= source->columnCount() || chunkSize <= 0)
+        return nullptr;
+
+    // 分块并行读取，每块按文本排序后写入临时文件，内存中只保留正在处理的块
+    const int rowCount = source->rowCount();
+    const int chunkCount = static_cast<int>((static_cast<qint64>(rowCount) + chunkSize - 1) / chunkSize);
+    auto textRuns = std::make_shared<RunFile>();
+    if (!textRuns->open())
+        return nullptr;
+    auto numericChunks = std::make_shared<std::vector<char>>(chunkCount, 1);
+    auto failed = std::make_shared<std::atomic<bool>>(false);
+
+    QVector<QFuture<void>> tasks;
+    for (int i = 0; i < chunkCount; ++i) {
+        tasks.append(QtConcurrent::run(pool, [source, textRuns, numericChunks, failed, column, chunkSize, rowCount, i, &cancelled]() {
+            if (cancelled || *failed)
+                return;
+            const int startRow = i * chunkSize;
+            const int count = std::min(chunkSize, rowCount - startRow);
+            const QList<QList<QVariant>> rows = source->loadData(startRow, count);
+
+            Run<QString> run;
+            run.reserve(rows.size());
+            bool numeric = true;
+            for (int k = 0; k < rows.size(); ++k) {
+                const QList<QVariant>& rowData = rows[k];
+                if (column >= rowData.size())
+                    continue;
+                QString text = rowData[column].toString();
+                if (text.isEmpty())
+                    continue;
+                if (numeric) {
+                    bool ok = false;
+                    double number = text.trimmed().toDouble(&ok);
+                    numeric = ok && number == number;
+                }
+                run.push_back({ text, startRow + k });
+            }
+            (*numericChunks)[i] = numeric;
+            if (run.empty())
+                return;
+
+            std::sort(run.begin(), run.end());
+            QByteArray records;
+            QByteArray heap;
+            encodeTextRun(run, &records, &heap);
+            if (!textRuns->append(records, static_cast<int>(run.size()), heap))
+                *failed = true;
+        }));
+    }
+    for (QFuture<void>& task : tasks)
+        task.waitForFinished();
+
+    if (cancelled || *failed || !textRuns->map())
+        return nullptr;
+
+    const bool numeric = std::all_of(numericChunks->begin(), numericChunks->end(), [](char value) { return value != 0; });
+    qint64 entryCount = 0;
+    qint64 heapBytes = 0;
+    for (const RunFile::Span& span : textRuns->spans()) {
+        entryCount += span.count;
+        heapBytes += span.heapBytes;
+    }
+    if (entryCount > std::numeric_limits<int>::max())
+        return nullptr;
+
+    // 全部为数字时按数值重新排序各段，段内条目数不超过分块大小
+    std::shared_ptr<RunFile> numberRuns;
+    if (numeric) {
+        heapBytes = 0;
+        numberRuns = std::make_shared<RunFile>();
+        if (!numberRuns->open())
+            return nullptr;
+        tasks.clear();
+        for (const RunFile::Span& span : textRuns->spans()) {
+            tasks.append(QtConcurrent::run(pool, [textRuns, numberRuns, failed, span, &cancelled]() {
+                if (cancelled || *failed)
+                    return;
+                const uchar* base = textRuns->data();
+                const TextRecord* records = reinterpret_cast<const TextRecord*>(base + span.offset);
+                Run<double> run;
+                run.reserve(span.count);
+                for (int k = 0; k < span.count; ++k) {
+                    const QString text = QString::fromRawData(reinterpret_cast<const QChar*>(keyUnits(base, records[k])), records[k].length);
+                    run.push_back({ text.trimmed().toDouble(), records[k].row });
+                }
+                std::sort(run.begin(), run.end());
+                QByteArray out;
+                encodeNumberRun(run, &out);
+                if (!numberRuns->append(out, span.count, QByteArray()))
+                    *failed = true;
+            }));
+        }
+        for (QFuture<void>& task : tasks)
+            task.waitForFinished();
+        if (cancelled || *failed || !numberRuns->map())
+            return nullptr;
+    }
+
+    // 多路归并直接写入映射的索引文件
+    const KeyType keyType = numeric ? KeyType::Number : KeyType::Text;
+    const IndexLayout layout(keyType, entryCount, heapBytes);
+    std::unique_ptr<QTemporaryFile> file(new QTemporaryFile);
+    if (!file->open() || !file->resize(layout.fileSize))
+        return nullptr;
+    uchar* out = file->map(0, layout.fileSize);
+    if (!out)
+        return nullptr;
+
+    qint64 position = 0;
+    bool completed = false;
+    if (numeric) {
+        NumberRecord* records = reinterpret_cast<NumberRecord*>(out + sizeof(IndexHeader));
+        completed = mergeRuns<NumberRecord>(*numberRuns, cancelled,
+            [](const NumberRecord& a, const NumberRecord& b) {
+                return a.key < b.key || (!(b.key < a.key) && a.row < b.row);
+            },
+            [records, &position](const NumberRecord& record) { records[position++] = record; });
+    } else {
+        const uchar* base = textRuns->data();
+        TextRecord* records = reinterpret_cast<TextRecord*>(out + sizeof(IndexHeader));
+        qint64 heapPosition = layout.heapOffset;
+        completed = mergeRuns<TextRecord>(*textRuns, cancelled,
+            [base](const TextRecord& a, const TextRecord& b) {
+                const int result = compareRecords(base, a, b);
+                return result < 0 || (result == 0 && a.row < b.row);
+            },
+            [base, out, records, &position, &heapPosition](const TextRecord& record) {
+                TextRecord copy = record;
+                if (record.length > PrefixUnits) {
+                    const qint64 bytes = record.length * static_cast<qint64>(sizeof(quint16));
+                    std::memcpy(out + heapPosition, base + record.offset, static_cast<size_t>(bytes));
+                    copy.offset = heapPosition;
+                    heapPosition += bytes;
+                }
+                records[position++] = copy;
+            });
+    }
+    if (!completed)
+        return nullptr;
+
+    // 从末尾向前生成后缀最小行号
+    qint32* suffix = reinterpret_cast<qint32*>(out + layout.suffixOffset);
+    qint32 minimum = std::numeric_limits<qint32>::max();
+    const uchar* recordData = out + sizeof(IndexHeader);
+    for (qint64 i = entryCount - 1; i >= 0; --i) {
+        const qint32 row = numeric
+            ? reinterpret_cast<const NumberRecord*>(recordData)[i].row
+            : reinterpret_cast<const TextRecord*>(recordData)[i].row;
+        minimum = std::min(minimum, row);
+        suffix[i] = minimum;
+    }
+
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = IndexMagic;
+    header.version = IndexVersion;
+    header.rowCount = rowCount;
+    header.column = column;
+    header.keyType = static_cast<qint32>(keyType);
+    header.entryCount = static_cast<qint32>(entryCount);
+    header.heapBytes = heapBytes;
+    std::memcpy(out, &header, sizeof(header));
+    file->unmap(out);
+
+    std::shared_ptr<ColumnIndex> index(new ColumnIndex);
+    if (!index->attach(std::move(file)))
+        return nullptr;
+    return index;
+}
+
+QString ColumnIndex::indexPath(const QString& sourcePath, int column)
+{
+    return QString("%1.col%2.vtidx").arg(sourcePath).arg(column);
+}
+
+std::shared_ptr<ColumnIndex> ColumnIndex::load(const QString& sourcePath, int column, int rowCount)
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    if (sourcePath.isEmpty() || !DataSource::persistentStamp(sourcePath, &size, &modified))
+        return nullptr;
+
+    std::unique_ptr<QFile> file(new QFile(indexPath(sourcePath, column)));
+    if (!file->open(QIODevice::ReadOnly))
+        return nullptr;
+
+    std::shared_ptr<ColumnIndex> index(new ColumnIndex);
+    if (!index->attach(std::move(file)))
+        return nullptr;
+
+    // 文件头与数据源不一致时视为过期
+    IndexHeader header;
+    std::memcpy(&header, index->m_data, sizeof(header));
+    if (header.sourceSize != size || header.sourceModified != modified || header.rowCount != rowCount
+        || header.column != column)
+        return nullptr;
+
+    return index;
+}
+
+bool ColumnIndex::save(const QString& sourcePath, int rowCount) const
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    if (sourcePath.isEmpty() || !m_data || !DataSource::persistentStamp(sourcePath, &size, &modified))
+        return false;
+
+    // 先写临时文件再替换，中途失败不会留下损坏的索引
+    QSaveFile file(indexPath(sourcePath, m_column));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    IndexHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    header.sourceSize = size;
+    header.sourceModified = modified;
+    header.rowCount = rowCount;
+    if (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    // 其余部分按原样从映射中分段写出，堆偏移量不变
+    constexpr qint64 WriteBlock = 16 * 1024 * 1024;
+    for (qint64 offset = sizeof(header); offset < m_fileSize; offset += WriteBlock) {
+        const qint64 bytes = std::min(WriteBlock, m_fileSize - offset);
+        if (file.write(reinterpret_cast<const char*>(m_data + offset), bytes) != bytes) {
+            file.cancelWriting();
+            return false;
+        }
+    }
+    return file.commit();
+}
+
+bool ColumnIndex::attach(std::unique_ptr<QFile> file)
+{
+    const qint64 fileSize = file->size();
+    if (fileSize < static_cast<qint64>(sizeof(IndexHeader)))
+        return false;
+    const uchar* data = file->map(0, fileSize);
+    if (!data)
+        return false;
+
+    IndexHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != IndexMagic || header.version != IndexVersion || header.entryCount < 0 || header.heapBytes < 0
+        || (header.keyType != static_cast<qint32>(KeyType::Number) && header.keyType != static_cast<qint32>(KeyType::Text)))
+        return false;
+
+    const KeyType keyType = static_cast<KeyType>(header.keyType);
+    if (IndexLayout(keyType, header.entryCount, header.heapBytes).fileSize != fileSize)
+        return false;
+
+    m_column = header.column;
+    m_keyType = keyType;
+    m_size = header.entryCount;
+    m_file = std::move(file);
+    m_data = data;
+    m_fileSize = fileSize;
+    return true;
+}
+
+int ColumnIndex::lowerBound(const QString& value, bool* ok) const
+{
+    int low = 0;
+    int high = m_size;
+    if (m_keyType == KeyType::Number) {
+        const double number = value.trimmed().toDouble(ok);
+        if (!*ok)
+            return 0;
+        const NumberRecord* records = reinterpret_cast<const NumberRecord*>(m_data + sizeof(IndexHeader));
+        while (low < high) {
+            const int middle = low + (high - low) / 2;
+            if (records[middle].key < number)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    *ok = true;
+    const TextRecord* records = reinterpret_cast<const TextRecord*>(m_data + sizeof(IndexHeader));
+    const quint16* units = value.utf16();
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        const TextRecord& record = records[middle];
+        if (compareKeys(record.prefix, keyUnits(m_data, record), record.length, units, units, value.size()) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+int ColumnIndex::rowAt(int position) const
+{
+    if (m_keyType == KeyType::Number)
+        return reinterpret_cast<const NumberRecord*>(m_data + sizeof(IndexHeader))[position].row;
+    return reinterpret_cast<const TextRecord*>(m_data + sizeof(IndexHeader))[position].row;
+}
+
+const qint32* ColumnIndex::suffixMinRows() const
+{
+    return reinterpret_cast<const qint32*>(m_data + IndexLayout(m_keyType, m_size, 0).suffixOffset);
+}
@@ -0,0 +1,141 @@
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include "DataSource.h"
+#include <QFile>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief 列二级索引，按值查找行
+ *
+ * 索引是按（键，行号）排序的定长记录数组：一列全部为数字时按数值比较，否则按文本（UTF-16码元）比较，
+ * 空值不进入索引。文本记录只内联键的前8个字符，更长的键放在文件末尾的堆中，记录保存其偏移量。
+ * 另外保存一个后缀最小行号数组，因此"等于某值的第一行"和"第一个大于等于某值的行"都只需要一次二分查找。
+ * 索引整体放在文件中，通过内存映射查找，不把键读入内存：建立时各块在线程池中并行提取、排序，
+ * 写入临时文件中的有序段，再多路归并到索引文件。数据源有对应文件时，索引保存在文件旁边，
+ * 文件大小、修改时间和行数不变时直接映射；否则使用随索引释放的临时文件。
+ */
+class ColumnIndex {
+public:
+    /**
+     * @brief 键类型
+     */
+    enum class KeyType {
+        Number, // 数值
+        Text // 文本
+    };
+
+    /**
+     * @brief 查找方式
+     */
+    enum class Match {
+        Equal, // 等于
+        GreaterOrEqual // 大于等于
+    };
+
+    /**
+     * @brief 获取索引的列
+     * @return 列索引
+     */
+    int column() const;
+
+    /**
+     * @brief 获取键类型
+     * @return 键类型
+     */
+    KeyType keyType() const;
+
+    /**
+     * @brief 获取索引的条目数（不含空值）
+     * @return 条目数
+     */
+    int size() const;
+
+    /**
+     * @brief 查找满足条件的第一行（行号最小的行）
+     * @param value 查找的值，数值索引中无法解析为数字时找不到
+     * @param match 查找方式
+     * @return 行号，找不到时返回-1
+     */
+    int findFirstRow(const QString& value, Match match = Match::Equal) const;
+
+    /**
+     * @brief 在当前线程中建立索引，分块任务在线程池中并行执行
+     * @param source 数据源
+     * @param column 列索引
+     * @param pool 线程池
+     * @param cancelled 取消标志
+     * @param chunkSize 每个任务读取的行数
+     * @return 索引，取消时返回nullptr
+     */
+    static std::shared_ptr<ColumnIndex> build(std::shared_ptr<DataSource> source, int column,
+        QThreadPool* pool, const std::atomic<bool>& cancelled, int chunkSize = 50000);
+
+    /**
+     * @brief 获取索引文件路径
+     * @param sourcePath 数据源文件路径
+     * @param column 列索引
+     * @return 索引文件路径
+     */
+    static QString indexPath(const QString& sourcePath, int column);
+
+    /**
+     * @brief 从索引文件读取
+     * @param sourcePath 数据源文件路径
+     * @param column 列索引
+     * @param rowCount 数据源当前行数
+     * @return 索引，文件不存在或已过期时返回nullptr
+     */
+    static std::shared_ptr<ColumnIndex> load(const QString& sourcePath, int column, int rowCount);
+
+    /**
+     * @brief 保存到数据源文件旁边的索引文件
+     * @param sourcePath 数据源文件路径
+     * @param rowCount 数据源行数
+     * @return 是否保存成功
+     */
+    bool save(const QString& sourcePath, int rowCount) const;
+
+private:
+    ColumnIndex();
+
+    /**
+     * @brief 映射索引文件，检查文件头和各部分的大小
+     * @param file 已打开的索引文件，成功时由索引持有
+     * @return 是否成功
+     */
+    bool attach(std::unique_ptr<QFile> file);
+
+    /**
+     * @brief 在排序后的键中二分查找第一个不小于value的位置
+     * @param value 查找的值
+     * @param ok 输出参数，值无法按键类型解析时置为false
+     * @return 位置
+     */
+    int lowerBound(const QString& value, bool* ok) const;
+
+    /**
+     * @brief 获取位置上记录的行号
+     * @param position 位置
+     * @return 行号
+     */
+    int rowAt(int position) const;
+
+    /**
+     * @brief 获取后缀最小行号数组：从每个位置到末尾的最小行号
+     * @return 映射在文件中的数组
+     */
+    const qint32* suffixMinRows() const;
+
+    int m_column; // 列索引
+    KeyType m_keyType; // 键类型
+    int m_size; // 条目数
+    std::unique_ptr<QFile> m_file; // 映射的索引文件：读取的.vtidx文件或新建立的临时文件
+    const uchar* m_data; // 文件内容
+    qint64 m_fileSize; // 文件大小
+};
+
+#endif // COLUMNINDEX_H
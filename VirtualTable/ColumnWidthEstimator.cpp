@@ -0,0 +1,168 @@
+#include "ColumnWidthEstimator.h"
+#include <QFontMetrics>
+#include <QtConcurrent>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// 抽样分成的段数，每段读取连续的行，顺序读取比逐行随机读取快得多
+constexpr int SampleWindowCount = 32;
+
+}
+
+ColumnWidthEstimator::ColumnWidthEstimator(QObject* parent)
+    : QObject(parent)
+    , m_sampleSize(2000)
+    , m_percentile(0.9)
+    , m_minimumWidth(40)
+    , m_maximumWidth(400)
+{
+    connect(&m_watcher, &QFutureWatcher<QVector<int>>::finished, this, &ColumnWidthEstimator::onFinished);
+}
+
+ColumnWidthEstimator::~ColumnWidthEstimator()
+{
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void ColumnWidthEstimator::setSampleSize(int rowCount)
+{
+    if (rowCount > 0) {
+        m_sampleSize = rowCount;
+    }
+}
+
+void ColumnWidthEstimator::setPercentile(double percentile)
+{
+    m_percentile = std::max(0.0, std::min(1.0, percentile));
+}
+
+void ColumnWidthEstimator::setWidthRange(int minimumWidth, int maximumWidth)
+{
+    if (minimumWidth > 0 && maximumWidth >= minimumWidth) {
+        m_minimumWidth = minimumWidth;
+        m_maximumWidth = maximumWidth;
+    }
+}
+
+bool ColumnWidthEstimator::estimate(std::shared_ptr<DataSource> source, const QFont& font, const QFont& headerFont)
+{
+    if (!source)
+        return false;
+
+    cancel();
+
+    // QFontMetrics只能在界面线程使用，这里一次性生成宽度表
+    QFontMetrics metrics(font);
+    WidthTable table;
+    for (int ch = 0; ch < 128; ++ch) {
+        table.ascii[ch] = metrics.horizontalAdvance(QChar(ch));
+    }
+    table.wide = metrics.horizontalAdvance(QChar(0x4E2D));
+    table.margin = 2 * (metrics.horizontalAdvance(QLatin1Char(' ')) + 4);
+
+    // 表头只有几列，直接精确测量
+    QFontMetrics headerMetrics(headerFont);
+    QVector<int> headerWidths;
+    for (const QString& header : source->headerData()) {
+        headerWidths.append(headerMetrics.horizontalAdvance(header) + table.margin);
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_cancelled = cancelled;
+    int sampleSize = m_sampleSize;
+    double percentile = m_percentile;
+    int minimumWidth = m_minimumWidth;
+    int maximumWidth = m_maximumWidth;
+    m_watcher.setFuture(QtConcurrent::run([=]() {
+        return run(source, table, headerWidths, sampleSize, percentile, minimumWidth, maximumWidth, cancelled);
+    }));
+    return true;
+}
+
+void ColumnWidthEstimator::cancel()
+{
+    if (m_cancelled) {
+        *m_cancelled = true;
+    }
+}
+
+QVector<int> ColumnWidthEstimator::run(std::shared_ptr<DataSource> source, WidthTable table,
+    QVector<int> headerWidths, int sampleSize, double percentile,
+    int minimumWidth, int maximumWidth, std::shared_ptr<std::atomic<bool>> cancelled)
+{
+    const int rowCount = source->rowCount();
+    const int columnCount = source->columnCount();
+    if (columnCount <= 0)
+        return QVector<int>();
+
+    // 在整个数据范围内均匀分布抽样段
+    int windowCount = std::max(1, std::min(SampleWindowCount, sampleSize));
+    int windowSize = std::max(1, sampleSize / windowCount);
+    if (rowCount <= sampleSize) {
+        windowCount = rowCount > 0 ? 1 : 0;
+        windowSize = rowCount;
+    }
+
+    std::vector<std::vector<int>> samples(columnCount);
+    for (int window = 0; window < windowCount; ++window) {
+        if (*cancelled)
+            return QVector<int>();
+
+        qint64 span = static_cast<qint64>(rowCount) - windowSize;
+        int startRow = windowCount > 1 ? static_cast<int>(span * window / (windowCount - 1)) : 0;
+        const QList<QList<QVariant>> rows = source->loadData(startRow, windowSize);
+        for (const QList<QVariant>& row : rows) {
+            int columns = std::min(columnCount, row.size());
+            for (int column = 0; column < columns; ++column) {
+                samples[column].push_back(textWidth(row[column].toString(), table));
+            }
+        }
+    }
+
+    QVector<int> widths(columnCount, minimumWidth);
+    for (int column = 0; column < columnCount; ++column) {
+        std::vector<int>& values = samples[column];
+        int width = 0;
+        if (!values.empty()) {
+            // 取百分位数而不是最大值，少量超长文本由省略号处理
+            size_t nth = static_cast<size_t>(percentile * (values.size() - 1));
+            std::nth_element(values.begin(), values.begin() + nth, values.end());
+            width = values[nth] + table.margin;
+        }
+        if (column < headerWidths.size()) {
+            width = std::max(width, headerWidths[column]);
+        }
+        widths[column] = std::max(minimumWidth, std::min(maximumWidth, width));
+    }
+
+    return widths;
+}
+
+int ColumnWidthEstimator::textWidth(const QString& text, const WidthTable& table)
+{
+    int width = 0;
+    for (const QChar ch : text) {
+        ushort unicode = ch.unicode();
+        if (unicode < 128) {
+            width += table.ascii[unicode];
+        } else if (!ch.isLowSurrogate()) {
+            // 代理对只计一次
+            width += table.wide;
+        }
+    }
+    return width;
+}
+
+void ColumnWidthEstimator::onFinished()
+{
+    if (!m_cancelled || *m_cancelled)
+        return;
+
+    QVector<int> widths = m_watcher.result();
+    if (!widths.isEmpty()) {
+        emit estimated(widths);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef COLUMNWIDTHESTIMATOR_H
+#define COLUMNWIDTHESTIMATOR_H
+
+#include "DataSource.h"
+#include <QFont>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief 抽样估算列宽
+ *
+ * QHeaderView::ResizeToContents只能测量已加载的单元格，强制加载全部数据又太慢。
+ * 这个类在后台从整个数据源中均匀抽取若干段连续行，用预先计算好的ASCII字符宽度表
+ * 累加文本宽度（非ASCII字符按一个汉字宽度计），取百分位数作为列宽，
+ * 避免个别超长值把列撑得过宽。代价只和抽样行数有关，与总行数无关。
+ */
+class ColumnWidthEstimator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit ColumnWidthEstimator(QObject* parent = nullptr);
+    ~ColumnWidthEstimator() override;
+
+    /**
+     * @brief 设置抽样行数
+     * @param rowCount 抽样行数
+     */
+    void setSampleSize(int rowCount);
+
+    /**
+     * @brief 设置列宽取值的百分位
+     * @param percentile 0到1之间，默认0.9
+     */
+    void setPercentile(double percentile);
+
+    /**
+     * @brief 设置列宽范围
+     * @param minimumWidth 最小列宽
+     * @param maximumWidth 最大列宽
+     */
+    void setWidthRange(int minimumWidth, int maximumWidth);
+
+    /**
+     * @brief 在后台开始估算，之前未完成的估算会被取消
+     * @param source 数据源
+     * @param font 单元格字体，字符宽度表在调用线程中根据它生成
+     * @param headerFont 表头字体
+     * @return 是否成功启动
+     */
+    bool estimate(std::shared_ptr<DataSource> source, const QFont& font, const QFont& headerFont);
+
+    /**
+     * @brief 取消正在进行的估算
+     */
+    void cancel();
+
+signals:
+    /**
+     * @brief 估算完成信号
+     * @param widths 每列的估算宽度（像素，已包含边距）
+     */
+    void estimated(const QVector<int>& widths);
+
+private:
+    /**
+     * @brief 字符宽度表，在界面线程中生成后交给后台线程只读使用
+     */
+    struct WidthTable {
+        int ascii[128]; // ASCII字符宽度
+        int wide; // 非ASCII字符宽度
+        int margin; // 单元格左右边距之和
+    };
+
+    /**
+     * @brief 在后台线程中执行估算
+     */
+    static QVector<int> run(std::shared_ptr<DataSource> source, WidthTable table,
+        QVector<int> headerWidths, int sampleSize, double percentile,
+        int minimumWidth, int maximumWidth, std::shared_ptr<std::atomic<bool>> cancelled);
+
+    /**
+     * @brief 用宽度表计算文本宽度
+     */
+    static int textWidth(const QString& text, const WidthTable& table);
+
+    /**
+     * @brief 处理后台估算完成
+     */
+    void onFinished();
+
+    QFutureWatcher<QVector<int>> m_watcher; // 后台估算任务
+    std::shared_ptr<std::atomic<bool>> m_cancelled; // 当前任务的取消标志
+    int m_sampleSize; // 抽样行数
+    double m_percentile; // 列宽百分位
+    int m_minimumWidth; // 最小列宽
+    int m_maximumWidth; // 最大列宽
+};
+
+#endif // COLUMNWIDTHESTIMATOR_H
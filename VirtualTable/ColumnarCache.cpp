@@ -0,0 +1,212 @@
+#include "ColumnarCache.h"
+#include <QDataStream>
+#include <algorithm>
+
+ColumnarCache::ColumnarCache(int rowCount, int columnCount, qint64 memoryBudget)
+    : m_rowCount(std::max(0, rowCount))
+    , m_columnCount(std::max(0, columnCount))
+    , m_memoryBudget(memoryBudget)
+    , m_memoryUsage(0)
+    , m_accessClock(0)
+    , m_storedCount(0)
+    , m_spilledCount(0)
+{
+    m_chunks.resize(static_cast<int>((static_cast<qint64>(m_rowCount) + ChunkRows - 1) / ChunkRows));
+}
+
+bool ColumnarCache::storeChunk(int chunk, const QList<QList<QVariant>>& rows)
+{
+    if (chunk < 0 || chunk >= m_chunks.size())
+        return false;
+
+    // 转换在锁外完成，多个线程可以同时转换不同的段
+    QVector<ColumnChunk> columns(m_columnCount);
+    for (int column = 0; column < m_columnCount; ++column) {
+        ColumnChunk& target = columns[column];
+        target.ends.reserve(rows.size());
+        for (const QList<QVariant>& rowData : rows) {
+            if (column < rowData.size())
+                target.text += rowData[column].toString();
+            target.ends.append(static_cast<quint32>(target.text.size()));
+        }
+        target.text.squeeze();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Chunk& entry = m_chunks[chunk];
+    if (entry.stored)
+        return true;
+
+    entry.columns = std::move(columns);
+    entry.bytes = chunkBytes(entry.columns);
+    entry.stored = true;
+    entry.lastAccess = ++m_accessClock;
+    m_memoryUsage += entry.bytes;
+    ++m_storedCount;
+    return enforceBudget(chunk);
+}
+
+bool ColumnarCache::readRows(int startRow, int count, QList<QList<QVariant>>* rows)
+{
+    const int endRow = std::min(startRow + count, m_rowCount);
+    if (startRow < 0 || startRow >= endRow)
+        return false;
+
+    // 锁内只复制段状态，各列数据是隐式共享的，复制不涉及文本
+    const int firstChunk = startRow / ChunkRows;
+    const int lastChunk = (endRow - 1) / ChunkRows;
+    QVector<Chunk> chunks;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int chunk = firstChunk; chunk <= lastChunk; ++chunk) {
+            if (!m_chunks[chunk].stored)
+                return false;
+        }
+        for (int chunk = firstChunk; chunk <= lastChunk; ++chunk) {
+            m_chunks[chunk].lastAccess = ++m_accessClock;
+            chunks.append(m_chunks[chunk]);
+        }
+    }
+
+    // 溢出的段在锁外读回，读盘期间其他线程仍可以读取内存中的段
+    QVector<int> reloaded;
+    for (int i = 0; i < chunks.size(); ++i) {
+        if (chunks[i].spilled) {
+            if (!loadSpilled(&chunks[i]))
+                return false;
+            reloaded.append(i);
+        }
+    }
+
+    rows->clear();
+    rows->reserve(endRow - startRow);
+    for (int i = 0; i < chunks.size(); ++i) {
+        const Chunk& entry = chunks[i];
+        const int chunkStart = (firstChunk + i) * ChunkRows;
+        const int first = std::max(startRow, chunkStart) - chunkStart;
+        const int last = std::min(endRow, chunkStart + ChunkRows) - chunkStart;
+        for (int row = first; row < last; ++row) {
+            QList<QVariant> rowData;
+            rowData.reserve(m_columnCount);
+            for (const ColumnChunk& column : entry.columns) {
+                // 数据源返回的行数少于段的行数时，缺少的行视为读取失败
+                if (row >= column.ends.size())
+                    return false;
+                const int begin = row > 0 ? static_cast<int>(column.ends[row - 1]) : 0;
+                rowData.append(column.text.mid(begin, static_cast<int>(column.ends[row]) - begin));
+            }
+            rows->append(rowData);
+        }
+    }
+
+    if (!reloaded.isEmpty()) {
+        // 读回的段放回缓存，其他线程可能已经先放回了；之后内存可能超出预算
+        QMutexLocker locker(&m_mutex);
+        for (int i : reloaded) {
+            Chunk& entry = m_chunks[firstChunk + i];
+            if (!entry.spilled)
+                continue;
+            entry.columns = chunks[i].columns;
+            entry.bytes = chunks[i].bytes;
+            entry.spilled = false;
+            m_memoryUsage += entry.bytes;
+            --m_spilledCount;
+        }
+        enforceBudget(lastChunk);
+    }
+    return true;
+}
+
+bool ColumnarCache::isComplete() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_storedCount == m_chunks.size();
+}
+
+qint64 ColumnarCache::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsage;
+}
+
+int ColumnarCache::spilledChunkCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_spilledCount;
+}
+
+qint64 ColumnarCache::chunkBytes(const QVector<ColumnChunk>& columns)
+{
+    qint64 bytes = 0;
+    for (const ColumnChunk& column : columns)
+        bytes += column.text.capacity() * sizeof(QChar) + column.ends.capacity() * sizeof(quint32);
+    return bytes;
+}
+
+bool ColumnarCache::loadSpilled(Chunk* entry)
+{
+    QByteArray bytes;
+    {
+        QMutexLocker locker(&m_fileMutex);
+        if (!m_spillFile.seek(entry->fileOffset))
+            return false;
+        bytes = m_spillFile.read(entry->fileSize);
+    }
+    if (bytes.size() != entry->fileSize)
+        return false;
+
+    QDataStream in(bytes);
+    QVector<ColumnChunk> columns(m_columnCount);
+    for (ColumnChunk& column : columns)
+        in >> column.text >> column.ends;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    // 文件中的副本保留，再次被换出时不需要重写
+    entry->columns = std::move(columns);
+    entry->bytes = chunkBytes(entry->columns);
+    entry->spilled = false;
+    return true;
+}
+
+bool ColumnarCache::enforceBudget(int keep)
+{
+    while (m_memoryUsage > m_memoryBudget) {
+        // 找出最久未访问的内存中的段
+        int victim = -1;
+        for (int chunk = 0; chunk < m_chunks.size(); ++chunk) {
+            const Chunk& entry = m_chunks[chunk];
+            if (chunk == keep || !entry.stored || entry.spilled)
+                continue;
+            if (victim < 0 || entry.lastAccess < m_chunks[victim].lastAccess)
+                victim = chunk;
+        }
+        if (victim < 0)
+            return true;
+
+        Chunk& entry = m_chunks[victim];
+        if (entry.fileSize == 0) {
+            QByteArray bytes;
+            QDataStream out(&bytes, QIODevice::WriteOnly);
+            for (const ColumnChunk& column : entry.columns)
+                out << column.text << column.ends;
+
+            QMutexLocker fileLocker(&m_fileMutex);
+            if (!m_spillFile.isOpen() && !m_spillFile.open())
+                return false;
+            const qint64 offset = m_spillFile.size();
+            if (!m_spillFile.seek(offset) || m_spillFile.write(bytes) != bytes.size())
+                return false;
+            entry.fileOffset = offset;
+            entry.fileSize = bytes.size();
+        }
+
+        entry.columns.clear();
+        entry.columns.squeeze();
+        entry.spilled = true;
+        m_memoryUsage -= entry.bytes;
+        entry.bytes = 0;
+        ++m_spilledCount;
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef COLUMNARCACHE_H
+#define COLUMNARCACHE_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTemporaryFile>
+#include <QVariant>
+#include <QVector>
+
+/**
+ * @brief 全表列式缓存，用于"加载全部"模式
+ *
+ * 数据按固定行数分段，每段的每一列把所有单元格文本拼接成一个字符串，另存每行的结束位置，
+ * 比逐单元格保存QVariant节省大量内存和分配次数。内存占用超过预算时，
+ * 最久未访问的段整段写入临时文件，之后被访问时再读回。值统一保存为文本。
+ * 所有方法都可以在多个线程中同时调用。
+ */
+class ColumnarCache {
+public:
+    /**
+     * @brief 每段的行数
+     */
+    static constexpr int ChunkRows = 65536;
+
+    /**
+     * @brief 构造函数
+     * @param rowCount 总行数
+     * @param columnCount 列数
+     * @param memoryBudget 内存预算（字节）
+     */
+    ColumnarCache(int rowCount, int columnCount, qint64 memoryBudget);
+
+    /**
+     * @brief 写入一段数据
+     * @param chunk 段索引
+     * @param rows 该段的全部行数据
+     * @return 是否成功（写临时文件失败时返回false）
+     */
+    bool storeChunk(int chunk, const QList<QList<QVariant>>& rows);
+
+    /**
+     * @brief 读取连续的行
+     * @param startRow 起始行
+     * @param count 行数
+     * @param rows 输出参数，读取的行数据
+     * @return 范围内的段是否都已写入
+     */
+    bool readRows(int startRow, int count, QList<QList<QVariant>>* rows);
+
+    /**
+     * @brief 是否已写入全部段
+     * @return 是否完整
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief 获取内存中段的估算占用
+     * @return 字节数
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief 获取已写入临时文件的段数
+     * @return 段数
+     */
+    int spilledChunkCount() const;
+
+private:
+    /**
+     * @brief 一段中的一列
+     */
+    struct ColumnChunk {
+        QString text; // 所有单元格文本依次拼接
+        QVector<quint32> ends; // 每行文本在text中的结束位置
+    };
+
+    /**
+     * @brief 一段的状态
+     */
+    struct Chunk {
+        QVector<ColumnChunk> columns; // 各列数据，写入临时文件后为空
+        bool stored = false; // 是否已写入
+        bool spilled = false; // 是否在临时文件中
+        qint64 fileOffset = 0; // 在临时文件中的位置
+        qint64 fileSize = 0; // 在临时文件中的大小
+        qint64 bytes = 0; // 在内存中的估算占用
+        quint64 lastAccess = 0; // 最后访问序号
+    };
+
+    /**
+     * @brief 估算一段在内存中的占用
+     */
+    static qint64 chunkBytes(const QVector<ColumnChunk>& columns);
+
+    /**
+     * @brief 从临时文件读回一段，不需要持有m_mutex
+     * @param entry 段状态的副本，成功后填入各列数据并标记为在内存中
+     * @return 是否成功
+     */
+    bool loadSpilled(Chunk* entry);
+
+    /**
+     * @brief 把最久未访问的段写入临时文件，直到内存占用不超过预算，调用前需持有锁
+     * @param keep 不能写出的段
+     * @return 是否成功
+     */
+    bool enforceBudget(int keep);
+
+    const int m_rowCount; // 总行数
+    const int m_columnCount; // 列数
+    const qint64 m_memoryBudget; // 内存预算（字节）
+    mutable QMutex m_mutex; // 保护以下除m_spillFile外的所有成员
+    QVector<Chunk> m_chunks; // 各段状态
+    QMutex m_fileMutex; // 保护m_spillFile的读写位置，需要同时持有时先锁m_mutex
+    QTemporaryFile m_spillFile; // 溢出的段
+    qint64 m_memoryUsage; // 内存中段的估算占用
+    quint64 m_accessClock; // 访问序号
+    int m_storedCount; // 已写入的段数
+    int m_spilledCount; // 在临时文件中的段数
+};
+
+#endif // COLUMNARCACHE_H
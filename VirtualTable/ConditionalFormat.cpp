@@ -0,0 +1,161 @@
+#include "ConditionalFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+ConditionalFormat::ConditionalFormat()
+{
+    m_styles.append(Style());
+}
+
+bool ConditionalFormat::isEmpty() const
+{
+    return m_rules.isEmpty();
+}
+
+void ConditionalFormat::clear()
+{
+    m_rules.clear();
+    m_styles.clear();
+    m_styles.append(Style());
+}
+
+bool ConditionalFormat::addThreshold(int column, Comparison comparison, double value, const Style& style)
+{
+    if (column < 0 || m_styles.size() > MaxStyleCount)
+        return false;
+
+    Rule rule;
+    rule.column = column;
+    rule.heatmap = false;
+    rule.comparison = comparison;
+    rule.value = value;
+    rule.minimum = 0.0;
+    rule.maximum = 0.0;
+    rule.steps = 1;
+    rule.firstStyle = static_cast<quint8>(m_styles.size());
+    m_styles.append(style);
+    m_rules.append(rule);
+    return true;
+}
+
+bool ConditionalFormat::addHeatmap(int column, double minimum, double maximum,
+    const QColor& low, const QColor& high, int steps)
+{
+    if (column < 0 || steps < 2 || maximum <= minimum || m_styles.size() + steps > MaxStyleCount + 1)
+        return false;
+
+    Rule rule;
+    rule.column = column;
+    rule.heatmap = true;
+    rule.comparison = Comparison::Greater;
+    rule.value = 0.0;
+    rule.minimum = minimum;
+    rule.maximum = maximum;
+    rule.steps = steps;
+    rule.firstStyle = static_cast<quint8>(m_styles.size());
+
+    // 每一级预先生成一个样式，计算时只需算出级数
+    for (int step = 0; step < steps; ++step) {
+        double t = static_cast<double>(step) / (steps - 1);
+        Style style;
+        style.background = QColor::fromRgbF(low.redF() + (high.redF() - low.redF()) * t,
+            low.greenF() + (high.greenF() - low.greenF()) * t,
+            low.blueF() + (high.blueF() - low.blueF()) * t);
+        m_styles.append(style);
+    }
+    m_rules.append(rule);
+    return true;
+}
+
+const ConditionalFormat::Style* ConditionalFormat::style(quint8 index) const
+{
+    if (index == 0 || index >= m_styles.size())
+        return nullptr;
+    return &m_styles[index];
+}
+
+void ConditionalFormat::evaluate(const QList<QList<QVariant>>& rows, int columnCount, quint8* out) const
+{
+    if (m_rules.isEmpty() || rows.isEmpty())
+        return;
+
+    const int count = rows.size();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> values(count);
+    std::vector<quint8> styles(count);
+
+    // 按列处理：同一列的数值只解析一次，规则在连续数组上计算，最后按行优先写回
+    QVector<int> columns;
+    for (const Rule& rule : m_rules) {
+        if (rule.column < columnCount && !columns.contains(rule.column))
+            columns.append(rule.column);
+    }
+
+    for (int column : columns) {
+        for (int row = 0; row < count; ++row) {
+            const QList<QVariant>& rowData = rows[row];
+            bool ok = false;
+            double value = column < rowData.size() ? rowData[column].toDouble(&ok) : 0.0;
+            values[row] = ok ? value : nan;
+        }
+        std::fill(styles.begin(), styles.end(), 0);
+
+        for (const Rule& rule : m_rules) {
+            if (rule.column == column)
+                applyRule(rule, values.data(), styles.data(), count);
+        }
+
+        quint8* target = out + column;
+        for (int row = 0; row < count; ++row) {
+            target[static_cast<size_t>(row) * columnCount] = styles[row];
+        }
+    }
+}
+
+void ConditionalFormat::applyRule(const Rule& rule, const double* values, quint8* styles, int count)
+{
+    const quint8 style = rule.firstStyle;
+
+    if (rule.heatmap) {
+        // 热力图：把数值映射到颜色级数，超出范围的值取两端
+        const double scale = (rule.steps - 1) / (rule.maximum - rule.minimum);
+        const double lastStep = rule.steps - 1;
+        for (int i = 0; i < count; ++i) {
+            double step = std::min(lastStep, std::max(0.0, (values[i] - rule.minimum) * scale + 0.5));
+            quint8 heat = static_cast<quint8>(style + static_cast<int>(step));
+            styles[i] = values[i] == values[i] ? heat : styles[i];
+        }
+        return;
+    }
+
+    // 循环体没有分支（NaN参与比较结果为false），编译器可以生成SIMD比较和混合指令
+    const double x = rule.value;
+    switch (rule.comparison) {
+    case Comparison::Greater:
+        for (int i = 0; i < count; ++i)
+            styles[i] = values[i] > x ? style : styles[i];
+        break;
+    case Comparison::GreaterOrEqual:
+        for (int i = 0; i < count; ++i)
+            styles[i] = values[i] >= x ? style : styles[i];
+        break;
+    case Comparison::Less:
+        for (int i = 0; i < count; ++i)
+            styles[i] = values[i] < x ? style : styles[i];
+        break;
+    case Comparison::LessOrEqual:
+        for (int i = 0; i < count; ++i)
+            styles[i] = values[i] <= x ? style : styles[i];
+        break;
+    case Comparison::Equal:
+        for (int i = 0; i < count; ++i)
+            styles[i] = values[i] == x ? style : styles[i];
+        break;
+    case Comparison::NotEqual:
+        for (int i = 0; i < count; ++i)
+            styles[i] = (values[i] == values[i] && values[i] != x) ? style : styles[i];
+        break;
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef CONDITIONALFORMAT_H
+#define CONDITIONALFORMAT_H
+
+#include <QColor>
+#include <QList>
+#include <QVariant>
+#include <QVector>
+
+/**
+ * @brief 条件格式
+ *
+ * 由阈值规则（如薪资大于X标红）和热力图规则组成。规则在加载线程中按块批量计算：
+ * 每列先解析为连续的double数组，再用无分支的循环逐条应用规则（编译器可以向量化），
+ * 结果是每个单元格一个字节的样式索引，和显示文本一起保存在数据块中，
+ * 绘制时只需查表取颜色。同一列的多条规则按添加顺序应用，后添加的优先。
+ */
+class ConditionalFormat {
+public:
+    /**
+     * @brief 比较方式
+     */
+    enum class Comparison {
+        Greater, // 大于
+        GreaterOrEqual, // 大于等于
+        Less, // 小于
+        LessOrEqual, // 小于等于
+        Equal, // 等于
+        NotEqual // 不等于
+    };
+
+    /**
+     * @brief 单元格样式，无效颜色表示不修改
+     */
+    struct Style {
+        QColor background; // 背景色
+        QColor foreground; // 文字颜色
+    };
+
+    /**
+     * @brief 样式索引最多255个，0表示没有样式
+     */
+    static constexpr int MaxStyleCount = 255;
+
+    ConditionalFormat();
+
+    /**
+     * @brief 是否没有任何规则
+     * @return 是否为空
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 清除所有规则
+     */
+    void clear();
+
+    /**
+     * @brief 添加阈值规则
+     * @param column 列索引
+     * @param comparison 比较方式
+     * @param value 比较值
+     * @param style 满足条件时的样式
+     * @return 是否添加成功（样式数超过上限时失败）
+     */
+    bool addThreshold(int column, Comparison comparison, double value, const Style& style);
+
+    /**
+     * @brief 添加热力图规则，按数值在[minimum, maximum]中的位置在两种颜色间插值
+     * @param column 列索引
+     * @param minimum 最小值
+     * @param maximum 最大值
+     * @param low 最小值对应的背景色
+     * @param high 最大值对应的背景色
+     * @param steps 颜色级数
+     * @return 是否添加成功（样式数超过上限时失败）
+     */
+    bool addHeatmap(int column, double minimum, double maximum,
+        const QColor& low, const QColor& high, int steps = 16);
+
+    /**
+     * @brief 获取样式
+     * @param index 样式索引
+     * @return 样式指针，索引为0或无效时返回nullptr
+     */
+    const Style* style(quint8 index) const;
+
+    /**
+     * @brief 为一个数据块批量计算样式索引
+     * @param rows 数据块的行数据
+     * @param columnCount 列数
+     * @param out 输出，按行优先排列（行 * 列数 + 列），调用前应清零
+     */
+    void evaluate(const QList<QList<QVariant>>& rows, int columnCount, quint8* out) const;
+
+private:
+    /**
+     * @brief 一条规则
+     */
+    struct Rule {
+        int column; // 列索引
+        bool heatmap; // 是否为热力图规则
+        Comparison comparison; // 阈值规则的比较方式
+        double value; // 阈值规则的比较值
+        double minimum; // 热力图最小值
+        double maximum; // 热力图最大值
+        int steps; // 热力图颜色级数
+        quint8 firstStyle; // 规则使用的第一个样式索引
+    };
+
+    /**
+     * @brief 把一条规则应用到一列
+     * @param rule 规则
+     * @param values 该列的数值，非数值为NaN
+     * @param styles 该列的样式索引
+     * @param count 行数
+     */
+    static void applyRule(const Rule& rule, const double* values, quint8* styles, int count);
+
+    QVector<Rule> m_rules; // 规则列表
+    QVector<Style> m_styles; // 样式表，下标0为空样式
+};
+
+#endif // CONDITIONALFORMAT_H
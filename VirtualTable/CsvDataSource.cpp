@@ -1,32 +1,195 @@
 #include "CsvDataSource.h"
+#include "CsvEncoding.h"
+#include <QDataStream>
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QTextCodec>
+#include <QtConcurrent>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+
+namespace {
+
+// 每批解析的行数，扫描结果在这一批生成完之前一直保留
+constexpr int ParseBatchRows = 4096;
+
+// 两层行缓存的默认预算
+constexpr qint64 DefaultHotCacheBytes = 32 * 1024 * 1024;
+constexpr qint64 DefaultColdCacheBytes = 32 * 1024 * 1024;
+
+/**
+ * @brief 字段首尾是否有会被解析时去掉的空白
+ */
+bool hasEdgeSpace(const char* data, const CsvTokenizer::Field& field)
+{
+    if (field.begin == field.end)
+        return false;
+
+    const unsigned char first = static_cast<unsigned char>(data[field.begin]);
+    const unsigned char last = static_cast<unsigned char>(data[field.end - 1]);
+    auto isAsciiSpace = [](unsigned char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); };
+    if (first < 0x80 && last < 0x80)
+        return isAsciiSpace(first) || isAsciiSpace(last);
+
+    // 非ASCII的首尾字符可能是全角空格等Unicode空白，解码后判断
+    const QString text = QString::fromUtf8(data + field.begin, field.end - field.begin);
+    return text.isEmpty() || text.at(0).isSpace() || text.at(text.size() - 1).isSpace();
+}
+
+/**
+ * @brief 在UTF-16内容中查找下一个CR或LF单元
+ * @param data 文件内容
+ * @param from 起始位置（字节）
+ * @param size 字节数
+ * @param highByte 每个单元高字节的位置，小端为1，大端为0
+ * @return 行结束符的字节位置，没有时返回size
+ */
+qint64 findUtf16LineEnd(const char* data, qint64 from, qint64 size, int highByte)
+{
+    for (qint64 p = from; p + 1 < size; p += 2) {
+        const char low = data[p + 1 - highByte];
+        if (data[p + highByte] == 0 && (low == '\n' || low == '\r'))
+            return p;
+    }
+    return size;
+}
+
+CsvDialect makeDialect(bool hasHeader, char delimiter)
+{
+    CsvDialect dialect;
+    dialect.hasHeader = hasHeader;
+    dialect.delimiter = QByteArray(1, delimiter);
+    return dialect;
+}
+
+/**
+ * @brief 估算一行解析好的数据占用的字节数，作为热层的缓存代价
+ */
+int rowCost(const QList<QVariant>& row)
+{
+    // 每个单元格约有QList节点、QVariant和字符串头部的开销，字符串内容每个字符2字节
+    int cost = 32;
+    for (const QVariant& cell : row) {
+        cost += 48;
+        if (cell.type() == QVariant::String) {
+            cost += cell.toString().size() * 2;
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief 把一组行按列序列化并压缩；同一列的值相近，压缩率更高
+ * @param rows 组内各行，列数相同
+ * @return 压缩后的字节
+ */
+QByteArray packRows(const QVector<QList<QVariant>>& rows)
+{
+    const qint32 columnCount = rows.isEmpty() ? 0 : rows.first().size();
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << columnCount;
+    for (int column = 0; column < columnCount; ++column) {
+        for (const QList<QVariant>& row : rows) {
+            stream << row.value(column);
+        }
+    }
+    // 压缩用最快的级别，解压远比重新解码和解析便宜
+    return qCompress(bytes, 1);
+}
+
+/**
+ * @brief 解压packRows()生成的一组行
+ * @param packed 压缩后的字节
+ * @param rowCount 组内行数
+ * @param rows 输出参数，组内各行
+ * @return 是否解压成功
+ */
+bool unpackRows(const QByteArray& packed, int rowCount, QVector<QList<QVariant>>* rows)
+{
+    const QByteArray bytes = qUncompress(packed);
+    if (bytes.isEmpty()) {
+        return false;
+    }
+
+    QDataStream stream(bytes);
+    qint32 columnCount = 0;
+    stream >> columnCount;
+    if (stream.status() != QDataStream::Ok || columnCount < 0) {
+        return false;
+    }
+
+    QList<QVariant> emptyRow;
+    emptyRow.reserve(columnCount);
+    for (int column = 0; column < columnCount; ++column) {
+        emptyRow.append(QVariant());
+    }
+    rows->fill(emptyRow, rowCount);
+    for (int column = 0; column < columnCount; ++column) {
+        for (int row = 0; row < rowCount; ++row) {
+            stream >> (*rows)[row][column];
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+}
+
+CsvDataSource::HotGroup::HotGroup(CacheShard* shard, int group, int rowCount)
+    : shard(shard)
+    , group(group)
+    , rowCount(rowCount)
+    , cachedCount(0)
+    , cost(0)
+    , rows(rowCount)
+    , cached(rowCount)
+{
+}
+
+CsvDataSource::HotGroup::~HotGroup()
+{
+    // 只有完整的组写入冷层；冷层已有这一组或已关闭时不必压缩
+    if (!shard || !shard->spillEvicted || cachedCount < rowCount
+        || shard->coldGroups.maxCost() == 0 || shard->coldGroups.contains(group)) {
+        return;
+    }
+    QByteArray* packed = new QByteArray(packRows(rows));
+    shard->coldGroups.insert(group, packed, packed->size());
+}
 
 CsvDataSource::CsvDataSource(const QString& filePath, bool hasHeader, char delimiter, int maxCacheSize)
+    : CsvDataSource(filePath, makeDialect(hasHeader, delimiter), maxCacheSize)
+{
+}
+
+CsvDataSource::CsvDataSource(const QString& filePath, const CsvDialect& dialect, int maxCacheSize)
     : m_filePath(filePath)
-    , m_hasHeader(hasHeader)
-    , m_delimiter(delimiter)
+    , m_dialect(dialect)
     , m_rowCount(0)
     , m_columnCount(0)
     , m_isValid(false)
     , m_mappedData(nullptr)
+    , m_codec(nullptr)
+    , m_utf16HighByte(-1)
     , m_fileSize(0)
     , m_maxCacheSize(maxCacheSize)
 {
+    setCacheBudget(DefaultHotCacheBytes, DefaultColdCacheBytes);
+
     // 初始化数据源
     m_isValid = initialize();
 }
 
 CsvDataSource::~CsvDataSource()
 {
-    // 释放内存映射
-    if (m_mappedData) {
-        m_file.unmap(m_mappedData);
-        m_mappedData = nullptr;
+    // 析构时热层清空的组不再压缩进冷层
+    for (CacheShard& shard : m_cacheShards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.spillEvicted = false;
     }
+    // 释放内存映射
+    releaseData();
     // 关闭文件
     if (m_file.isOpen()) {
         m_file.close();
@@ -45,8 +208,7 @@ int CsvDataSource::columnCount() const
 
 QList<QList<QVariant>> CsvDataSource::loadData(int startRow, int count)
 {
-    QMutexLocker locker(&m_mutex);
-
+    // 内存映射和行偏移量在初始化后不再改变，读取和解析不需要加锁
     QList<QList<QVariant>> data;
     if (!m_isValid || startRow < 0 || startRow >= m_rowCount || !m_mappedData) {
         return data;
@@ -59,42 +221,39 @@ QList<QList<QVariant>> CsvDataSource::loadData(int startRow, int count)
     if (actualCount <= 0) {
         return data;
     }
+    data.reserve(actualCount);
 
-    for (int rowIndex = startRow; rowIndex < endRow; ++rowIndex) {
-        QList<QVariant> rowData;
+    // 先从缓存取开头连续命中的行
+    QList<QVariant> rowData;
+    while (startRow + data.size() < endRow && getFromCache(startRow + data.size(), rowData)) {
+        data.append(rowData);
+    }
+    const int firstParsed = startRow + data.size();
+    if (firstParsed == endRow) {
+        return data;
+    }
 
-        // 先尝试从缓存获取
-        if (getFromCache(rowIndex, rowData)) {
-            data.append(rowData);
-            continue;
+    // 流水线：扫描下一批字段边界的同时，按列生成当前批的单元格
+    int batchEnd = std::min(firstParsed + ParseBatchRows, endRow);
+    ParsedSpan current = tokenizeRows(firstParsed, batchEnd);
+    while (true) {
+        const int nextStart = batchEnd;
+        const int nextEnd = std::min(nextStart + ParseBatchRows, endRow);
+        QFuture<ParsedSpan> next;
+        if (nextStart < endRow) {
+            next = QtConcurrent::run([this, nextStart, nextEnd]() { return tokenizeRows(nextStart, nextEnd); });
         }
 
-        // 从内存映射读取
-        QString line = getLineFromMappedData(rowIndex);
-        if (line.isNull()) {
-            // 读取失败
+        materializeRows(current, &data);
+        if (nextStart >= endRow)
             break;
-        }
-
-        // 解析行数据
-        rowData = parseLine(line);
-
-        // 确保列数一致
-        if (rowData.size() < m_columnCount) {
-            // 如果列数不足，用空值填充
-            while (rowData.size() < m_columnCount) {
-                rowData.append(QVariant());
-            }
-        } else if (rowData.size() > m_columnCount) {
-            // 如果列数过多，截断
-            rowData = rowData.mid(0, m_columnCount);
-        }
-
-        // 缓存行数据
-        cacheRow(rowIndex, rowData);
+        current = next.result();
+        batchEnd = nextEnd;
+    }
 
-        // 添加到结果集
-        data.append(rowData);
+    // 大范围读取（导出、建索引）不进入缓存，避免挤掉可见区域的行
+    if (endRow - firstParsed <= m_maxCacheSize) {
+        cacheRows(firstParsed, data, firstParsed - startRow, endRow - firstParsed);
     }
 
     return data;
@@ -110,11 +269,79 @@ QString CsvDataSource::filePath() const
     return m_filePath;
 }
 
+QByteArray CsvDataSource::encoding() const
+{
+    return m_encoding;
+}
+
+bool CsvDataSource::writeRawRows(int startRow, int count, char delimiter, QByteArray* out) const
+{
+    // 只有UTF-8文件的原始字节可以原样输出；引号不是双引号时，包含双引号的字段原样复制后与RFC 4180转义的结果不同
+    if (!m_isValid || !m_mappedData || m_encoding != "UTF-8" || m_dialect.delimiter != QByteArray(1, delimiter)
+        || m_dialect.quote != '"' || startRow < 0 || count <= 0 || startRow + count > m_rowCount) {
+        return false;
+    }
+
+    qint64 begin = 0;
+    qint64 end = 0;
+    rowSpan(startRow, startRow + count, &begin, &end);
+    if (end - begin > std::numeric_limits<int>::max() / 2)
+        return false;
+
+    // 每行字段数都等于列数，且没有字段包含引号、转义或首尾空白时，原始文本与解析后再连接的结果相同
+    const ParsedSpan span = tokenizeBytes(begin, end);
+    const CsvTokenizer::Result& tokens = span.tokens;
+    if (span.rowCount != count)
+        return false;
+
+    out->reserve(out->size() + static_cast<int>(end - begin) + count);
+    for (int row = 0; row < count; ++row) {
+        const int first = tokens.rowStarts[row];
+        const int last = tokens.rowStarts[row + 1];
+        if (last - first != m_columnCount)
+            return false;
+        for (int field = first; field < last; ++field) {
+            if (tokens.fields[field].special || hasEdgeSpace(span.data, tokens.fields[field]))
+                return false;
+        }
+
+        // 行结束符统一写成换行
+        const int fieldBegin = tokens.fields[first].begin;
+        out->append(span.data + fieldBegin, tokens.fields[last - 1].end - fieldBegin);
+        out->append('\n');
+    }
+    return true;
+}
+
+CsvDialect CsvDataSource::dialect() const
+{
+    return m_dialect;
+}
+
+QString CsvDataSource::persistentPath() const
+{
+    return m_filePath;
+}
+
 bool CsvDataSource::isValid() const
 {
     return m_isValid;
 }
 
+void CsvDataSource::setCacheBudget(qint64 hotBytes, qint64 coldBytes)
+{
+    // 预算平均分到各分片
+    auto shardCost = [](qint64 bytes) {
+        return static_cast<int>(qBound<qint64>(0, bytes / CacheShardCount, std::numeric_limits<int>::max()));
+    };
+    for (CacheShard& shard : m_cacheShards) {
+        QMutexLocker locker(&shard.mutex);
+        // 先设置冷层，热层因此淘汰的组按新的冷层预算写入
+        shard.coldGroups.setMaxCost(shardCost(coldBytes));
+        shard.hotGroups.setMaxCost(shardCost(hotBytes));
+    }
+}
+
 QString CsvDataSource::errorString() const
 {
     return m_errorString;
@@ -122,8 +349,6 @@ QString CsvDataSource::errorString() const
 
 bool CsvDataSource::initialize()
 {
-    QMutexLocker locker(&m_mutex);
-
     // 打开文件
     m_file.setFileName(m_filePath);
     if (!m_file.open(QIODevice::ReadOnly)) {
@@ -147,207 +372,248 @@ bool CsvDataSource::initialize()
         return false;
     }
 
+    // 检测编码：UTF-16与ASCII不兼容，行偏移量按两字节单元计算，加载时逐批转成UTF-8；其他编码在加载字段时才解码
+    int bomLength = 0;
+    m_encoding = CsvEncoding::detect(reinterpret_cast<const char*>(m_mappedData), m_fileSize, &bomLength);
+    if (m_encoding != "UTF-8") {
+        m_codec = QTextCodec::codecForName(m_encoding);
+    }
+    if (CsvEncoding::isUtf16(m_encoding)) {
+        m_utf16HighByte = (m_encoding == "UTF-16BE") ? 0 : 1;
+    }
+    const qint64 unitSize = m_utf16HighByte >= 0 ? 2 : 1;
+    auto findLineEnd = [this](const char* data, qint64 from) {
+        return m_utf16HighByte >= 0 ? findUtf16LineEnd(data, from, m_fileSize, m_utf16HighByte)
+                                    : CsvTokenizer::findLineEnd(data, from, m_fileSize);
+    };
+
     // 计算行偏移量并读取表头
+    const char* bytes = reinterpret_cast<const char*>(m_mappedData);
     m_rowOffsets.clear();
-    m_rowOffsets.push_back(0); // 第一行的偏移量
+    m_rowOffsets.push_back(bomLength); // 第一行的偏移量，跳过BOM
 
-    // 读取表头
-    qint64 headerEnd = 0;
-    while (headerEnd < m_fileSize && m_mappedData[headerEnd] != '\n') {
-        headerEnd++;
-    }
+    // 读取表头，行可以以LF、CRLF或CR结束
+    qint64 headerEnd = findLineEnd(bytes, bomLength);
 
     if (headerEnd >= m_fileSize) {
         m_errorString = "文件格式错误";
-        m_file.unmap(m_mappedData);
-        m_mappedData = nullptr;
+        releaseData();
         m_file.close();
         return false;
     }
 
-    // 提取表头行
-    QByteArray headerBytes(reinterpret_cast<const char*>(m_mappedData), headerEnd);
-    QString headerLine = QString::fromUtf8(headerBytes);
-    
-    // 解析表头
-    QList<QVariant> headerData = parseLine(headerLine);
+    // 解析表头，与数据行一样由扫描器处理引号和转义
+    const ParsedSpan header = tokenizeBytes(bomLength, headerEnd);
+    const int headerFields = header.tokens.rowCount() > 0 ? header.tokens.rowStarts[1] : 0;
     m_headers.clear();
-    foreach (const QVariant& var, headerData) {
-        m_headers.append(var.toString());
+    for (int column = 0; column < headerFields; ++column) {
+        // 没有表头时第一行是数据，列名按序号生成
+        m_headers.append(m_dialect.hasHeader
+                ? CsvTokenizer::fieldText(header.data, header.tokens.fields[column], m_dialect.quote, header.codec)
+                : QString("列%1").arg(column + 1));
     }
     m_columnCount = m_headers.size();
 
     // 计算总行数和行偏移量
-    if (m_hasHeader) {
+    if (m_dialect.hasHeader) {
         m_rowCount = 0;
     } else {
         m_rowCount = 1;
     }
 
-    qint64 currentOffset = headerEnd + 1; // 跳过表头行
+    // 跳过行结束符，CRLF占两个单元
+    auto nextLineStart = [this, unitSize](qint64 lineEnd) {
+        return (unitAt(lineEnd) == '\r' && lineEnd + unitSize < m_fileSize && unitAt(lineEnd + unitSize) == '\n')
+            ? lineEnd + 2 * unitSize
+            : lineEnd + unitSize;
+    };
+
+    qint64 currentOffset = nextLineStart(headerEnd); // 跳过表头行
     while (currentOffset < m_fileSize) {
-        qint64 lineEnd = currentOffset;
-        while (lineEnd < m_fileSize && m_mappedData[lineEnd] != '\n') {
-            lineEnd++;
-        }
-        
+        const qint64 lineEnd = findLineEnd(bytes, currentOffset);
+
         // 跳过空行
         if (lineEnd > currentOffset) {
             m_rowCount++;
             m_rowOffsets.push_back(currentOffset);
         }
-        
-        currentOffset = lineEnd + 1;
+
+        currentOffset = lineEnd < m_fileSize ? nextLineStart(lineEnd) : m_fileSize;
     }
 
     return m_rowCount > 0 && m_columnCount > 0;
 }
 
-QList<QVariant> CsvDataSource::readRow(int rowIndex)
+void CsvDataSource::rowSpan(int startRow, int endRow, qint64* begin, qint64* end) const
 {
-    QList<QVariant> rowData;
-
-    // 先尝试从缓存获取
-    if (getFromCache(rowIndex, rowData)) {
-        return rowData;
-    }
-
-    // 从内存映射读取
-    QString line = getLineFromMappedData(rowIndex);
-
-    if (!line.isNull()) {
-        rowData = parseLine(line);
-
-        // 确保列数一致
-        if (rowData.size() < m_columnCount) {
-            // 如果列数不足，用空值填充
-            while (rowData.size() < m_columnCount) {
-                rowData.append(QVariant());
-            }
-        } else if (rowData.size() > m_columnCount) {
-            rowData = rowData.mid(0, m_columnCount);
-        }
-
-        // 缓存行数据
-        cacheRow(rowIndex, rowData);
-    }
-
-    return rowData;
+    // 有表头时第0项是表头行
+    const size_t firstLine = static_cast<size_t>(m_dialect.hasHeader ? startRow + 1 : startRow);
+    const size_t endLine = static_cast<size_t>(m_dialect.hasHeader ? endRow + 1 : endRow);
+    *begin = m_rowOffsets[firstLine];
+    *end = endLine < m_rowOffsets.size() ? m_rowOffsets[endLine] : m_fileSize;
 }
 
-QList<QVariant> CsvDataSource::parseLine(const QString& line)
+void CsvDataSource::releaseData()
 {
-    QList<QVariant> result;
-    QString currentField;
-    bool inQuotes = false;
-    bool escaped = false;
-
-    for (int i = 0; i < line.length(); ++i) {
-        QChar c = line.at(i);
-
-        if (escaped) {
-            // 处理转义字符
-            currentField.append(c);
-            escaped = false;
-        } else if (c == '\\') {
-            // 转义字符
-            escaped = true;
-        } else if (c == '"') {
-            // 引号处理
-            inQuotes = !inQuotes;
-        } else if (c == m_delimiter && !inQuotes) {
-            // 分隔符，且不在引号内
-            result.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            // 普通字符
-            currentField.append(c);
-        }
+    if (m_mappedData) {
+        m_file.unmap(m_mappedData);
     }
+    m_mappedData = nullptr;
+}
 
-    // 添加最后一个字段
-    result.append(currentField.trimmed());
+char CsvDataSource::unitAt(qint64 offset) const
+{
+    const char* bytes = reinterpret_cast<const char*>(m_mappedData);
+    if (m_utf16HighByte < 0)
+        return bytes[offset];
+    if (offset + 1 >= m_fileSize || bytes[offset + m_utf16HighByte] != 0)
+        return 0;
+    return bytes[offset + 1 - m_utf16HighByte];
+}
 
-    return result;
+CsvDataSource::ParsedSpan CsvDataSource::tokenizeRows(int startRow, int endRow) const
+{
+    // 一批行在文件中是连续的一段，整段交给扫描器一次处理
+    qint64 begin = 0;
+    qint64 end = 0;
+    rowSpan(startRow, endRow, &begin, &end);
+    ParsedSpan span = tokenizeBytes(begin, end);
+    span.rowCount = endRow - startRow;
+    return span;
 }
 
-bool CsvDataSource::seekToRow(int rowIndex)
+CsvDataSource::ParsedSpan CsvDataSource::tokenizeBytes(qint64 begin, qint64 end) const
 {
-    // 检查参数有效性
-    if (rowIndex < 0 || rowIndex >= m_rowCount || !m_mappedData) {
-        return false;
+    ParsedSpan span;
+    const char* bytes = reinterpret_cast<const char*>(m_mappedData);
+
+    if (m_utf16HighByte >= 0) {
+        // UTF-16不能按字节扫描，只把这一批行转成UTF-8
+        span.transcoded = m_codec->toUnicode(bytes + begin, static_cast<int>(end - begin)).toUtf8();
+        span.data = span.transcoded.constData();
+        CsvTokenizer::tokenize(span.data, span.transcoded.size(), m_dialect, &span.tokens);
+        span.rowCount = span.tokens.rowCount();
+        return span;
     }
 
-    // 内存映射方式不需要文件指针操作，直接返回true
-    return true;
+    span.data = bytes + begin;
+    span.codec = m_codec;
+    CsvTokenizer::tokenize(span.data, static_cast<int>(end - begin), m_dialect, &span.tokens,
+        CsvEncoding::hasAsciiTrailBytes(m_encoding));
+    span.rowCount = span.tokens.rowCount();
+    return span;
 }
 
-QString CsvDataSource::getLineFromMappedData(int rowIndex)
+void CsvDataSource::materializeRows(const ParsedSpan& span, QList<QList<QVariant>>* rows) const
 {
-    if (rowIndex < 0 || rowIndex >= m_rowCount || !m_mappedData) {
-        return QString();
-    }
-
-    // 计算实际行索引（考虑表头）
-    int actualRowIndex = m_hasHeader ? rowIndex + 1 : rowIndex;
-    if (actualRowIndex >= m_rowOffsets.size()) {
-        return QString();
+    // 先放入全为空值的行，再逐列填入，缺少的字段保持为空值
+    QList<QVariant> emptyRow;
+    emptyRow.reserve(m_columnCount);
+    for (int column = 0; column < m_columnCount; ++column) {
+        emptyRow.append(QVariant());
     }
-
-    qint64 startOffset = m_rowOffsets[actualRowIndex];
-    if (startOffset >= m_fileSize) {
-        return QString();
+    const int base = rows->size();
+    for (int row = 0; row < span.rowCount; ++row) {
+        rows->append(emptyRow);
     }
 
-    // 找到行结束位置
-    qint64 endOffset = startOffset;
-    while (endOffset < m_fileSize && m_mappedData[endOffset] != '\n') {
-        endOffset++;
+    const CsvTokenizer::Result& tokens = span.tokens;
+    const int parsedRows = std::min(span.rowCount, tokens.rowCount());
+    for (int column = 0; column < m_columnCount; ++column) {
+        for (int row = 0; row < parsedRows; ++row) {
+            const int field = tokens.rowStarts[row] + column;
+            if (field < tokens.rowStarts[row + 1]) {
+                (*rows)[base + row][column] = CsvTokenizer::fieldText(span.data, tokens.fields[field], m_dialect.quote, span.codec);
+            }
+        }
     }
-
-    // 提取行数据
-    QByteArray lineBytes(reinterpret_cast<const char*>(m_mappedData + startOffset), endOffset - startOffset);
-    return QString::fromUtf8(lineBytes);
 }
 
-void CsvDataSource::cacheRow(int rowIndex, const QList<QVariant>& data)
+void CsvDataSource::cacheRows(int firstRow, const QList<QList<QVariant>>& rows, int offset, int count)
 {
-    // 如果缓存已满，清理最旧的缓存项
-    if (m_rowCache.size() >= m_maxCacheSize) {
-        cleanupCache();
+    const int endRow = firstRow + count;
+    int rowIndex = firstRow;
+    while (rowIndex < endRow) {
+        const int group = rowIndex / CacheShardRows;
+        const int groupStart = group * CacheShardRows;
+        const int groupEnd = std::min(groupStart + CacheShardRows, endRow);
+        CacheShard& shard = cacheShard(rowIndex);
+        QMutexLocker locker(&shard.mutex);
+
+        // take()取出时不删除对象，补齐行后按新的代价重新插入；QCache满时自动淘汰最久未访问的组，
+        // 被淘汰的完整组由HotGroup的析构函数压缩进冷层
+        HotGroup* hot = shard.hotGroups.take(group);
+        if (!hot) {
+            hot = new HotGroup(&shard, group, groupRowCount(group));
+        }
+        for (; rowIndex < groupEnd; ++rowIndex) {
+            const int index = rowIndex - groupStart;
+            if (hot->cached.testBit(index)) {
+                continue;
+            }
+            const QList<QVariant>& data = rows[offset + rowIndex - firstRow];
+            hot->rows[index] = data;
+            hot->cached.setBit(index);
+            ++hot->cachedCount;
+            hot->cost += rowCost(data);
+        }
+        shard.hotGroups.insert(group, hot, std::max(1, hot->cost));
     }
-
-    // 添加到缓存
-    m_rowCache[rowIndex] = data;
-
-    // 更新缓存顺序
-    m_cacheOrder.removeAll(rowIndex);
-    m_cacheOrder.append(rowIndex);
 }
 
 bool CsvDataSource::getFromCache(int rowIndex, QList<QVariant>& data) const
 {
-    auto it = m_rowCache.find(rowIndex);
-    if (it != m_rowCache.end()) {
-        data = it.value();
+    CacheShard& shard = cacheShard(rowIndex);
+    const int group = rowIndex / CacheShardRows;
+    const int index = rowIndex - group * CacheShardRows;
+    QByteArray packed;
+    {
+        QMutexLocker locker(&shard.mutex);
+
+        // object()同时把该组移到最近访问的位置
+        const HotGroup* hot = shard.hotGroups.object(group);
+        if (hot && hot->cached.testBit(index)) {
+            data = hot->rows[index];
+            return true;
+        }
 
-        // 更新缓存顺序（需要const_cast，因为这个方法是const的）
-        const_cast<CsvDataSource*>(this)->m_cacheOrder.removeAll(rowIndex);
-        const_cast<CsvDataSource*>(this)->m_cacheOrder.append(rowIndex);
+        const QByteArray* cold = shard.coldGroups.object(group);
+        if (!cold) {
+            return false;
+        }
+        packed = *cold;
+    }
 
-        return true;
+    // 解压在锁外进行，其他线程可以同时访问这个分片
+    HotGroup* hot = new HotGroup(&shard, group, groupRowCount(group));
+    if (!unpackRows(packed, hot->rowCount, &hot->rows)) {
+        hot->shard = nullptr;
+        delete hot;
+        return false;
+    }
+    hot->cached.fill(true);
+    hot->cachedCount = hot->rowCount;
+    for (const QList<QVariant>& row : hot->rows) {
+        hot->cost += rowCost(row);
     }
+    data = hot->rows[index];
 
-    return false;
+    // 整组放回热层，接着读取相邻的行时直接命中；热层中只有部分行的旧组直接丢弃
+    QMutexLocker locker(&shard.mutex);
+    if (HotGroup* old = shard.hotGroups.take(group)) {
+        old->shard = nullptr;
+        delete old;
+    }
+    shard.hotGroups.insert(group, hot, std::max(1, hot->cost));
+    return true;
 }
 
-void CsvDataSource::cleanupCache()
+int CsvDataSource::groupRowCount(int group) const
 {
-    if (m_cacheOrder.isEmpty()) {
-        return;
-    }
+    return std::min(CacheShardRows, m_rowCount - group * CacheShardRows);
+}
 
-    // 移除最旧的缓存项（LRU策略）
-    int oldestRow = m_cacheOrder.takeFirst();
-    m_rowCache.remove(oldestRow);
+CsvDataSource::CacheShard& CsvDataSource::cacheShard(int rowIndex) const
+{
+    return m_cacheShards[(rowIndex / CacheShardRows) % CacheShardCount];
 }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #ifndef CSVDATASOURCE_H
 #define CSVDATASOURCE_H
 
+#include "CsvDialect.h"
+#include "CsvTokenizer.h"
 #include "DataSource.h"
+#include <QBitArray>
+#include <QByteArray>
+#include <QCache>
 #include <QString>
 #include <QFile>
-#include <QTextStream>
 #include <QList>
 #include <QVariant>
-#include <QHash>
+#include <QVector>
 #include <QMutex>
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -17,6 +22,13 @@
  * 
  * 这个类实现了DataSource接口，可以从CSV文件中读取数据并提供给虚拟表格控件。
  * 支持分块加载，只在需要时读取文件的特定部分，适合处理大型CSV文件。
+ * 加载按批流水线进行：取一批行的字节范围，一次扫描整段的字段边界，再按列生成单元格；
+ * 扫描下一批与生成当前批同时进行。打开时自动检测编码（UTF-8、GB18030、UTF-16、Latin-1），
+ * 与ASCII兼容的编码直接在映射的字节上扫描，只有加载的字段才解码；UTF-16文件按两字节单元建立行偏移量，
+ * 加载时只把读取的那一批行转成UTF-8再扫描，文件仍然直接映射，大小不受限制。
+ * 解析不持有锁，行缓存分片加锁，多个线程可以同时加载不同的块。
+ * 行缓存分两层，都按字节计算容量：热层按每64行一组保存解析好的行，完整的组被热层淘汰时才按列压缩进冷层，
+ * 再次访问时从冷层解压整组，不必重新解码和解析。
  */
 class CsvDataSource : public DataSource
 {
@@ -26,9 +38,17 @@ public:
      * @param filePath CSV文件路径
      * @param hasHeader 是否包含表头
      * @param delimiter 分隔符，默认为逗号
-     * @param maxCacheSize 最大缓存行数
+     * @param maxCacheSize 单次读取进入缓存的最大行数，更大范围的读取（导出、建索引）不进入缓存
      */
     CsvDataSource(const QString &filePath, bool hasHeader = true, char delimiter = ',', int maxCacheSize = 10000);
+
+    /**
+     * @brief 按指定格式打开文件，格式通常由CsvDialect::sniff()推断
+     * @param filePath CSV文件路径
+     * @param dialect 文件格式，没有表头时列名为"列1"、"列2"……
+     * @param maxCacheSize 单次读取进入缓存的最大行数
+     */
+    CsvDataSource(const QString &filePath, const CsvDialect &dialect, int maxCacheSize = 10000);
     ~CsvDataSource() override;
 
     // 实现DataSource接口
@@ -36,6 +56,8 @@ public:
     int columnCount() const override;
     QList<QList<QVariant>> loadData(int startRow, int count) override;
     QList<QString> headerData() const override;
+    QString persistentPath() const override;
+    bool writeRawRows(int startRow, int count, char delimiter, QByteArray* out) const override;
 
     /**
      * @brief 获取文件路径
@@ -43,6 +65,18 @@ public:
      */
     QString filePath() const;
 
+    /**
+     * @brief 获取检测到的文件编码
+     * @return 编码名，如UTF-8、GB18030
+     */
+    QByteArray encoding() const;
+
+    /**
+     * @brief 获取文件格式
+     * @return 文件格式
+     */
+    CsvDialect dialect() const;
+
     /**
      * @brief 检查文件是否有效
      * @return 文件是否有效
@@ -55,6 +89,13 @@ public:
      */
     QString errorString() const;
 
+    /**
+     * @brief 设置两层行缓存的内存预算，默认各32MB
+     * @param hotBytes 解析好的行占用的字节数上限，为0时不缓存解析好的行
+     * @param coldBytes 压缩后的行组占用的字节数上限，为0时关闭压缩层
+     */
+    void setCacheBudget(qint64 hotBytes, qint64 coldBytes);
+
 private:
     // 私有方法
     /**
@@ -64,34 +105,71 @@ private:
     bool initialize();
 
     /**
-     * @brief 从文件中读取指定行
-     * @param rowIndex 行索引
-     * @return 读取的行数据
+     * @brief 获取连续多行在文件中的字节范围[begin, end)
+     *
+     * 范围到下一行的起始位置为止（最后一行到文件末尾），末尾可能带有行结束符和被跳过的空行，
+     * 扫描字段时会自动忽略，不需要单独保存每行的长度
+     * @param startRow 起始行
+     * @param endRow 结束行（不含）
+     * @param begin 输出参数，起始位置
+     * @param end 输出参数，结束位置
      */
-    QList<QVariant> readRow(int rowIndex);
+    void rowSpan(int startRow, int endRow, qint64* begin, qint64* end) const;
 
     /**
-     * @brief 解析CSV行
-     * @param line CSV行字符串
-     * @return 解析后的数据列表
+     * @brief 释放文件数据：解除内存映射，或释放转码后的内容
      */
-    QList<QVariant> parseLine(const QString &line);
+    void releaseData();
 
     /**
-     * @brief 定位到文件的指定行
-     * @param rowIndex 行索引
-     * @return 是否成功定位
+     * @brief 获取某个位置上的编码单元对应的ASCII字符，UTF-16文件按两字节单元读取
+     * @param offset 字节位置
+     * @return ASCII字符，单元不是ASCII字符时返回0
      */
-    bool seekToRow(int rowIndex);
+    char unitAt(qint64 offset) const;
 
-    QString getLineFromMappedData(int rowIndex);
+    /**
+     * @brief 一批连续行的字节范围和字段边界
+     */
+    struct ParsedSpan {
+        const char* data = nullptr; // 第一行的起始位置
+        int rowCount = 0; // 这一批的行数
+        CsvTokenizer::Result tokens; // 字段边界
+        QByteArray transcoded; // UTF-16文件这一批转成UTF-8后的内容，data指向其中
+        QTextCodec* codec = nullptr; // 生成字段文本使用的解码器，为nullptr时按UTF-8解码
+    };
 
     /**
-     * @brief 缓存行数据
-     * @param rowIndex 行索引
-     * @param data 行数据
+     * @brief 取一批行的字节范围并扫描字段边界，不访问缓存，可以在任意线程中调用
+     * @param startRow 起始行
+     * @param endRow 结束行（不含）
+     * @return 扫描结果
      */
-    void cacheRow(int rowIndex, const QList<QVariant> &data);
+    ParsedSpan tokenizeRows(int startRow, int endRow) const;
+
+    /**
+     * @brief 扫描文件中一段字节的字段边界，表头行和数据行使用同样的引号和转义规则
+     * @param begin 起始位置
+     * @param end 结束位置（不含）
+     * @return 扫描结果，rowCount为扫描出的行数
+     */
+    ParsedSpan tokenizeBytes(qint64 begin, qint64 end) const;
+
+    /**
+     * @brief 按列生成一批行的单元格，追加到rows末尾；列数不足时用空值填充，过多时截断
+     * @param span 扫描结果
+     * @param rows 输出参数，行数据
+     */
+    void materializeRows(const ParsedSpan& span, QList<QList<QVariant>>* rows) const;
+
+    /**
+     * @brief 把连续多行放入热层
+     * @param firstRow 第一行的行索引
+     * @param rows 包含这些行的行数据
+     * @param offset 第一行在rows中的位置
+     * @param count 行数
+     */
+    void cacheRows(int firstRow, const QList<QList<QVariant>> &rows, int offset, int count);
 
     /**
      * @brief 从缓存中获取行数据
@@ -102,31 +180,74 @@ private:
     bool getFromCache(int rowIndex, QList<QVariant> &data) const;
 
     /**
-     * @brief 清理缓存，移除最旧的缓存项
+     * @brief 获取一组应有的行数，最后一组可能不足CacheShardRows行
+     * @param group 组号，即行索引除以CacheShardRows
+     * @return 行数
+     */
+    int groupRowCount(int group) const;
+
+    struct CacheShard;
+
+    /**
+     * @brief 热层中的一组行
+     *
+     * QCache淘汰时删除对象，析构函数在这时把完整的组压缩进同一分片的冷层，
+     * 因此只有真正被淘汰的组才需要压缩。析构时分片的锁由调用方持有
+     */
+    struct HotGroup {
+        HotGroup(CacheShard* shard, int group, int rowCount);
+        ~HotGroup();
+
+        CacheShard* shard; // 所在分片，为nullptr时析构不写入冷层
+        int group; // 组号
+        int rowCount; // 组内应有的行数
+        int cachedCount; // 已缓存的行数
+        int cost; // 已缓存行的估算字节数
+        QVector<QList<QVariant>> rows; // 组内各行
+        QBitArray cached; // 各行是否已缓存
+    };
+
+    /**
+     * @brief 行缓存的一个分片，每个分片单独加锁
+     */
+    struct CacheShard {
+        QMutex mutex; // 保护以下成员
+        bool spillEvicted = true; // 热层淘汰的组是否写入冷层，数据源析构时关闭
+        QCache<int, QByteArray> coldGroups; // 冷层：按组号保存压缩后的行组，代价为压缩后的字节数；先于热层声明，热层析构时仍然有效
+        QCache<int, HotGroup> hotGroups; // 热层：按组号保存解析好的行，代价为估算的字节数
+    };
+
+    static constexpr int CacheShardCount = 16; // 行缓存分片数
+    static constexpr int CacheShardRows = 64; // 连续多少行放在同一个分片，也是一组的行数
+
+    /**
+     * @brief 获取行所在的缓存分片
+     * @param rowIndex 行索引
+     * @return 缓存分片
      */
-    void cleanupCache();
+    CacheShard& cacheShard(int rowIndex) const;
 
     // 私有成员变量
     QString m_filePath;               // CSV文件路径
     mutable QFile m_file;             // 文件对象
-    bool m_hasHeader;                 // 是否包含表头
-    char m_delimiter;                 // 分隔符
+    CsvDialect m_dialect;             // 文件格式：分隔符、引号、是否包含表头
     int m_rowCount;                   // 总行数
     int m_columnCount;                // 总列数
     QList<QString> m_headers;         // 表头信息
     bool m_isValid;                   // 文件是否有效
     QString m_errorString;            // 错误信息
-    mutable QMutex m_mutex;           // 互斥锁，用于线程安全
 
     // 内存映射相关
     uchar* m_mappedData;              // 映射到内存的数据
+    QByteArray m_encoding;            // 检测到的文件编码
+    QTextCodec* m_codec;              // 非UTF-8编码的解码器，UTF-8时为nullptr
+    int m_utf16HighByte;              // UTF-16文件中每个单元高字节的位置（0或1），不是UTF-16时为-1
     qint64 m_fileSize;                // 文件大小
-    std::vector<qint64> m_rowOffsets; // 存储每行的偏移量，用于快速定位
+    std::vector<qint64> m_rowOffsets; // 存储每行的偏移量，用于快速定位；行尾由下一行的偏移量确定
 
     // 缓存相关
-    int m_maxCacheSize;               // 最大缓存行数
-    QHash<int, QList<QVariant>> m_rowCache; // 行缓存
-    QList<int> m_cacheOrder;          // 缓存顺序，用于LRU缓存策略
+    int m_maxCacheSize;               // 单次读取进入缓存的最大行数
+    mutable std::array<CacheShard, CacheShardCount> m_cacheShards; // 分片的行缓存
 };
 
 #endif // CSVDATASOURCE_H
\ No newline at end of file
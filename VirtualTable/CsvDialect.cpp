@@ -0,0 +1,203 @@
+#include "CsvDialect.h"
+#include "CsvEncoding.h"
+#include "CsvTokenizer.h"
+#include <QFile>
+#include <QHash>
+#include <QTextCodec>
+#include <algorithm>
+
+namespace {
+
+// 样本大小和参与统计的行数
+constexpr qint64 SampleBytes = 4 * 1024 * 1024;
+constexpr int SampleLines = 1000;
+
+// 判断表头时每列检查的数据行数
+constexpr int HeaderCheckRows = 200;
+
+// 候选分隔符，多字符的排在前面，得分相同时优先
+const char* const DelimiterCandidates[] = { "||", "|~|", "::", ";;", ",", "\t", ";", "|", ":", "^" };
+
+/**
+ * @brief 截取样本开头最多SampleLines行，截断的最后一行不参与统计；行可以以LF、CRLF或CR结束
+ */
+QByteArray sampleRows(const QByteArray& sample, bool complete)
+{
+    qint64 begin = 0;
+    int lines = 0;
+    while (begin < sample.size() && lines < SampleLines) {
+        const qint64 end = CsvTokenizer::findLineEnd(sample.constData(), begin, sample.size());
+        if (end >= sample.size())
+            return complete ? sample : sample.left(static_cast<int>(begin));
+        if (end > begin)
+            ++lines;
+        begin = end + 1;
+    }
+    return sample.left(static_cast<int>(begin));
+}
+
+/**
+ * @brief 用加载时的扫描器扫描样本，引号、转义和双字节字符的处理与CsvDataSource一致
+ */
+CsvTokenizer::Result tokenizeSample(const QByteArray& rows, const QByteArray& delimiter, char quote, bool asciiTrailBytes)
+{
+    CsvDialect dialect;
+    dialect.delimiter = delimiter;
+    dialect.quote = quote;
+    CsvTokenizer::Result result;
+    CsvTokenizer::tokenize(rows.constData(), rows.size(), dialect, &result, asciiTrailBytes);
+    return result;
+}
+
+/**
+ * @brief 分隔符的得分：每行字段数的众数，以及字段数等于众数的行所占比例
+ */
+struct DelimiterScore {
+    double consistency = 0.0; // 字段数等于众数的行所占比例
+    int fieldCount = 1; // 字段数的众数
+};
+
+DelimiterScore scoreDelimiter(const QByteArray& rows, const QByteArray& delimiter, char quote, bool asciiTrailBytes)
+{
+    const CsvTokenizer::Result tokens = tokenizeSample(rows, delimiter, quote, asciiTrailBytes);
+    QHash<int, int> frequency;
+    for (int row = 0; row < tokens.rowCount(); ++row)
+        ++frequency[tokens.rowStarts[row + 1] - tokens.rowStarts[row]];
+
+    DelimiterScore score;
+    int best = 0;
+    for (auto it = frequency.constBegin(); it != frequency.constEnd(); ++it) {
+        if (it.value() > best || (it.value() == best && it.key() > score.fieldCount)) {
+            best = it.value();
+            score.fieldCount = it.key();
+        }
+    }
+    if (score.fieldCount > 1 && tokens.rowCount() > 0)
+        score.consistency = static_cast<double>(best) / tokens.rowCount();
+    return score;
+}
+
+/**
+ * @brief 引号字符出现在字段边界（行首、行尾、紧邻分隔符）的次数
+ */
+int boundaryQuotes(const QByteArray& rows, const QByteArray& delimiter, char quote, bool asciiTrailBytes)
+{
+    const CsvTokenizer::Result tokens = tokenizeSample(rows, delimiter, quote, asciiTrailBytes);
+    int count = 0;
+    for (const CsvTokenizer::Field& field : tokens.fields) {
+        if (field.end <= field.begin)
+            continue;
+        if (rows[field.begin] == quote)
+            ++count;
+        if (rows[field.end - 1] == quote)
+            ++count;
+    }
+    return count;
+}
+
+bool isNumber(const QString& text)
+{
+    bool ok = false;
+    text.toDouble(&ok);
+    return ok;
+}
+
+/**
+ * @brief 判断首行是否为表头：某列的数据行全是数字或长度相同，而首行不是时投赞成票，反之投反对票
+ */
+bool detectHeader(const QByteArray& rows, const CsvDialect& dialect, bool asciiTrailBytes)
+{
+    const CsvTokenizer::Result tokens = tokenizeSample(rows, dialect.delimiter, dialect.quote, asciiTrailBytes);
+    if (tokens.rowCount() < 2)
+        return true;
+
+    // 字段文本按UTF-8解码，只用于判断类型和长度
+    auto fieldText = [&](int row, int column) {
+        const int index = tokens.rowStarts[row] + column;
+        return index < tokens.rowStarts[row + 1]
+            ? CsvTokenizer::fieldText(rows.constData(), tokens.fields[index], dialect.quote)
+            : QString();
+    };
+
+    const int headerColumns = tokens.rowStarts[1];
+    const int lastRow = std::min(tokens.rowCount() - 1, HeaderCheckRows);
+    int votes = 0;
+    for (int column = 0; column < headerColumns; ++column) {
+        bool numeric = true;
+        int length = -1;
+        bool sameLength = true;
+        int values = 0;
+        for (int row = 1; row <= lastRow; ++row) {
+            const QString value = fieldText(row, column);
+            if (value.isEmpty())
+                continue;
+            ++values;
+            numeric = numeric && isNumber(value);
+            if (length < 0)
+                length = value.size();
+            sameLength = sameLength && value.size() == length;
+        }
+        if (values == 0)
+            continue;
+
+        const QString header = fieldText(0, column);
+        if (numeric) {
+            votes += isNumber(header) ? -1 : 1;
+        } else if (sameLength) {
+            votes += header.size() == length ? -1 : 1;
+        }
+    }
+    // 没有证据时保持原来的默认值：有表头
+    return votes >= 0;
+}
+
+}
+
+CsvDialect CsvDialect::sniff(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return CsvDialect();
+
+    QByteArray sample = file.read(SampleBytes);
+    const bool complete = file.atEnd();
+
+    // 样本转成与ASCII兼容的形式再统计
+    int bomLength = 0;
+    const QByteArray encoding = CsvEncoding::detect(sample.constData(), sample.size(), &bomLength);
+    if (CsvEncoding::isUtf16(encoding)) {
+        sample = QTextCodec::codecForName(encoding)->toUnicode(sample.constData() + bomLength, sample.size() - bomLength).toUtf8();
+    } else {
+        sample.remove(0, bomLength);
+    }
+    return sniff(sample, complete, CsvEncoding::hasAsciiTrailBytes(encoding));
+}
+
+CsvDialect CsvDialect::sniff(const QByteArray& sample, bool complete, bool asciiTrailBytes)
+{
+    CsvDialect dialect;
+    const QByteArray rows = sampleRows(sample, complete);
+    if (rows.isEmpty())
+        return dialect;
+
+    // 字段数最稳定的分隔符；比例相同时多字符的优先，再比较字段数
+    DelimiterScore best;
+    for (const char* candidate : DelimiterCandidates) {
+        const QByteArray delimiter(candidate);
+        const DelimiterScore score = scoreDelimiter(rows, delimiter, dialect.quote, asciiTrailBytes);
+        if (score.consistency > best.consistency + 1e-9
+            || (score.consistency > 0.0 && score.consistency > best.consistency - 1e-9
+                && (delimiter.size() > dialect.delimiter.size()
+                    || (delimiter.size() == dialect.delimiter.size() && score.fieldCount > best.fieldCount)))) {
+            best = score;
+            dialect.delimiter = delimiter;
+        }
+    }
+
+    if (boundaryQuotes(rows, dialect.delimiter, '\'', asciiTrailBytes)
+        > boundaryQuotes(rows, dialect.delimiter, '"', asciiTrailBytes))
+        dialect.quote = '\'';
+
+    dialect.hasHeader = detectHeader(rows, dialect, asciiTrailBytes);
+    return dialect;
+}
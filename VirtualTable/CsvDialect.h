@@ -0,0 +1,37 @@
+#ifndef CSVDIALECT_H
+#define CSVDIALECT_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief CSV文件格式：分隔符、引号和表头
+ *
+ * sniff()只读取文件开头几MB样本：按每行出现次数最稳定的候选确定分隔符（支持"||"这类多字符分隔符），
+ * 按出现在字段边界的次数确定引号字符，按各列首行与其余行的类型或长度是否一致判断是否有表头。
+ * 样本由加载时使用的CsvTokenizer扫描，LF、CRLF和单独的CR都按行结束处理，行结束符不需要推断。
+ * 即使文件很大也只处理样本中的前一千行，耗时在毫秒级。
+ */
+struct CsvDialect {
+    QByteArray delimiter = ","; // 分隔符，可以是多个字符
+    char quote = '"'; // 引号字符
+    bool hasHeader = true; // 第一行是否为表头
+
+    /**
+     * @brief 从文件开头的样本推断格式
+     * @param filePath 文件路径
+     * @return 推断出的格式，无法读取时返回默认格式
+     */
+    static CsvDialect sniff(const QString& filePath);
+
+    /**
+     * @brief 从样本推断格式
+     * @param sample UTF-8或其他与ASCII兼容编码的样本
+     * @param complete 样本是否为完整文件（否则最后一行可能被截断，不参与统计）
+     * @param asciiTrailBytes 双字节字符的第二个字节是否可能与ASCII字符相同（GB18030）
+     * @return 推断出的格式
+     */
+    static CsvDialect sniff(const QByteArray& sample, bool complete, bool asciiTrailBytes = false);
+};
+
+#endif // CSVDIALECT_H
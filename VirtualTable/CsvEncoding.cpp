@@ -0,0 +1,128 @@
+#include "CsvEncoding.h"
+#include <algorithm>
+
+namespace {
+
+// 统计使用的样本大小
+constexpr qint64 SampleSize = 64 * 1024;
+
+/**
+ * @brief 样本是否为合法UTF-8，末尾被截断的字符不算错误
+ */
+bool isValidUtf8(const unsigned char* data, qint64 size)
+{
+    qint64 i = 0;
+    while (i < size) {
+        const unsigned char c = data[i];
+        int length = 0;
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+        } else {
+            return false;
+        }
+
+        for (int k = 1; k < length; ++k) {
+            if (i + k >= size)
+                return true;
+            if ((data[i + k] & 0xC0) != 0x80)
+                return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+/**
+ * @brief 样本中的多字节序列是否基本符合GB18030规则
+ */
+bool looksLikeGb18030(const unsigned char* data, qint64 size)
+{
+    qint64 valid = 0;
+    qint64 invalid = 0;
+    qint64 i = 0;
+    while (i < size) {
+        const unsigned char c = data[i];
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        if (c == 0x80 || c == 0xFF || i + 1 >= size) {
+            ++invalid;
+            ++i;
+            continue;
+        }
+
+        const unsigned char second = data[i + 1];
+        if (second >= 0x40 && second <= 0xFE && second != 0x7F) {
+            ++valid;
+            i += 2;
+        } else if (second >= 0x30 && second <= 0x39 && i + 3 < size
+            && data[i + 2] >= 0x81 && data[i + 2] <= 0xFE && data[i + 3] >= 0x30 && data[i + 3] <= 0x39) {
+            ++valid;
+            i += 4;
+        } else {
+            ++invalid;
+            ++i;
+        }
+    }
+    // 允许少量错误（样本末尾截断、个别损坏的字符）
+    return valid > 0 && invalid * 20 < valid;
+}
+
+}
+
+QByteArray CsvEncoding::detect(const char* data, qint64 size, int* bomLength)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    *bomLength = 0;
+
+    if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        *bomLength = 3;
+        return "UTF-8";
+    }
+    if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE) {
+        *bomLength = 2;
+        return "UTF-16LE";
+    }
+    if (size >= 2 && bytes[0] == 0xFE && bytes[1] == 0xFF) {
+        *bomLength = 2;
+        return "UTF-16BE";
+    }
+
+    const qint64 sample = std::min(size, SampleSize);
+
+    // 没有BOM的UTF-16：ASCII字符的高字节为零，零字节集中在一侧
+    qint64 evenZeros = 0;
+    qint64 oddZeros = 0;
+    for (qint64 i = 0; i < sample; ++i) {
+        if (bytes[i] == 0)
+            (i % 2 == 0 ? evenZeros : oddZeros)++;
+    }
+    if (oddZeros > sample / 4 && evenZeros * 10 < oddZeros)
+        return "UTF-16LE";
+    if (evenZeros > sample / 4 && oddZeros * 10 < evenZeros)
+        return "UTF-16BE";
+
+    if (isValidUtf8(bytes, sample))
+        return "UTF-8";
+    if (looksLikeGb18030(bytes, sample))
+        return "GB18030";
+    return "ISO-8859-1";
+}
+
+bool CsvEncoding::isUtf16(const QByteArray& encoding)
+{
+    return encoding.startsWith("UTF-16");
+}
+
+bool CsvEncoding::hasAsciiTrailBytes(const QByteArray& encoding)
+{
+    return encoding == "GB18030";
+}
@@ -0,0 +1,40 @@
+#ifndef CSVENCODING_H
+#define CSVENCODING_H
+
+#include <QByteArray>
+
+/**
+ * @brief CSV文件编码检测
+ *
+ * 先看字节顺序标记（BOM），没有时取文件开头一段样本统计：
+ * 零字节集中在奇数或偶数位置时为UTF-16，样本是合法UTF-8时为UTF-8，
+ * 多字节序列几乎都符合GB18030规则时为GB18030，否则按Latin-1处理。
+ * 返回的编码名可直接用于QTextCodec::codecForName()。
+ */
+class CsvEncoding {
+public:
+    /**
+     * @brief 检测编码
+     * @param data 文件内容
+     * @param size 字节数
+     * @param bomLength 输出参数，字节顺序标记的长度，没有时为0
+     * @return 编码名：UTF-8、UTF-16LE、UTF-16BE、GB18030或ISO-8859-1
+     */
+    static QByteArray detect(const char* data, qint64 size, int* bomLength);
+
+    /**
+     * @brief 编码是否为UTF-16（与ASCII不兼容，不能直接按字节扫描）
+     * @param encoding 编码名
+     * @return 是否为UTF-16
+     */
+    static bool isUtf16(const QByteArray& encoding);
+
+    /**
+     * @brief 编码的双字节字符的第二个字节是否可能与ASCII字符相同（如GB18030中的反斜杠0x5C）
+     * @param encoding 编码名
+     * @return 扫描时是否需要排除这种字节
+     */
+    static bool hasAsciiTrailBytes(const QByteArray& encoding);
+};
+
+#endif // CSVENCODING_H
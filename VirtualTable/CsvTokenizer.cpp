@@ -0,0 +1,214 @@
+#include "CsvTokenizer.h"
+#include <QTextCodec>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSV_TOKENIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 扫描状态，按位置顺序处理每个结构字符
+ */
+class Scanner {
+public:
+    Scanner(const char* data, int size, const CsvDialect& dialect, CsvTokenizer::Result* result, bool asciiTrailBytes)
+        : m_data(data)
+        , m_size(size)
+        , m_delimiter(dialect.delimiter)
+        , m_quote(dialect.quote)
+        , m_result(result)
+        , m_asciiTrailBytes(asciiTrailBytes)
+    {
+    }
+
+    /**
+     * @brief 处理位置p上的结构字符（CR、LF、分隔符的第一个字节、引号或反斜杠）
+     */
+    void handle(int p)
+    {
+        const char c = m_data[p];
+        if (c == '\n' || c == '\r') {
+            // 行以LF、CRLF或CR结束，转义和引号都不跨行；CRLF中的LF紧跟在行首，按空行跳过
+            if (p > m_rowBegin) {
+                endField(p);
+                m_result->rowStarts.append(m_result->fields.size());
+            }
+            m_rowBegin = p + 1;
+            m_fieldBegin = p + 1;
+            m_inQuotes = false;
+            m_special = false;
+        } else if (p < m_skipUntil || p < m_fieldBegin) {
+            // 被反斜杠转义的字符，或多字符分隔符中间的字节
+        } else if (m_asciiTrailBytes && static_cast<unsigned char>(c) >= 0x40 && isTrailByte(p)) {
+            // 双字节字符的第二个字节，不是结构字符
+        } else if (c == '\\') {
+            m_special = true;
+            m_skipUntil = p + 2;
+        } else if (c == m_quote) {
+            m_special = true;
+            m_inQuotes = !m_inQuotes;
+        } else if (c == m_delimiter[0] && !m_inQuotes && matchesDelimiter(p)) {
+            endField(p);
+            m_fieldBegin = p + m_delimiter.size();
+        }
+    }
+
+    /**
+     * @brief 结束扫描，最后一行可能没有换行
+     */
+    void finish(int size)
+    {
+        if (size > m_rowBegin) {
+            endField(size);
+            m_result->rowStarts.append(m_result->fields.size());
+        }
+    }
+
+private:
+    /**
+     * @brief 位置p是否为双字节字符的第二个字节：前面紧邻的高位字节数为奇数时是
+     */
+    bool isTrailByte(int p) const
+    {
+        int leadBytes = 0;
+        for (int i = p - 1; i >= m_rowBegin; --i) {
+            const unsigned char b = static_cast<unsigned char>(m_data[i]);
+            if (b < 0x81 || b > 0xFE)
+                break;
+            ++leadBytes;
+        }
+        return leadBytes % 2 == 1;
+    }
+
+    bool matchesDelimiter(int p) const
+    {
+        return m_delimiter.size() == 1
+            || (p + m_delimiter.size() <= m_size
+                && qstrncmp(m_data + p, m_delimiter.constData(), static_cast<uint>(m_delimiter.size())) == 0);
+    }
+
+    void endField(int p)
+    {
+        m_result->fields.append({ m_fieldBegin, p, m_special });
+        m_fieldBegin = p + 1;
+        m_special = false;
+    }
+
+    const char* m_data; // 字节段
+    const int m_size; // 字节数
+    const QByteArray m_delimiter; // 分隔符
+    const char m_quote; // 引号字符
+    CsvTokenizer::Result* m_result; // 扫描结果
+    const bool m_asciiTrailBytes; // 是否需要排除双字节字符的第二个字节
+    int m_rowBegin = 0; // 当前行起始位置
+    int m_fieldBegin = 0; // 当前字段起始位置
+    int m_skipUntil = -1; // 此位置之前的字符已被转义
+    bool m_inQuotes = false; // 是否在引号内
+    bool m_special = false; // 当前字段是否包含引号或反斜杠
+};
+
+inline bool isStructural(char c, char delimiter, char quote)
+{
+    return c == '\n' || c == '\r' || c == delimiter || c == quote || c == '\\';
+}
+
+}
+
+void CsvTokenizer::tokenize(const char* data, int size, const CsvDialect& dialect, Result* result, bool asciiTrailBytes)
+{
+    result->fields.clear();
+    result->rowStarts.clear();
+    result->rowStarts.append(0);
+    if (!data || size <= 0)
+        return;
+
+    if (dialect.delimiter.isEmpty())
+        return;
+
+    Scanner scanner(data, size, dialect, result, asciiTrailBytes);
+    const char delimiter = dialect.delimiter[0];
+    int p = 0;
+
+#ifdef CSV_TOKENIZER_SSE2
+    // 每次比较16个字节，大多数字节不是结构字符，整组跳过
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    const __m128i separator = _mm_set1_epi8(delimiter);
+    const __m128i quote = _mm_set1_epi8(dialect.quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; p + 16 <= size; p += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + p));
+        const __m128i lineEnds = _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, carriage));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(lineEnds, _mm_cmpeq_epi8(bytes, separator)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)));
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(hits));
+        while (mask) {
+            scanner.handle(p + static_cast<int>(qCountTrailingZeroBits(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; p < size; ++p) {
+        if (isStructural(data[p], delimiter, dialect.quote))
+            scanner.handle(p);
+    }
+    scanner.finish(size);
+}
+
+qint64 CsvTokenizer::findLineEnd(const char* data, qint64 from, qint64 size)
+{
+    qint64 p = from;
+#ifdef CSV_TOKENIZER_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    for (; p + 16 <= size; p += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + p));
+        const quint32 mask = static_cast<quint32>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, carriage))));
+        if (mask)
+            return p + qCountTrailingZeroBits(mask);
+    }
+#endif
+    for (; p < size; ++p) {
+        if (data[p] == '\n' || data[p] == '\r')
+            return p;
+    }
+    return size;
+}
+
+QString CsvTokenizer::fieldText(const char* data, const Field& field, char quote, QTextCodec* codec)
+{
+    QString text = codec ? codec->toUnicode(data + field.begin, field.end - field.begin)
+                         : QString::fromUtf8(data + field.begin, field.end - field.begin);
+    if (field.special) {
+        QString plain;
+        plain.reserve(text.size());
+        bool escaped = false;
+        for (const QChar c : text) {
+            if (escaped) {
+                plain.append(c);
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c != quote) {
+                plain.append(c);
+            }
+        }
+        text = plain;
+    }
+    return text.trimmed();
+}
+
+bool CsvTokenizer::hasSimd()
+{
+#ifdef CSV_TOKENIZER_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
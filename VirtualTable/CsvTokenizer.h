@@ -0,0 +1,81 @@
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+
+#include "CsvDialect.h"
+#include <QString>
+#include <QVector>
+
+class QTextCodec;
+
+/**
+ * @brief CSV字段边界扫描器
+ *
+ * 一次扫描一整段连续的字节（多行），只定位换行、分隔符、引号和反斜杠，得到每行每个字段的字节范围。
+ * 行可以以LF、CRLF或单独的CR结束，行结束符不会进入字段。
+ * 编译器支持SSE2时每次比较16个字节，否则逐字节扫描。CsvDataSource的表头和数据行都由它解析：
+ * 反斜杠转义下一个字符，引号内的分隔符不分隔字段，空行跳过。分隔符可以是多个字符，SIMD比较其第一个字节。
+ * 输入必须与ASCII兼容（UTF-8、GB18030、Latin-1），字段文本在生成单元格时才解码。
+ * 扫描只读取输入，可以在多个线程中同时调用。
+ */
+class CsvTokenizer {
+public:
+    /**
+     * @brief 一个字段在字节段中的范围
+     */
+    struct Field {
+        int begin; // 起始位置
+        int end; // 结束位置（不含）
+        bool special; // 是否包含引号或反斜杠，需要去除转义
+    };
+
+    /**
+     * @brief 一段字节的扫描结果
+     */
+    struct Result {
+        QVector<Field> fields; // 所有字段，按行依次排列
+        QVector<int> rowStarts; // 每行第一个字段在fields中的位置，末尾多一项
+
+        /**
+         * @brief 获取扫描出的行数
+         * @return 行数
+         */
+        int rowCount() const { return rowStarts.isEmpty() ? 0 : rowStarts.size() - 1; }
+    };
+
+    /**
+     * @brief 扫描一段字节中的所有行
+     * @param data 字节段
+     * @param size 字节数
+     * @param dialect 文件格式（使用分隔符和引号字符）
+     * @param result 输出参数，扫描结果
+     * @param asciiTrailBytes 双字节字符的第二个字节是否可能与ASCII字符相同（GB18030），是时不把它当作结构字符
+     */
+    static void tokenize(const char* data, int size, const CsvDialect& dialect, Result* result, bool asciiTrailBytes = false);
+
+    /**
+     * @brief 查找下一个行结束符（CR或LF）
+     * @param data 字节
+     * @param from 起始位置
+     * @param size 字节数
+     * @return 行结束符的位置，没有时返回size
+     */
+    static qint64 findLineEnd(const char* data, qint64 from, qint64 size);
+
+    /**
+     * @brief 生成字段文本：解码，去除转义和引号，再去掉首尾空白
+     * @param data 字节段
+     * @param field 字段
+     * @param quote 引号字符
+     * @param codec 解码器，为nullptr时按UTF-8解码
+     * @return 字段文本
+     */
+    static QString fieldText(const char* data, const Field& field, char quote = '"', QTextCodec* codec = nullptr);
+
+    /**
+     * @brief 是否使用SIMD扫描
+     * @return 编译时是否启用了SSE2
+     */
+    static bool hasSimd();
+};
+
+#endif // CSVTOKENIZER_H
@@ -1,9 +1,13 @@
 #ifndef DATASOURCE_H
 #define DATASOURCE_H
 
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileInfo>
 #include <QList>
 #include <QVariant>
 #include <QString>
+#include <QVector>
 
 /**
  * @brief 数据源接口类，用于提供表格数据
@@ -40,6 +44,50 @@ public:
      * @return 表头标题列表
      */
     virtual QList<QString> headerData() const = 0;
+
+    /**
+     * @brief 获取数据源对应的文件路径，用于在旁边保存索引等辅助文件
+     * @return 文件路径，数据源没有对应文件时为空
+     */
+    virtual QString persistentPath() const { return QString(); }
+
+    /**
+     * @brief 读取数据源文件的大小和修改时间，写在索引、统计等辅助文件中，用于判断它们是否过期
+     * @param path persistentPath()返回的文件路径
+     * @param size 输出文件大小
+     * @param modified 输出修改时间（毫秒）
+     * @return 文件是否存在
+     */
+    static bool persistentStamp(const QString& path, qint64* size, qint64* modified)
+    {
+        QFileInfo info(path);
+        if (!info.exists())
+            return false;
+        *size = info.size();
+        *modified = info.lastModified().toMSecsSinceEpoch();
+        return true;
+    }
+
+    /**
+     * @brief 把连续多行直接从原始文本写成分隔文本，每行以换行结束
+     *
+     * 写出的内容须与逐字段读取loadData()的结果、再用delimiter连接完全相同，
+     * 因此只在没有字段需要加引号或转义时才写出；数据源没有原始文本或不能保证这一点时返回false，
+     * 调用方改用loadData()。可以在任意线程中调用
+     * @param startRow 起始行索引
+     * @param count 行数
+     * @param delimiter 输出的分隔符
+     * @param out 输出参数，UTF-8文本；返回false时内容未定义
+     * @return 是否写出
+     */
+    virtual bool writeRawRows(int startRow, int count, char delimiter, QByteArray* out) const
+    {
+        Q_UNUSED(startRow);
+        Q_UNUSED(count);
+        Q_UNUSED(delimiter);
+        Q_UNUSED(out);
+        return false;
+    }
 };
 
 #endif // DATASOURCE_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "FrameStats.h"
+#include <QPainter>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+Q_LOGGING_CATEGORY(lcFrameStats, "virtualtable.frames", QtInfoMsg)
+
+namespace {
+
+// 直方图区间上界（毫秒），最后一个区间没有上界
+const double BucketLimitsMs[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3 };
+constexpr int BucketCount = sizeof(BucketLimitsMs) / sizeof(BucketLimitsMs[0]) + 1;
+
+// 距离上次滚动超过这个时间的帧间隔不计入掉帧（空闲时本来就不需要重绘）
+constexpr qint64 ScrollActiveNs = 100 * 1000 * 1000;
+
+}
+
+FrameStats::FrameStats()
+    : m_framePeriodNs(1e9 / 60.0)
+{
+    m_clock.start();
+    reset();
+}
+
+void FrameStats::reset()
+{
+    m_frameStartNs = 0;
+    m_lastFrameStartNs = -1;
+    m_lastScrollNs = -1;
+    m_pendingScrollNs = -1;
+    m_pendingFirstRow = -1;
+    m_pendingLastRow = -1;
+    m_frameCount = 0;
+    m_droppedFrames = 0;
+    m_lastPaintNs = 0;
+    m_lastCounters = FrameCounters();
+    m_lastLatencyNs = -1;
+    m_latencySamples = 0;
+    m_latencyTotalNs = 0;
+    m_maxLatencyNs = 0;
+    m_histogram = QVector<qint64>(BucketCount, 0);
+}
+
+void FrameStats::setRefreshRate(double hz)
+{
+    if (hz > 0.0) {
+        m_framePeriodNs = 1e9 / hz;
+    }
+}
+
+void FrameStats::markScrolled()
+{
+    m_lastScrollNs = m_clock.nsecsElapsed();
+}
+
+void FrameStats::beginFrame()
+{
+    m_frameStartNs = m_clock.nsecsElapsed();
+}
+
+void FrameStats::endFrame(const FrameCounters& counters, int firstRow, int lastRow)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 paintNs = now - m_frameStartNs;
+
+    // 滚动过程中帧间隔超过一个刷新周期，多出来的周期都算掉帧
+    qint64 dropped = 0;
+    if (m_lastFrameStartNs >= 0 && m_lastScrollNs >= 0 && m_frameStartNs - m_lastScrollNs < ScrollActiveNs) {
+        qint64 interval = m_frameStartNs - m_lastFrameStartNs;
+        if (interval < ScrollActiveNs) {
+            dropped = std::max<qint64>(0, std::llround(interval / m_framePeriodNs) - 1);
+        }
+    }
+    m_lastFrameStartNs = m_frameStartNs;
+
+    // 滚动后出现占位符，开始等待数据
+    if (counters.placeholders > 0 && m_pendingScrollNs < 0 && m_lastScrollNs >= 0) {
+        m_pendingScrollNs = m_lastScrollNs;
+    }
+    if (m_pendingScrollNs >= 0) {
+        m_pendingFirstRow = firstRow;
+        m_pendingLastRow = lastRow;
+    }
+
+    ++m_frameCount;
+    m_droppedFrames += dropped;
+    m_lastPaintNs = paintNs;
+    m_lastCounters = counters;
+    ++m_histogram[bucketIndex(paintNs)];
+
+    qCDebug(lcFrameStats, "frame=%lld paint_us=%lld data_calls=%lld data_us=%lld placeholders=%lld dropped=%lld rows=%d-%d",
+        m_frameCount, paintNs / 1000, counters.dataCalls, counters.dataNs / 1000,
+        counters.placeholders, dropped, firstRow, lastRow);
+}
+
+void FrameStats::blockArrived(int startRow, int endRow)
+{
+    if (m_pendingScrollNs < 0 || endRow < m_pendingFirstRow || startRow > m_pendingLastRow)
+        return;
+
+    qint64 latency = m_clock.nsecsElapsed() - m_pendingScrollNs;
+    m_pendingScrollNs = -1;
+
+    m_lastLatencyNs = latency;
+    ++m_latencySamples;
+    m_latencyTotalNs += latency;
+    m_maxLatencyNs = std::max(m_maxLatencyNs, latency);
+
+    qCDebug(lcFrameStats, "scroll_to_data_us=%lld rows=%d-%d", latency / 1000, startRow, endRow);
+}
+
+QString FrameStats::overlayText() const
+{
+    QString latency = m_lastLatencyNs < 0
+        ? QStringLiteral("-")
+        : QString("%1 ms (平均 %2, 最大 %3)")
+              .arg(m_lastLatencyNs / 1e6, 0, 'f', 1)
+              .arg(m_latencyTotalNs / 1e6 / std::max<qint64>(1, m_latencySamples), 0, 'f', 1)
+              .arg(m_maxLatencyNs / 1e6, 0, 'f', 1);
+
+    return QString("绘制: %1 ms\ndata(): %2 次, %3 ms\n占位符: %4\n掉帧: %5 / %6\n滚动到数据: %7")
+        .arg(m_lastPaintNs / 1e6, 0, 'f', 2)
+        .arg(m_lastCounters.dataCalls)
+        .arg(m_lastCounters.dataNs / 1e6, 0, 'f', 2)
+        .arg(m_lastCounters.placeholders)
+        .arg(m_droppedFrames)
+        .arg(m_frameCount)
+        .arg(latency);
+}
+
+void FrameStats::paintOverlay(QPainter* painter, const QRect& area) const
+{
+    const QString text = overlayText();
+    QRect textRect = painter->fontMetrics().boundingRect(QRect(0, 0, 1000, 1000), Qt::AlignLeft, text);
+    QRect box = textRect.adjusted(-6, -4, 6, 4);
+    box.moveTopRight(QPoint(area.right() - 8, area.top() + 8));
+
+    painter->save();
+    painter->fillRect(box, QColor(0, 0, 0, 170));
+    painter->setPen(Qt::white);
+    painter->drawText(box.adjusted(6, 4, -6, -4), Qt::AlignLeft, text);
+    painter->restore();
+}
+
+QString FrameStats::histogramReport() const
+{
+    QString report = QString("frames=%1 dropped=%2 latency_samples=%3\n")
+                         .arg(m_frameCount)
+                         .arg(m_droppedFrames)
+                         .arg(m_latencySamples);
+
+    double lower = 0.0;
+    for (int i = 0; i < BucketCount; ++i) {
+        QString range = i < BucketCount - 1
+            ? QString("%1-%2ms").arg(lower).arg(BucketLimitsMs[i])
+            : QString(">=%1ms").arg(lower);
+        double percent = m_frameCount > 0 ? 100.0 * m_histogram[i] / m_frameCount : 0.0;
+        report += QString("paint %1: %2 (%3%)\n").arg(range, -12).arg(m_histogram[i]).arg(percent, 0, 'f', 1);
+        if (i < BucketCount - 1)
+            lower = BucketLimitsMs[i];
+    }
+    return report;
+}
+
+void FrameStats::dumpHistogram() const
+{
+    const QStringList lines = histogramReport().split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        qCInfo(lcFrameStats).noquote() << line;
+    }
+}
+
+int FrameStats::bucketIndex(qint64 paintNs)
+{
+    double ms = paintNs / 1e6;
+    for (int i = 0; i < BucketCount - 1; ++i) {
+        if (ms < BucketLimitsMs[i])
+            return i;
+    }
+    return BucketCount - 1;
+}
@@ -0,0 +1,125 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+class QPainter;
+class QRect;
+
+Q_DECLARE_LOGGING_CATEGORY(lcFrameStats)
+
+/**
+ * @brief 模型在一帧内的data()调用统计
+ */
+struct FrameCounters {
+    qint64 dataCalls = 0; // data()调用次数
+    qint64 dataNs = 0; // data()累计耗时（纳秒）
+    qint64 placeholders = 0; // 返回占位符的单元格数
+};
+
+/**
+ * @brief 逐帧性能统计
+ *
+ * 记录每帧的绘制耗时、data()调用次数和耗时、占位符单元格数、掉帧数，
+ * 以及滚动到数据到达的延迟：某次滚动后出现了占位符，从这次滚动事件到
+ * 覆盖可见区域的数据块加载完成所经过的时间。
+ * 每帧一行结构化日志输出到virtualtable.frames分类（debug级别，默认关闭），
+ * 绘制耗时直方图可以随时输出，用于对比回归。
+ */
+class FrameStats {
+public:
+    FrameStats();
+
+    /**
+     * @brief 清空所有统计
+     */
+    void reset();
+
+    /**
+     * @brief 设置屏幕刷新率，用于判断掉帧
+     * @param hz 刷新率
+     */
+    void setRefreshRate(double hz);
+
+    /**
+     * @brief 记录一次滚动事件
+     */
+    void markScrolled();
+
+    /**
+     * @brief 一帧绘制开始
+     */
+    void beginFrame();
+
+    /**
+     * @brief 一帧绘制结束
+     * @param counters 本帧模型的data()统计
+     * @param firstRow 本帧可见的首行
+     * @param lastRow 本帧可见的末行
+     */
+    void endFrame(const FrameCounters& counters, int firstRow, int lastRow);
+
+    /**
+     * @brief 数据块加载完成
+     * @param startRow 块起始行
+     * @param endRow 块结束行
+     */
+    void blockArrived(int startRow, int endRow);
+
+    /**
+     * @brief 生成叠加层显示的文本
+     * @return 多行文本
+     */
+    QString overlayText() const;
+
+    /**
+     * @brief 在视口右上角绘制叠加层
+     * @param painter 视口的绘制器
+     * @param area 视口矩形
+     */
+    void paintOverlay(QPainter* painter, const QRect& area) const;
+
+    /**
+     * @brief 生成绘制耗时直方图报告
+     * @return 多行文本，每行一个区间
+     */
+    QString histogramReport() const;
+
+    /**
+     * @brief 把直方图报告输出到virtualtable.frames分类（info级别）
+     */
+    void dumpHistogram() const;
+
+private:
+    /**
+     * @brief 绘制耗时所在的直方图区间
+     * @param paintNs 绘制耗时（纳秒）
+     * @return 区间索引
+     */
+    static int bucketIndex(qint64 paintNs);
+
+    QElapsedTimer m_clock; // 统计时钟
+    double m_framePeriodNs; // 一帧的理论间隔（纳秒）
+    qint64 m_frameStartNs; // 当前帧开始时间
+    qint64 m_lastFrameStartNs; // 上一帧开始时间
+    qint64 m_lastScrollNs; // 最近一次滚动事件的时间，-1表示没有
+    qint64 m_pendingScrollNs; // 等待数据的滚动事件时间，-1表示没有
+    int m_pendingFirstRow; // 等待数据时的可见首行
+    int m_pendingLastRow; // 等待数据时的可见末行
+
+    qint64 m_frameCount; // 总帧数
+    qint64 m_droppedFrames; // 总掉帧数
+    qint64 m_lastPaintNs; // 最近一帧的绘制耗时
+    FrameCounters m_lastCounters; // 最近一帧的data()统计
+    qint64 m_lastLatencyNs; // 最近一次滚动到数据到达的延迟，-1表示没有
+    qint64 m_latencySamples; // 延迟样本数
+    qint64 m_latencyTotalNs; // 延迟累计
+    qint64 m_maxLatencyNs; // 最大延迟
+    QVector<qint64> m_histogram; // 绘制耗时直方图
+};
+
+#endif // FRAMESTATS_H
@@ -0,0 +1,539 @@
+#include "GroupByAggregator.h"
+#include "RowSubsetDataSource.h"
+#include <QDataStream>
+#include <QQueue>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// 溢出时的分区数，每个分区读回时只有约1/64的分组在内存中
+constexpr int SpillPartitionCount = 64;
+
+/**
+ * @brief 计算分组键的排序顺序
+ * @param keys 分组键
+ * @param numericKeys 键是否全部是数字，是时按数值排序
+ * @return 排序后的下标
+ */
+QVector<int> sortOrder(const QVector<QString>& keys, bool numericKeys)
+{
+    QVector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (numericKeys) {
+        QVector<double> keyValues(keys.size());
+        for (int i = 0; i < keys.size(); ++i)
+            keyValues[i] = keys[i].toDouble();
+        std::sort(order.begin(), order.end(), [&keyValues](int a, int b) { return keyValues[a] < keyValues[b]; });
+    } else {
+        std::sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] < keys[b]; });
+    }
+    return order;
+}
+
+/**
+ * @brief 把要处理的行切块后交给线程池处理，按块顺序消费结果
+ *
+ * 同时进行的任务数限制在线程数的两倍以内，消费慢时不会积压大量局部结果
+ * @param pool 线程池
+ * @param rows 要处理的行区间
+ * @param chunkSize 每块行数
+ * @param cancelled 取消标志
+ * @param task 工作线程中执行的任务，参数为起始行和行数
+ * @param consume 在协调线程中按块顺序处理任务结果，参数为结果和该块行数，返回false时停止
+ * @return 是否处理完全部块
+ */
+template <typename T, typename Task, typename Consume>
+bool runChunks(QThreadPool* pool, const RowRangeSet& rows, int chunkSize, const std::atomic<bool>& cancelled,
+    Task task, Consume consume)
+{
+    // 区间按块大小切分，块不跨区间
+    QVector<QPair<int, int>> chunks;
+    for (const RowRangeSet::Range& range : rows.ranges()) {
+        for (qint64 start = range.first; start <= range.last; start += chunkSize) {
+            chunks.append(qMakePair(static_cast<int>(start),
+                static_cast<int>(std::min<qint64>(chunkSize, range.last - start + 1))));
+        }
+    }
+
+    const int window = std::max(2, pool->maxThreadCount() * 2);
+    QQueue<QPair<QFuture<T>, int>> pending;
+    int next = 0;
+
+    auto submit = [&]() {
+        const int startRow = chunks[next].first;
+        const int count = chunks[next].second;
+        pending.enqueue(qMakePair(QtConcurrent::run(pool, [task, startRow, count]() {
+            return task(startRow, count);
+        }),
+            count));
+        ++next;
+    };
+
+    bool ok = true;
+    while (next < chunks.size() && pending.size() < window)
+        submit();
+
+    while (!pending.isEmpty()) {
+        QPair<QFuture<T>, int> front = pending.dequeue();
+        T result = front.first.result();
+        if (ok && !cancelled) {
+            if (next < chunks.size())
+                submit();
+            ok = consume(result, front.second);
+        }
+    }
+    return ok && !cancelled;
+}
+
+}
+
+GroupByAggregator::GroupByAggregator(QObject* parent)
+    : QObject(parent)
+    , m_cancelled(false)
+    , m_chunkSize(50000)
+    , m_maxGroupsInMemory(1000000)
+{
+    m_pool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &GroupByAggregator::onFinished);
+}
+
+GroupByAggregator::~GroupByAggregator()
+{
+    // 后台任务持有数据源并使用线程池，退出前必须等它结束
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void GroupByAggregator::setChunkSize(int rowCount)
+{
+    if (rowCount > 0 && !isRunning()) {
+        m_chunkSize = rowCount;
+    }
+}
+
+void GroupByAggregator::setMaxGroupsInMemory(int groupCount)
+{
+    if (groupCount > 0 && !isRunning()) {
+        m_maxGroupsInMemory = groupCount;
+    }
+}
+
+bool GroupByAggregator::aggregate(std::shared_ptr<DataSource> source, int keyColumn, const QVector<int>& valueColumns)
+{
+    if (!source || keyColumn < 0 || keyColumn >= source->columnCount())
+        return false;
+
+    return start([this, source, keyColumn, valueColumns]() {
+        return runAggregate(source, keyColumn, valueColumns);
+    });
+}
+
+bool GroupByAggregator::expandGroup(std::shared_ptr<AggregateDataSource> groups, int groupRow,
+    std::shared_ptr<const ZoneMap> zoneMap)
+{
+    if (!groups || !groups->sourceDataSource() || groupRow < 0 || groupRow >= groups->rowCount())
+        return false;
+
+    // 统计与原始数据源不一致时不能用来跳过数据
+    std::shared_ptr<DataSource> source = groups->sourceDataSource();
+    if (zoneMap && (zoneMap->rowCount() != source->rowCount() || zoneMap->columnCount() != source->columnCount()))
+        zoneMap.reset();
+
+    return start([this, groups, groupRow, zoneMap]() {
+        return runExpand(groups, groupRow, zoneMap);
+    });
+}
+
+void GroupByAggregator::cancel()
+{
+    m_cancelled = true;
+}
+
+bool GroupByAggregator::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+std::shared_ptr<DataSource> GroupByAggregator::result() const
+{
+    return m_result;
+}
+
+bool GroupByAggregator::start(std::function<Result()> task)
+{
+    if (isRunning())
+        return false;
+
+    m_cancelled = false;
+    m_watcher.setFuture(QtConcurrent::run(task));
+    return true;
+}
+
+GroupByAggregator::Result GroupByAggregator::runAggregate(std::shared_ptr<DataSource> source, int keyColumn,
+    QVector<int> valueColumns)
+{
+    Result result;
+    const int rowCount = source->rowCount();
+    const int valueCount = valueColumns.size();
+
+    GroupTable groups;
+    std::vector<std::unique_ptr<QTemporaryFile>> partitions;
+    bool spilledNumericKeys = true; // 写出的键是否全部是数字，归并排序时使用
+
+    // 把全局表按键的哈希值分区追加到临时文件，同一个键可能被写出多次，读回时再合并
+    auto spill = [&]() {
+        if (partitions.empty()) {
+            for (int i = 0; i < SpillPartitionCount; ++i) {
+                auto file = std::make_unique<QTemporaryFile>();
+                if (!file->open()) {
+                    result.errorString = file->errorString();
+                    return false;
+                }
+                partitions.push_back(std::move(file));
+            }
+        }
+
+        std::vector<std::unique_ptr<QDataStream>> streams;
+        for (auto& file : partitions)
+            streams.push_back(std::make_unique<QDataStream>(file.get()));
+
+        for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+            if (spilledNumericKeys)
+                it.key().toDouble(&spilledNumericKeys);
+            writeGroup(*streams[qHash(it.key()) % SpillPartitionCount], it.key(), it.value());
+        }
+        groups.clear();
+
+        for (auto& stream : streams) {
+            if (stream->status() != QDataStream::Ok) {
+                result.errorString = QStringLiteral("写入临时文件失败");
+                return false;
+            }
+        }
+        return true;
+    };
+
+    RowRangeSet allRows;
+    if (rowCount > 0)
+        allRows.addRange(0, rowCount - 1);
+
+    qint64 rowsProcessed = 0;
+    bool ok = runChunks<GroupTable>(&m_pool, allRows, m_chunkSize, m_cancelled,
+        [this, source, keyColumn, valueColumns](int startRow, int count) {
+            if (m_cancelled)
+                return GroupTable();
+            return aggregateRows(source->loadData(startRow, count), keyColumn, valueColumns);
+        },
+        [&](const GroupTable& partial, int count) {
+            for (auto it = partial.constBegin(); it != partial.constEnd(); ++it)
+                mergeGroup(groups, it.key(), it.value());
+
+            if (groups.size() > m_maxGroupsInMemory && !spill())
+                return false;
+
+            rowsProcessed += count;
+            emit progressChanged(rowsProcessed, rowCount);
+            return true;
+        });
+
+    if (!ok) {
+        if (result.errorString.isEmpty())
+            result.errorString = QStringLiteral("已取消");
+        return result;
+    }
+
+    if (!partitions.empty()) {
+        // 剩余的分组也写出，然后合并各分区，结果留在文件中
+        if (!spill())
+            return result;
+        result.source = mergePartitions(partitions, spilledNumericKeys, source, keyColumn, valueColumns,
+            &result.errorString);
+        result.success = result.source != nullptr;
+        return result;
+    }
+
+    // 没有溢出时分组数不超过内存上限，直接在内存中排序
+    QVector<QString> keys;
+    QVector<qint64> counts;
+    QVector<double> sums;
+    QVector<qint64> numericCounts;
+    keys.reserve(groups.size());
+    counts.reserve(groups.size());
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        keys.append(it.key());
+        counts.append(it.value().count);
+        sums += it.value().sums;
+        numericCounts += it.value().numericCounts;
+    }
+    groups.clear();
+
+    // 按分组键排序，键全部是数字时按数值排序
+    bool numericKeys = true;
+    for (int i = 0; i < keys.size() && numericKeys; ++i)
+        keys[i].toDouble(&numericKeys);
+    const QVector<int> order = sortOrder(keys, numericKeys);
+
+    QVector<QString> sortedKeys(keys.size());
+    QVector<qint64> sortedCounts(keys.size());
+    QVector<double> sortedSums(sums.size());
+    QVector<qint64> sortedNumericCounts(numericCounts.size());
+    for (int i = 0; i < order.size(); ++i) {
+        const int from = order[i];
+        sortedKeys[i] = keys[from];
+        sortedCounts[i] = counts[from];
+        for (int v = 0; v < valueCount; ++v) {
+            sortedSums[i * valueCount + v] = sums[from * valueCount + v];
+            sortedNumericCounts[i * valueCount + v] = numericCounts[from * valueCount + v];
+        }
+    }
+
+    result.source = std::make_shared<AggregateDataSource>(source, keyColumn, valueColumns,
+        std::move(sortedKeys), std::move(sortedCounts), std::move(sortedSums), std::move(sortedNumericCounts));
+    result.success = true;
+    return result;
+}
+
+std::shared_ptr<AggregateDataSource> GroupByAggregator::mergePartitions(
+    std::vector<std::unique_ptr<QTemporaryFile>>& partitions, bool numericKeys, std::shared_ptr<DataSource> source,
+    int keyColumn, const QVector<int>& valueColumns, QString* errorString)
+{
+    // 第一遍：逐个分区读回合并，排序后写成有序段，同一时间只有一个分区的分组在内存中
+    std::vector<std::unique_ptr<QTemporaryFile>> runs;
+    qint64 groupCount = 0;
+    for (auto& file : partitions) {
+        if (m_cancelled) {
+            *errorString = QStringLiteral("已取消");
+            return nullptr;
+        }
+        file->seek(0);
+        QDataStream in(file.get());
+        GroupTable partition;
+        while (!in.atEnd()) {
+            QString key;
+            GroupState state;
+            if (!readGroup(in, &key, &state)) {
+                *errorString = QStringLiteral("读取临时文件失败");
+                return nullptr;
+            }
+            mergeGroup(partition, key, state);
+        }
+        file.reset();
+
+        auto run = std::make_unique<QTemporaryFile>();
+        if (!run->open()) {
+            *errorString = run->errorString();
+            return nullptr;
+        }
+        const QVector<QString> keys = partition.keys().toVector();
+        QDataStream out(run.get());
+        for (int index : sortOrder(keys, numericKeys))
+            writeGroup(out, keys[index], partition.value(keys[index]));
+        if (out.status() != QDataStream::Ok || !run->seek(0)) {
+            *errorString = QStringLiteral("写入临时文件失败");
+            return nullptr;
+        }
+        groupCount += keys.size();
+        runs.push_back(std::move(run));
+    }
+    partitions.clear();
+
+    // 表格行号是int，超过时无法显示
+    if (groupCount > std::numeric_limits<int>::max()) {
+        *errorString = QStringLiteral("分组数超过表格能显示的行数");
+        return nullptr;
+    }
+
+    // 第二遍：多路归并各有序段，写出结果文件，每RowsPerOffset个分组记录一次偏移
+    struct Head {
+        QString key; // 分组键
+        GroupState state; // 分组状态
+        double value = 0.0; // 数值键的值
+        bool valid = false; // 有序段是否还有分组
+    };
+    std::vector<std::unique_ptr<QDataStream>> streams;
+    std::vector<Head> heads(runs.size());
+    auto advance = [&](size_t i) {
+        Head& head = heads[i];
+        head.valid = false;
+        if (streams[i]->atEnd())
+            return true;
+        if (!readGroup(*streams[i], &head.key, &head.state))
+            return false;
+        head.value = numericKeys ? head.key.toDouble() : 0.0;
+        head.valid = true;
+        return true;
+    };
+    for (size_t i = 0; i < runs.size(); ++i) {
+        streams.push_back(std::make_unique<QDataStream>(runs[i].get()));
+        if (!advance(i)) {
+            *errorString = QStringLiteral("读取临时文件失败");
+            return nullptr;
+        }
+    }
+
+    auto output = std::make_unique<QTemporaryFile>();
+    if (!output->open()) {
+        *errorString = output->errorString();
+        return nullptr;
+    }
+    QDataStream out(output.get());
+    QVector<qint64> rowOffsets;
+    rowOffsets.reserve(static_cast<int>(groupCount / AggregateDataSource::RowsPerOffset + 1));
+    for (qint64 row = 0; row < groupCount; ++row) {
+        if (row % AggregateDataSource::RowsPerOffset == 0) {
+            if (m_cancelled) {
+                *errorString = QStringLiteral("已取消");
+                return nullptr;
+            }
+            rowOffsets.append(output->pos());
+        }
+
+        // 分区按键的哈希值划分，同一个键只会出现在一个有序段中
+        int best = -1;
+        for (int i = 0; i < static_cast<int>(heads.size()); ++i) {
+            if (!heads[i].valid)
+                continue;
+            if (best < 0 || (numericKeys ? heads[i].value < heads[best].value : heads[i].key < heads[best].key))
+                best = i;
+        }
+        if (best < 0)
+            break;
+        writeGroup(out, heads[best].key, heads[best].state);
+        if (!advance(best)) {
+            *errorString = QStringLiteral("读取临时文件失败");
+            return nullptr;
+        }
+    }
+    if (out.status() != QDataStream::Ok || !output->flush()) {
+        *errorString = QStringLiteral("写入临时文件失败");
+        return nullptr;
+    }
+
+    return std::make_shared<AggregateDataSource>(source, keyColumn, valueColumns,
+        std::unique_ptr<QFile>(output.release()), static_cast<int>(groupCount), std::move(rowOffsets));
+}
+
+GroupByAggregator::Result GroupByAggregator::runExpand(std::shared_ptr<AggregateDataSource> groups, int groupRow,
+    std::shared_ptr<const ZoneMap> zoneMap)
+{
+    Result result;
+    std::shared_ptr<DataSource> source = groups->sourceDataSource();
+    const int rowCount = source->rowCount();
+    const int keyColumn = groups->keyColumn();
+    const QString key = groups->groupKey(groupRow);
+
+    // 各块的匹配行号按块顺序拼接，结果自然有序
+    QVector<int> rowIds;
+    rowIds.reserve(static_cast<int>(std::min<qint64>(groups->groupRowCount(groupRow), rowCount)));
+
+    // 有区间统计时只扫描可能包含该键的段
+    RowRangeSet candidates;
+    if (zoneMap) {
+        candidates = zoneMap->candidateRows(keyColumn, key, ColumnIndex::Match::Equal);
+    } else if (rowCount > 0) {
+        candidates.addRange(0, rowCount - 1);
+    }
+    const qint64 totalRows = candidates.rowCount();
+
+    qint64 rowsProcessed = 0;
+    bool ok = runChunks<QVector<int>>(&m_pool, candidates, m_chunkSize, m_cancelled,
+        [this, source, keyColumn, key](int startRow, int count) {
+            QVector<int> matches;
+            if (m_cancelled)
+                return matches;
+            const QList<QList<QVariant>> rows = source->loadData(startRow, count);
+            for (int i = 0; i < rows.size(); ++i) {
+                const QList<QVariant>& rowData = rows[i];
+                const QString value = keyColumn < rowData.size() ? rowData[keyColumn].toString() : QString();
+                if (value == key)
+                    matches.append(startRow + i);
+            }
+            return matches;
+        },
+        [&](const QVector<int>& matches, int count) {
+            rowIds += matches;
+            rowsProcessed += count;
+            emit progressChanged(rowsProcessed, totalRows);
+            return true;
+        });
+
+    if (!ok) {
+        result.errorString = QStringLiteral("已取消");
+        return result;
+    }
+
+    result.source = std::make_shared<RowSubsetDataSource>(source, std::move(rowIds));
+    result.success = true;
+    return result;
+}
+
+void GroupByAggregator::onFinished()
+{
+    Result result = m_watcher.result();
+    if (result.success) {
+        m_result = result.source;
+    }
+    emit finished(result.success, result.errorString);
+}
+
+GroupByAggregator::GroupTable GroupByAggregator::aggregateRows(const QList<QList<QVariant>>& rows, int keyColumn,
+    const QVector<int>& valueColumns)
+{
+    GroupTable table;
+    const int valueCount = valueColumns.size();
+
+    for (const QList<QVariant>& rowData : rows) {
+        const QString key = keyColumn < rowData.size() ? rowData[keyColumn].toString() : QString();
+        GroupState& state = table[key];
+        if (state.count == 0 && valueCount > 0) {
+            state.sums.fill(0.0, valueCount);
+            state.numericCounts.fill(0, valueCount);
+        }
+        ++state.count;
+
+        for (int i = 0; i < valueCount; ++i) {
+            const int column = valueColumns[i];
+            if (column >= rowData.size())
+                continue;
+            bool ok = false;
+            const double value = rowData[column].toDouble(&ok);
+            if (ok) {
+                state.sums[i] += value;
+                ++state.numericCounts[i];
+            }
+        }
+    }
+    return table;
+}
+
+void GroupByAggregator::mergeGroup(GroupTable& table, const QString& key, const GroupState& state)
+{
+    auto it = table.find(key);
+    if (it == table.end()) {
+        table.insert(key, state);
+        return;
+    }
+
+    GroupState& target = it.value();
+    target.count += state.count;
+    for (int i = 0; i < target.sums.size() && i < state.sums.size(); ++i) {
+        target.sums[i] += state.sums[i];
+        target.numericCounts[i] += state.numericCounts[i];
+    }
+}
+
+void GroupByAggregator::writeGroup(QDataStream& stream, const QString& key, const GroupState& state)
+{
+    stream << key << state.count << state.sums << state.numericCounts;
+}
+
+bool GroupByAggregator::readGroup(QDataStream& stream, QString* key, GroupState* state)
+{
+    stream >> *key >> state->count >> state->sums >> state->numericCounts;
+    return stream.status() == QDataStream::Ok;
+}
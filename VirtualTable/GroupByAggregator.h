@@ -0,0 +1,204 @@
+#ifndef GROUPBYAGGREGATOR_H
+#define GROUPBYAGGREGATOR_H
+
+#include "AggregateDataSource.h"
+#include "DataSource.h"
+#include "ZoneMap.h"
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QDataStream;
+class QTemporaryFile;
+
+/**
+ * @brief 分组汇总引擎，按一列分组统计行数、合计和平均值
+ *
+ * 数据源按块切分后由线程池并行读取，每个线程先在自己的哈希表中做局部汇总，
+ * 再由协调线程按块顺序合并到全局哈希表，线程之间不共享可写状态。
+ * 分组数超过内存上限时，全局表按键的哈希值分区写入临时文件，
+ * 全部数据处理完后逐个分区读回合并并排序，同一时间只有一个分区的分组在内存中；
+ * 各分区的有序结果再多路归并成一个结果文件，结果数据源从文件中读取分组，不再整体载入内存。
+ * 结果以AggregateDataSource的形式返回，可以直接设置给VirtualTableModel；
+ * 展开分组时再并行扫描一次原始数据源，得到成员行号列表（RowSubsetDataSource）。
+ */
+class GroupByAggregator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit GroupByAggregator(QObject* parent = nullptr);
+    ~GroupByAggregator() override;
+
+    /**
+     * @brief 设置每个任务读取的行数
+     * @param rowCount 行数
+     */
+    void setChunkSize(int rowCount);
+
+    /**
+     * @brief 设置内存中最多保留的分组数，超过后写入临时文件
+     * @param groupCount 分组数
+     */
+    void setMaxGroupsInMemory(int groupCount);
+
+    /**
+     * @brief 在后台按一列分组汇总
+     * @param source 数据源
+     * @param keyColumn 分组列
+     * @param valueColumns 需要合计和平均的列，非数值单元格不参与计算
+     * @return 是否成功启动（已有任务在进行时返回false）
+     */
+    bool aggregate(std::shared_ptr<DataSource> source, int keyColumn, const QVector<int>& valueColumns);
+
+    /**
+     * @brief 在后台查找一个分组的全部成员行
+     * @param groups 分组汇总结果
+     * @param groupRow 分组所在行
+     * @param zoneMap 原始数据源的区间统计，提供时只扫描可能包含该分组键的段
+     * @return 是否成功启动（已有任务在进行时返回false）
+     */
+    bool expandGroup(std::shared_ptr<AggregateDataSource> groups, int groupRow,
+        std::shared_ptr<const ZoneMap> zoneMap = nullptr);
+
+    /**
+     * @brief 取消正在进行的任务
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有任务正在进行
+     * @return 是否正在运行
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief 获取最近一次成功任务的结果
+     * @return 汇总时为AggregateDataSource，展开分组时为RowSubsetDataSource
+     */
+    std::shared_ptr<DataSource> result() const;
+
+signals:
+    /**
+     * @brief 进度信号，每处理完一块发出一次（来自后台线程）
+     * @param rowsProcessed 已处理的行数
+     * @param totalRows 总行数
+     */
+    void progressChanged(qint64 rowsProcessed, qint64 totalRows);
+
+    /**
+     * @brief 任务结束信号
+     * @param success 是否成功
+     * @param errorString 失败或取消时的原因
+     */
+    void finished(bool success, const QString& errorString);
+
+private:
+    /**
+     * @brief 一个分组的累计状态
+     */
+    struct GroupState {
+        qint64 count = 0; // 行数
+        QVector<double> sums; // 各汇总列的合计
+        QVector<qint64> numericCounts; // 各汇总列参与合计的数值个数
+    };
+
+    using GroupTable = QHash<QString, GroupState>;
+
+    /**
+     * @brief 后台任务结果
+     */
+    struct Result {
+        bool success = false; // 是否成功
+        QString errorString; // 错误信息
+        std::shared_ptr<DataSource> source; // 结果数据源
+    };
+
+    /**
+     * @brief 启动后台任务
+     * @param task 在后台线程中执行的任务
+     * @return 是否成功启动
+     */
+    bool start(std::function<Result()> task);
+
+    /**
+     * @brief 在后台线程中执行分组汇总
+     */
+    Result runAggregate(std::shared_ptr<DataSource> source, int keyColumn, QVector<int> valueColumns);
+
+    /**
+     * @brief 在后台线程中查找分组成员行
+     */
+    Result runExpand(std::shared_ptr<AggregateDataSource> groups, int groupRow, std::shared_ptr<const ZoneMap> zoneMap);
+
+    /**
+     * @brief 在后台线程中合并溢出的分区，生成基于结果文件的汇总数据源
+     * @param partitions 溢出分区，合并后释放
+     * @param numericKeys 分组键是否全部是数字
+     * @param source 原始数据源
+     * @param keyColumn 分组列
+     * @param valueColumns 汇总列
+     * @param errorString 失败时输出原因
+     * @return 汇总数据源，失败或取消时为空
+     */
+    std::shared_ptr<AggregateDataSource> mergePartitions(std::vector<std::unique_ptr<QTemporaryFile>>& partitions,
+        bool numericKeys, std::shared_ptr<DataSource> source, int keyColumn, const QVector<int>& valueColumns,
+        QString* errorString);
+
+    /**
+     * @brief 处理后台任务完成
+     */
+    void onFinished();
+
+    /**
+     * @brief 在工作线程中汇总一块数据
+     * @param rows 块数据
+     * @param keyColumn 分组列
+     * @param valueColumns 汇总列
+     * @return 这一块的局部汇总结果
+     */
+    static GroupTable aggregateRows(const QList<QList<QVariant>>& rows, int keyColumn, const QVector<int>& valueColumns);
+
+    /**
+     * @brief 把一个分组的状态合并到汇总表
+     * @param table 汇总表
+     * @param key 分组键
+     * @param state 分组状态
+     */
+    static void mergeGroup(GroupTable& table, const QString& key, const GroupState& state);
+
+    /**
+     * @brief 把一个分组写入临时文件，格式与AggregateDataSource的结果文件相同
+     * @param stream 输出流
+     * @param key 分组键
+     * @param state 分组状态
+     */
+    static void writeGroup(QDataStream& stream, const QString& key, const GroupState& state);
+
+    /**
+     * @brief 从临时文件读取一个分组
+     * @param stream 输入流
+     * @param key 输出分组键
+     * @param state 输出分组状态
+     * @return 是否读取成功
+     */
+    static bool readGroup(QDataStream& stream, QString* key, GroupState* state);
+
+    QFutureWatcher<Result> m_watcher; // 后台任务
+    QThreadPool m_pool; // 读取和局部汇总使用的线程池，不占用全局线程池
+    std::atomic<bool> m_cancelled; // 是否已请求取消
+    std::shared_ptr<DataSource> m_result; // 最近一次成功任务的结果
+    int m_chunkSize; // 每个任务读取的行数
+    int m_maxGroupsInMemory; // 内存中最多保留的分组数
+};
+
+#endif // GROUPBYAGGREGATOR_H
@@ -0,0 +1,129 @@
+#include "RowRangeSet.h"
+#include <algorithm>
+
+RowRangeSet::RowRangeSet()
+    : m_rowCount(0)
+{
+}
+
+void RowRangeSet::clear()
+{
+    m_ranges.clear();
+    m_rowCount = 0;
+}
+
+bool RowRangeSet::isEmpty() const
+{
+    return m_ranges.isEmpty();
+}
+
+void RowRangeSet::addRange(int first, int last)
+{
+    if (first > last)
+        return;
+
+    // 第一个可能与新区间重叠或相邻的区间
+    auto begin = std::lower_bound(m_ranges.begin(), m_ranges.end(), first,
+        [](const Range& range, int row) { return static_cast<qint64>(range.last) + 1 < row; });
+    auto end = begin;
+    Range merged = { first, last };
+    while (end != m_ranges.end() && end->first <= static_cast<qint64>(last) + 1) {
+        merged.first = std::min(merged.first, end->first);
+        merged.last = std::max(merged.last, end->last);
+        m_rowCount -= static_cast<qint64>(end->last) - end->first + 1;
+        ++end;
+    }
+
+    int index = static_cast<int>(begin - m_ranges.begin());
+    m_ranges.erase(begin, end);
+    m_ranges.insert(index, merged);
+    m_rowCount += static_cast<qint64>(merged.last) - merged.first + 1;
+}
+
+void RowRangeSet::removeRange(int first, int last)
+{
+    if (first > last)
+        return;
+
+    // 第一个与被移除区间重叠的区间
+    auto begin = std::lower_bound(m_ranges.begin(), m_ranges.end(), first,
+        [](const Range& range, int row) { return range.last < row; });
+    auto end = begin;
+    QVector<Range> remains;
+    while (end != m_ranges.end() && end->first <= last) {
+        if (end->first < first)
+            remains.append({ end->first, first - 1 });
+        if (end->last > last)
+            remains.append({ last + 1, end->last });
+        m_rowCount -= static_cast<qint64>(end->last) - end->first + 1;
+        ++end;
+    }
+
+    int index = static_cast<int>(begin - m_ranges.begin());
+    m_ranges.erase(begin, end);
+    for (const Range& range : remains) {
+        m_ranges.insert(index++, range);
+        m_rowCount += static_cast<qint64>(range.last) - range.first + 1;
+    }
+}
+
+void RowRangeSet::toggleRange(int first, int last)
+{
+    if (first > last)
+        return;
+
+    // 先记下区间内已有的部分，移除后再把空隙加回来
+    QVector<Range> inside;
+    auto it = std::lower_bound(m_ranges.begin(), m_ranges.end(), first,
+        [](const Range& range, int row) { return range.last < row; });
+    for (; it != m_ranges.end() && it->first <= last; ++it)
+        inside.append({ std::max(it->first, first), std::min(it->last, last) });
+
+    removeRange(first, last);
+
+    qint64 next = first;
+    for (const Range& range : inside) {
+        if (next < range.first)
+            addRange(static_cast<int>(next), range.first - 1);
+        next = static_cast<qint64>(range.last) + 1;
+    }
+    if (next <= last)
+        addRange(static_cast<int>(next), last);
+}
+
+void RowRangeSet::invert(int rowCount)
+{
+    QVector<Range> inverted;
+    qint64 next = 0;
+    for (const Range& range : m_ranges) {
+        if (range.first >= rowCount)
+            break;
+        if (next < range.first)
+            inverted.append({ static_cast<int>(next), range.first - 1 });
+        next = static_cast<qint64>(range.last) + 1;
+    }
+    if (next < rowCount)
+        inverted.append({ static_cast<int>(next), rowCount - 1 });
+
+    m_ranges = inverted;
+    m_rowCount = 0;
+    for (const Range& range : m_ranges)
+        m_rowCount += static_cast<qint64>(range.last) - range.first + 1;
+}
+
+bool RowRangeSet::contains(int row) const
+{
+    auto it = std::lower_bound(m_ranges.constBegin(), m_ranges.constEnd(), row,
+        [](const Range& range, int value) { return range.last < value; });
+    return it != m_ranges.constEnd() && it->first <= row;
+}
+
+qint64 RowRangeSet::rowCount() const
+{
+    return m_rowCount;
+}
+
+const QVector<RowRangeSet::Range>& RowRangeSet::ranges() const
+{
+    return m_ranges;
+}
@@ -0,0 +1,87 @@
+#ifndef ROWRANGESET_H
+#define ROWRANGESET_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief 行区间集合，用有序且互不相邻的闭区间表示一组行
+ *
+ * 选中上千万行时只需要保存少量区间：全选、反选、区间选择的代价只和区间数有关，
+ * 判断某一行是否在集合中是一次二分查找。
+ */
+class RowRangeSet {
+public:
+    /**
+     * @brief 闭区间[first, last]
+     */
+    struct Range {
+        int first; // 起始行
+        int last; // 结束行（包含）
+    };
+
+    RowRangeSet();
+
+    /**
+     * @brief 清空集合
+     */
+    void clear();
+
+    /**
+     * @brief 集合是否为空
+     * @return 是否为空
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 加入区间，与重叠或相邻的区间合并
+     * @param first 起始行
+     * @param last 结束行（包含）
+     */
+    void addRange(int first, int last);
+
+    /**
+     * @brief 移除区间
+     * @param first 起始行
+     * @param last 结束行（包含）
+     */
+    void removeRange(int first, int last);
+
+    /**
+     * @brief 翻转区间内每一行的归属
+     * @param first 起始行
+     * @param last 结束行（包含）
+     */
+    void toggleRange(int first, int last);
+
+    /**
+     * @brief 在[0, rowCount)内取补集
+     * @param rowCount 总行数
+     */
+    void invert(int rowCount);
+
+    /**
+     * @brief 判断行是否在集合中，O(log n)
+     * @param row 行索引
+     * @return 是否包含
+     */
+    bool contains(int row) const;
+
+    /**
+     * @brief 集合中的总行数
+     * @return 行数
+     */
+    qint64 rowCount() const;
+
+    /**
+     * @brief 获取所有区间（按起始行排序）
+     * @return 区间列表
+     */
+    const QVector<Range>& ranges() const;
+
+private:
+    QVector<Range> m_ranges; // 有序、互不重叠且互不相邻的区间
+    qint64 m_rowCount; // 总行数
+};
+
+#endif // ROWRANGESET_H
@@ -0,0 +1,66 @@
+#include "RowSubsetDataSource.h"
+#include <algorithm>
+
+namespace {
+
+// 相邻成员行的间隔不超过这个值时合并读取，多读的行直接丢弃
+constexpr int MaxMergeGap = 32;
+
+}
+
+RowSubsetDataSource::RowSubsetDataSource(std::shared_ptr<DataSource> source, QVector<int> rowIds)
+    : m_source(std::move(source))
+    , m_rowIds(std::move(rowIds))
+{
+}
+
+int RowSubsetDataSource::rowCount() const
+{
+    return m_rowIds.size();
+}
+
+int RowSubsetDataSource::columnCount() const
+{
+    return m_source ? m_source->columnCount() : 0;
+}
+
+QList<QList<QVariant>> RowSubsetDataSource::loadData(int startRow, int count)
+{
+    QList<QList<QVariant>> result;
+    const int endRow = std::min(startRow + count, rowCount());
+    if (!m_source || startRow < 0 || startRow >= endRow)
+        return result;
+
+    result.reserve(endRow - startRow);
+    int i = startRow;
+    while (i < endRow) {
+        // 找出一段可以一次读取的成员行
+        int j = i + 1;
+        while (j < endRow && m_rowIds[j] - m_rowIds[j - 1] <= MaxMergeGap)
+            ++j;
+
+        const int first = m_rowIds[i];
+        const QList<QList<QVariant>> span = m_source->loadData(first, m_rowIds[j - 1] - first + 1);
+        for (int k = i; k < j; ++k) {
+            const int offset = m_rowIds[k] - first;
+            result.append(offset < span.size() ? span[offset] : QList<QVariant>());
+        }
+        i = j;
+    }
+    return result;
+}
+
+QList<QString> RowSubsetDataSource::headerData() const
+{
+    return m_source ? m_source->headerData() : QList<QString>();
+}
+
+std::shared_ptr<DataSource> RowSubsetDataSource::sourceDataSource() const
+{
+    return m_source;
+}
+
+int RowSubsetDataSource::sourceRow(int row) const
+{
+    return (row >= 0 && row < m_rowIds.size()) ? m_rowIds[row] : -1;
+}
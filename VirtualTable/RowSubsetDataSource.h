@@ -0,0 +1,48 @@
+#ifndef ROWSUBSETDATASOURCE_H
+#define ROWSUBSETDATASOURCE_H
+
+#include "DataSource.h"
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief 行子集数据源，按行号列表展示原始数据源中的部分行
+ *
+ * 用于展开分组：只保存成员行号（每行4字节），数据在加载时才从原始数据源读取。
+ * 读取时把行号列表中连续或间隔很近的行合并成一次loadData调用，避免逐行访问原始数据源。
+ */
+class RowSubsetDataSource : public DataSource
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param source 原始数据源
+     * @param rowIds 成员行号，需按升序排列
+     */
+    RowSubsetDataSource(std::shared_ptr<DataSource> source, QVector<int> rowIds);
+    ~RowSubsetDataSource() override = default;
+
+    int rowCount() const override;
+    int columnCount() const override;
+    QList<QList<QVariant>> loadData(int startRow, int count) override;
+    QList<QString> headerData() const override;
+
+    /**
+     * @brief 获取原始数据源
+     * @return 原始数据源
+     */
+    std::shared_ptr<DataSource> sourceDataSource() const;
+
+    /**
+     * @brief 获取行在原始数据源中的行号
+     * @param row 子集中的行
+     * @return 原始行号，行无效时为-1
+     */
+    int sourceRow(int row) const;
+
+private:
+    std::shared_ptr<DataSource> m_source; // 原始数据源
+    QVector<int> m_rowIds; // 成员行号
+};
+
+#endif // ROWSUBSETDATASOURCE_H
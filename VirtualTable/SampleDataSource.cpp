@@ -2,10 +2,25 @@
 #include <chrono>
 #include <string>
 
+namespace {
+
+/**
+ * @brief 由种子和行号得到该行的随机数种子（splitmix64），相邻行的种子互不相关
+ */
+quint64 rowSeed(quint64 seed, int row)
+{
+    quint64 z = seed + (static_cast<quint64>(row) + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}
+
 SampleDataSource::SampleDataSource(int rowCount, int columnCount)
     : m_rowCount(rowCount),
       m_columnCount(columnCount),
-      m_rng(std::chrono::system_clock::now().time_since_epoch().count())
+      m_seed(static_cast<quint64>(std::chrono::system_clock::now().time_since_epoch().count()))
 {
     // 生成表头信息
     for (int i = 0; i < columnCount; ++i) {
@@ -35,6 +50,8 @@ QList<QList<QVariant>> SampleDataSource::loadData(int startRow, int count)
     
     // 生成数据
     for (int row = startRow; row < endRow; ++row) {
+        // 每行单独播种，重复加载同一行得到相同的数据
+        std::minstd_rand rng(static_cast<std::minstd_rand::result_type>(rowSeed(m_seed, row) % std::minstd_rand::modulus));
         QList<QVariant> rowData;
         for (int col = 0; col < m_columnCount; ++col) {
             // 根据列索引生成不同类型的数据
@@ -44,21 +61,21 @@ QList<QList<QVariant>> SampleDataSource::loadData(int startRow, int count)
             } else if (col == 1) {
                 // 第二列是随机整数
                 std::uniform_int_distribution<int> dist(1000, 9999);
-                rowData.append(dist(m_rng));
+                rowData.append(dist(rng));
             } else if (col == 2) {
                 // 第三列是随机浮点数
                 std::uniform_real_distribution<double> dist(0.0, 100.0);
-                rowData.append(QString::number(dist(m_rng), 'f', 2));
+                rowData.append(QString::number(dist(rng), 'f', 2));
             } else if (col == 3) {
                 // 第四列是随机字符串
-                rowData.append(generateRandomString(10 + (row % 20)));
+                rowData.append(generateRandomString(rng, 10 + (row % 20)));
             } else {
                 // 其他列是混合数据
                 if (row % 3 == 0) {
-                    rowData.append(generateRandomString(5));
+                    rowData.append(generateRandomString(rng, 5));
                 } else if (row % 3 == 1) {
                     std::uniform_int_distribution<int> dist(1, 100);
-                    rowData.append(dist(m_rng));
+                    rowData.append(dist(rng));
                 } else {
                     rowData.append(QString("Data-%1-%2").arg(row).arg(col));
                 }
@@ -75,14 +92,14 @@ QList<QString> SampleDataSource::headerData() const
     return m_headers;
 }
 
-QString SampleDataSource::generateRandomString(int length)
+QString SampleDataSource::generateRandomString(std::minstd_rand& rng, int length)
 {
     const std::string chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
     std::uniform_int_distribution<int> dist(0, chars.size() - 1);
     
     QString result;
     for (int i = 0; i < length; ++i) {
-        result.append(chars[dist(m_rng)]);
+        result.append(chars[dist(rng)]);
     }
     return result;
 }
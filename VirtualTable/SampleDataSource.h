@@ -7,7 +7,9 @@
 /**
  * @brief 示例数据源，用于生成测试数据
  * 
- * 这个类生成模拟数据，用于测试虚拟表格控件的性能
+ * 这个类生成模拟数据，用于测试虚拟表格控件的性能。
+ * 每行的随机数由种子和行号决定，同一行无论加载多少次、在哪个线程加载，内容都相同，
+ * 分组汇总和展开分组看到的数据一致。
  */
 class SampleDataSource : public DataSource
 {
@@ -29,14 +31,15 @@ private:
     int m_rowCount;          // 总记录数
     int m_columnCount;       // 总列数
     QList<QString> m_headers; // 表头信息
-    std::mt19937 m_rng;      // 随机数生成器
+    quint64 m_seed;          // 随机种子，构造时确定
 
     /**
      * @brief 生成随机字符串
+     * @param rng 当前行的随机数生成器
      * @param length 字符串长度
      * @return 生成的随机字符串
      */
-    QString generateRandomString(int length);
+    static QString generateRandomString(std::minstd_rand& rng, int length);
 };
 
 #endif // SAMPLEDATASOURCE_H
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "TableExporter.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QFile>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// 缓冲区达到这个大小后整块写盘
+constexpr int WriteBufferSize = 4 * 1024 * 1024;
+
+/**
+ * @brief 一次从数据源读取的连续行
+ */
+struct ExportChunk {
+    int startRow; // 起始行
+    int count; // 行数
+};
+
+/**
+ * @brief 读取好的一块：可以直接写出的原始行，或解析后的行数据
+ */
+struct FetchedChunk {
+    QByteArray raw; // 原始行（每行以换行结束），rawReady为true时有效
+    bool rawReady = false; // 是否可以直接写出原始行
+    QList<QList<QVariant>> rows; // 解析后的行数据
+};
+
+}
+
+TableExporter::TableExporter(QObject* parent)
+    : QObject(parent)
+    , m_cancelled(false)
+    , m_chunkSize(50000)
+    , m_includeHeader(true)
+{
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &TableExporter::onFinished);
+}
+
+TableExporter::~TableExporter()
+{
+    // 后台任务持有数据源，退出前必须等它结束
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void TableExporter::setChunkSize(int rowCount)
+{
+    // 后台任务直接读取这些设置，导出进行中不允许修改
+    if (rowCount > 0 && !isRunning()) {
+        m_chunkSize = rowCount;
+    }
+}
+
+void TableExporter::setIncludeHeader(bool include)
+{
+    if (!isRunning()) {
+        m_includeHeader = include;
+    }
+}
+
+bool TableExporter::exportToFile(std::shared_ptr<DataSource> source, const QString& filePath,
+    Format format, const RowRangeSet& rows)
+{
+    if (filePath.isEmpty())
+        return false;
+
+    return start(std::move(source), filePath, format, rows, false);
+}
+
+bool TableExporter::copyToClipboard(std::shared_ptr<DataSource> source, const RowRangeSet& rows)
+{
+    // 剪贴板文本整块保存在内存中，不能像导出文件那样在未选择时处理全部行
+    if (rows.isEmpty())
+        return false;
+
+    if (rows.rowCount() > MaxClipboardRows) {
+        if (!isRunning()) {
+            emit finished(false, QStringLiteral("选中了%1行，超过复制上限%2行，请改用导出")
+                .arg(rows.rowCount()).arg(MaxClipboardRows));
+        }
+        return false;
+    }
+
+    return start(std::move(source), QString(), Format::Tsv, rows, true);
+}
+
+void TableExporter::cancel()
+{
+    m_cancelled = true;
+}
+
+bool TableExporter::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+bool TableExporter::start(std::shared_ptr<DataSource> source, const QString& filePath,
+    Format format, const RowRangeSet& rows, bool toClipboard)
+{
+    if (!source || isRunning())
+        return false;
+
+    m_cancelled = false;
+    m_watcher.setFuture(QtConcurrent::run([this, source, filePath, format, rows, toClipboard]() {
+        return run(source, filePath, format, rows, toClipboard);
+    }));
+    return true;
+}
+
+TableExporter::Result TableExporter::run(std::shared_ptr<DataSource> source, const QString& filePath,
+    Format format, const RowRangeSet& rows, bool toClipboard)
+{
+    Result result;
+    result.toClipboard = toClipboard;
+
+    // 按区间切分成连续的读取块
+    QVector<ExportChunk> chunks;
+    qint64 totalRows = 0;
+    const int rowCount = source->rowCount();
+    auto appendRange = [&](int first, int last) {
+        first = std::max(0, first);
+        last = std::min(rowCount - 1, last);
+        for (qint64 start = first; start <= last; start += m_chunkSize) {
+            int count = static_cast<int>(std::min<qint64>(m_chunkSize, last - start + 1));
+            chunks.append({ static_cast<int>(start), count });
+            totalRows += count;
+        }
+    };
+    if (rows.isEmpty()) {
+        appendRange(0, rowCount - 1);
+    } else {
+        for (const RowRangeSet::Range& range : rows.ranges())
+            appendRange(range.first, range.last);
+    }
+
+    QFile file(filePath);
+    if (!toClipboard && !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        result.errorString = file.errorString();
+        return result;
+    }
+
+    // 剪贴板文本直接累积在结果中，文件输出则经过固定大小的缓冲区
+    QByteArray fileBuffer;
+    QByteArray& buffer = toClipboard ? result.clipboardText : fileBuffer;
+    if (!toClipboard) {
+        fileBuffer.reserve(WriteBufferSize + 64 * 1024);
+    }
+    auto flush = [&]() {
+        if (toClipboard || buffer.isEmpty())
+            return true;
+        if (file.write(buffer) != buffer.size()) {
+            result.errorString = file.errorString();
+            return false;
+        }
+        buffer.resize(0);
+        return true;
+    };
+
+    const char delimiter = (format == Format::Csv) ? ',' : '\t';
+
+    // 表头行
+    if (m_includeHeader) {
+        const QList<QString> headers = source->headerData();
+        for (int column = 0; column < headers.size(); ++column) {
+            if (column > 0)
+                buffer += delimiter;
+            appendField(buffer, headers[column], format);
+        }
+        buffer += '\n';
+    }
+
+    // 格式化当前块时，下一块已经在另一个线程中读取；能直接复制原始行的块在读取线程中就已完成
+    auto fetch = [source, delimiter](const ExportChunk& chunk) {
+        return QtConcurrent::run([source, delimiter, chunk]() {
+            FetchedChunk fetched;
+            fetched.rawReady = source->writeRawRows(chunk.startRow, chunk.count, delimiter, &fetched.raw);
+            if (!fetched.rawReady) {
+                fetched.raw.clear();
+                fetched.rows = source->loadData(chunk.startRow, chunk.count);
+            }
+            return fetched;
+        });
+    };
+
+    qint64 rowsWritten = 0;
+    bool ok = true;
+    QFuture<FetchedChunk> pending;
+    if (!chunks.isEmpty()) {
+        pending = fetch(chunks.first());
+    }
+
+    for (int i = 0; i < chunks.size() && ok; ++i) {
+        const FetchedChunk data = pending.result();
+        if (m_cancelled)
+            break;
+        if (i + 1 < chunks.size()) {
+            pending = fetch(chunks[i + 1]);
+        }
+
+        if (data.rawReady) {
+            buffer += data.raw;
+            if (buffer.size() >= WriteBufferSize && !flush()) {
+                ok = false;
+            }
+        }
+
+        for (const QList<QVariant>& rowData : data.rows) {
+            for (int column = 0; column < rowData.size(); ++column) {
+                if (column > 0)
+                    buffer += delimiter;
+                appendField(buffer, rowData[column].toString(), format);
+            }
+            buffer += '\n';
+
+            if (buffer.size() >= WriteBufferSize && !flush()) {
+                ok = false;
+                break;
+            }
+        }
+
+        rowsWritten += chunks[i].count;
+        emit progressChanged(rowsWritten, totalRows);
+    }
+
+    // 取消或出错时可能还有一块在读取
+    pending.waitForFinished();
+
+    if (ok && !m_cancelled) {
+        ok = flush();
+    }
+
+    if (!toClipboard) {
+        file.close();
+        if (!ok || m_cancelled) {
+            file.remove();
+        }
+    }
+
+    if (m_cancelled) {
+        result.errorString = QStringLiteral("导出已取消");
+        result.clipboardText.clear();
+        return result;
+    }
+
+    result.success = ok;
+    return result;
+}
+
+void TableExporter::onFinished()
+{
+    Result result = m_watcher.result();
+
+    if (result.success && result.toClipboard) {
+        QApplication::clipboard()->setText(QString::fromUtf8(result.clipboardText));
+    }
+
+    emit finished(result.success, result.errorString);
+}
+
+void TableExporter::appendField(QByteArray& buffer, const QString& text, Format format)
+{
+    QByteArray utf8 = text.toUtf8();
+
+    if (format == Format::Tsv) {
+        // TSV没有转义规则，分隔符和换行直接替换为空格
+        for (char& ch : utf8) {
+            if (ch == '\t' || ch == '\n' || ch == '\r')
+                ch = ' ';
+        }
+        buffer += utf8;
+        return;
+    }
+
+    bool needsQuotes = false;
+    for (char ch : utf8) {
+        if (ch == ',' || ch == '"' || ch == '\n' || ch == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+
+    if (!needsQuotes) {
+        buffer += utf8;
+        return;
+    }
+
+    // 字段加引号，内部的引号写两次
+    buffer += '"';
+    for (char ch : utf8) {
+        if (ch == '"')
+            buffer += '"';
+        buffer += ch;
+    }
+    buffer += '"';
+}
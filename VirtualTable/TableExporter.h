@@ -0,0 +1,152 @@
+#ifndef TABLEEXPORTER_H
+#define TABLEEXPORTER_H
+
+#include "DataSource.h"
+#include "RowRangeSet.h"
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief 流式表格导出类，把数据源中的全部或选中行导出为CSV/TSV文件或剪贴板文本
+ *
+ * 导出直接从DataSource按大块顺序读取，不经过模型的块缓存：
+ * 后台线程在格式化当前块的同时预取下一块，结果写入缓冲区后整块写盘，
+ * 因此导出千万行时内存占用只和块大小有关，也不会阻塞界面线程。
+ * CSV数据源为UTF-8编码、分隔符与导出格式相同且引号为双引号时，整块扫描字段边界，
+ * 不需要转义的块直接复制原始行，不生成QVariant也不重新编码。
+ * 导出过程中通过progressChanged()报告进度，可以随时cancel()。
+ * 剪贴板文本全部保存在内存中，只复制选中的行，且最多MaxClipboardRows行。
+ */
+class TableExporter : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 MaxClipboardRows = 1000000; // 一次最多复制到剪贴板的行数
+
+    /**
+     * @brief 导出格式
+     */
+    enum class Format {
+        Csv, // 逗号分隔，按RFC 4180加引号转义
+        Tsv // 制表符分隔，字段内的制表符和换行替换为空格
+    };
+
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit TableExporter(QObject* parent = nullptr);
+    ~TableExporter() override;
+
+    /**
+     * @brief 设置每次从数据源读取的行数
+     * @param rowCount 行数
+     */
+    void setChunkSize(int rowCount);
+
+    /**
+     * @brief 设置是否输出表头行
+     * @param include 是否输出表头
+     */
+    void setIncludeHeader(bool include);
+
+    /**
+     * @brief 在后台导出到文件
+     * @param source 数据源
+     * @param filePath 目标文件路径
+     * @param format 导出格式
+     * @param rows 要导出的行，为空时导出全部行
+     * @return 是否成功启动（已有导出在进行时返回false）
+     */
+    bool exportToFile(std::shared_ptr<DataSource> source, const QString& filePath,
+        Format format, const RowRangeSet& rows = RowRangeSet());
+
+    /**
+     * @brief 在后台生成TSV文本，完成后写入剪贴板
+     *
+     * 没有选中行时不复制；超过MaxClipboardRows行时不复制，并通过finished()报告原因
+     * @param source 数据源
+     * @param rows 要复制的行
+     * @return 是否成功启动（已有导出在进行时返回false）
+     */
+    bool copyToClipboard(std::shared_ptr<DataSource> source, const RowRangeSet& rows);
+
+    /**
+     * @brief 取消正在进行的导出，已写出的部分文件会被删除
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有导出正在进行
+     * @return 是否正在导出
+     */
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief 导出进度信号，每处理完一块发出一次（可能来自后台线程）
+     * @param rowsWritten 已导出的行数
+     * @param totalRows 需要导出的总行数
+     */
+    void progressChanged(qint64 rowsWritten, qint64 totalRows);
+
+    /**
+     * @brief 导出结束信号
+     * @param success 是否成功
+     * @param errorString 失败或取消时的原因
+     */
+    void finished(bool success, const QString& errorString);
+
+private:
+    /**
+     * @brief 后台导出结果
+     */
+    struct Result {
+        bool success = false; // 是否成功
+        QString errorString; // 错误信息
+        QByteArray clipboardText; // 复制到剪贴板的UTF-8文本
+        bool toClipboard = false; // 是否输出到剪贴板
+    };
+
+    /**
+     * @brief 启动后台导出
+     * @param source 数据源
+     * @param filePath 目标文件路径，输出到剪贴板时为空
+     * @param format 导出格式
+     * @param rows 要导出的行
+     * @param toClipboard 是否输出到剪贴板
+     * @return 是否成功启动
+     */
+    bool start(std::shared_ptr<DataSource> source, const QString& filePath,
+        Format format, const RowRangeSet& rows, bool toClipboard);
+
+    /**
+     * @brief 在后台线程中执行导出
+     */
+    Result run(std::shared_ptr<DataSource> source, const QString& filePath,
+        Format format, const RowRangeSet& rows, bool toClipboard);
+
+    /**
+     * @brief 处理后台导出完成
+     */
+    void onFinished();
+
+    /**
+     * @brief 把一个字段按格式追加到输出缓冲区
+     * @param buffer 输出缓冲区
+     * @param text 字段文本
+     * @param format 导出格式
+     */
+    static void appendField(QByteArray& buffer, const QString& text, Format format);
+
+    QFutureWatcher<Result> m_watcher; // 后台导出任务
+    std::atomic<bool> m_cancelled; // 是否已请求取消
+    int m_chunkSize; // 每次读取的行数
+    bool m_includeHeader; // 是否输出表头行
+};
+
+#endif // TABLEEXPORTER_H
@@ -0,0 +1,688 @@
+#include "VirtualGridView.h"
+#include <QApplication>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScreen>
+#include <QScrollBar>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief 行号区域，绘制工作交给VirtualGridView完成
+ */
+class VirtualGridRowHeader : public QWidget {
+public:
+    explicit VirtualGridRowHeader(VirtualGridView* view)
+        : QWidget(view)
+        , m_view(view)
+    {
+        setAttribute(Qt::WA_OpaquePaintEvent);
+    }
+
+protected:
+    void paintEvent(QPaintEvent* event) override
+    {
+        Q_UNUSED(event);
+        QPainter painter(this);
+        m_view->paintRowNumbers(&painter, rect());
+    }
+
+private:
+    VirtualGridView* m_view;
+};
+
+VirtualGridView::VirtualGridView(QWidget* parent)
+    : QAbstractScrollArea(parent)
+    , m_virtualModel(nullptr)
+    , m_delegate(new VirtualTableDelegate(this))
+    , m_selectionModel(nullptr)
+    , m_anchorRow(-1)
+    , m_helper(nullptr)
+    , m_horizontalHeader(new QHeaderView(Qt::Horizontal, this))
+    , m_rowHeader(new VirtualGridRowHeader(this))
+    , m_rowHeight(25)
+    , m_bufferSize(50)
+    , m_scrollOffset(0)
+    , m_scrollSpeed(0.0)
+    , m_syncingScrollBar(false)
+    , m_visibleRangeDirty(false)
+    , m_visibleStartRow(-1)
+    , m_visibleEndRow(-1)
+    , m_frameStatsEnabled(false)
+    , m_frameStatsOverlayVisible(false)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    viewport()->setBackgroundRole(QPalette::Base);
+
+    // 列表头
+    m_horizontalHeader->setSectionsClickable(false);
+    m_horizontalHeader->setHighlightSections(false);
+    m_horizontalHeader->setSectionsMovable(true);
+    m_helper = new VirtualViewHelper(this, m_horizontalHeader);
+    connect(m_horizontalHeader, &QHeaderView::sectionResized, this, &VirtualGridView::updateGeometries);
+    connect(m_horizontalHeader, &QHeaderView::sectionMoved, this, &VirtualGridView::updateGeometries);
+    connect(m_horizontalHeader, &QHeaderView::sectionCountChanged, this, &VirtualGridView::updateGeometries);
+
+    // 单步和翻页使用精确像素，不经过滚动条的粗粒度映射
+    connect(verticalScrollBar(), &QScrollBar::actionTriggered, this, [this](int action) {
+        qint64 delta = 0;
+        switch (action) {
+        case QAbstractSlider::SliderSingleStepAdd:
+            delta = m_rowHeight;
+            break;
+        case QAbstractSlider::SliderSingleStepSub:
+            delta = -m_rowHeight;
+            break;
+        case QAbstractSlider::SliderPageStepAdd:
+            delta = viewport()->height();
+            break;
+        case QAbstractSlider::SliderPageStepSub:
+            delta = -viewport()->height();
+            break;
+        default:
+            return;
+        }
+
+        // 撤销滚动条自己的步进，改为按像素移动
+        verticalScrollBar()->setSliderPosition(verticalScrollBar()->value());
+        applyScrollOffset(m_scrollOffset + delta, true);
+    });
+}
+
+VirtualGridView::~VirtualGridView()
+{
+}
+
+void VirtualGridView::setVirtualModel(VirtualTableModel* model)
+{
+    if (m_virtualModel == model)
+        return;
+
+    if (m_virtualModel) {
+        disconnect(m_virtualModel, nullptr, this, nullptr);
+        m_virtualModel->setFrameCountersEnabled(false);
+    }
+
+    m_virtualModel = model;
+    m_horizontalHeader->setModel(model);
+
+    // 选择模型跟随数据模型重建
+    delete m_selectionModel;
+    m_selectionModel = model ? new VirtualSelectionModel(model, this) : nullptr;
+    m_delegate->setSelectionModel(m_selectionModel);
+    m_anchorRow = -1;
+    if (m_selectionModel) {
+        connect(m_selectionModel, &QItemSelectionModel::selectionChanged, viewport(), [this]() {
+            viewport()->update();
+        });
+    }
+
+    if (m_virtualModel) {
+        connect(m_virtualModel, &QAbstractItemModel::dataChanged, this, &VirtualGridView::onDataChanged);
+        connect(m_virtualModel, &QAbstractItemModel::modelReset, this, &VirtualGridView::onModelReset);
+        connect(m_virtualModel, &QAbstractItemModel::layoutChanged, this, &VirtualGridView::onModelReset);
+        connect(m_virtualModel, &QObject::destroyed, this, [this]() {
+            m_virtualModel = nullptr;
+            m_delegate->setSelectionModel(nullptr);
+            delete m_selectionModel;
+            m_selectionModel = nullptr;
+            viewport()->update();
+            m_rowHeader->update();
+        });
+    }
+
+    syncFrameCounters();
+    onModelReset();
+
+    // 抽样估算列宽，只读取少量分布在全表的行
+    m_helper->setModel(m_virtualModel, m_selectionModel);
+}
+
+VirtualTableModel* VirtualGridView::virtualModel() const
+{
+    return m_virtualModel;
+}
+
+QHeaderView* VirtualGridView::horizontalHeader() const
+{
+    return m_horizontalHeader;
+}
+
+void VirtualGridView::setRowHeight(int rowHeight)
+{
+    if (rowHeight <= 0 || rowHeight == m_rowHeight)
+        return;
+
+    // 保持顶部行不变
+    qint64 topRow = m_scrollOffset / m_rowHeight;
+    m_rowHeight = rowHeight;
+    m_scrollOffset = topRow * m_rowHeight;
+
+    updateGeometries();
+    applyScrollOffset(m_scrollOffset, true);
+}
+
+int VirtualGridView::rowHeight() const
+{
+    return m_rowHeight;
+}
+
+void VirtualGridView::setBufferSize(int bufferSize)
+{
+    if (bufferSize >= 0 && bufferSize != m_bufferSize) {
+        m_bufferSize = bufferSize;
+        m_visibleRangeDirty = true;
+        viewport()->update();
+    }
+}
+
+void VirtualGridView::jumpToRow(int rowIndex)
+{
+    if (!m_virtualModel || rowIndex < 0 || rowIndex >= m_virtualModel->rowCount())
+        return;
+
+    // 目标行放在视口中间
+    qint64 offset = static_cast<qint64>(rowIndex) * m_rowHeight - (viewport()->height() - m_rowHeight) / 2;
+    applyScrollOffset(offset, true);
+}
+
+int VirtualGridView::jumpToValue(int column, const QString& value, ColumnIndex::Match match)
+{
+    if (!m_virtualModel)
+        return -1;
+
+    disconnect(m_pendingJump);
+    int row = m_virtualModel->findFirstRow(column, value, match);
+    if (row >= 0) {
+        jumpToRow(row);
+        return row;
+    }
+
+    // 没有列索引时在后台查找，界面线程不读取数据
+    if (m_virtualModel->columnIndex(column) || !m_virtualModel->searchFirstRow(column, value, match))
+        return -1;
+    m_pendingJump = connect(m_virtualModel, &VirtualTableModel::firstRowFound, this, [this](int, int foundRow) {
+        disconnect(m_pendingJump);
+        if (foundRow >= 0) {
+            jumpToRow(foundRow);
+        }
+    });
+    return VirtualTableModel::SearchPending;
+}
+
+qint64 VirtualGridView::scrollOffset() const
+{
+    return m_scrollOffset;
+}
+
+void VirtualGridView::setScrollOffset(qint64 offset)
+{
+    applyScrollOffset(offset, true);
+}
+
+int VirtualGridView::visibleStartRow() const
+{
+    return std::max(0, m_visibleStartRow);
+}
+
+int VirtualGridView::visibleEndRow() const
+{
+    return std::max(0, m_visibleEndRow);
+}
+
+VirtualSelectionModel* VirtualGridView::virtualSelectionModel() const
+{
+    return m_selectionModel;
+}
+
+void VirtualGridView::invertSelection()
+{
+    if (m_selectionModel) {
+        m_selectionModel->invertSelection();
+    }
+}
+
+void VirtualGridView::resizeColumnsToSampledContents()
+{
+    m_helper->resizeColumnsToSampledContents();
+}
+
+void VirtualGridView::copySelection()
+{
+    m_helper->copySelection();
+}
+
+TableExporter* VirtualGridView::exporter() const
+{
+    return m_helper->exporter();
+}
+
+void VirtualGridView::setFrameStatsEnabled(bool enabled)
+{
+    if (m_frameStatsEnabled == enabled)
+        return;
+
+    m_frameStatsEnabled = enabled;
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        m_frameStats.setRefreshRate(screen->refreshRate());
+    }
+    syncFrameCounters();
+    viewport()->update();
+}
+
+bool VirtualGridView::isFrameStatsEnabled() const
+{
+    return m_frameStatsEnabled;
+}
+
+void VirtualGridView::setFrameStatsOverlayVisible(bool visible)
+{
+    m_frameStatsOverlayVisible = visible;
+    viewport()->update();
+}
+
+const FrameStats& VirtualGridView::frameStats() const
+{
+    return m_frameStats;
+}
+
+void VirtualGridView::dumpFrameStats()
+{
+    m_frameStats.dumpHistogram();
+    m_frameStats.reset();
+}
+
+void VirtualGridView::syncFrameCounters()
+{
+    // 换模型或换数据源后统计从头开始，不混入上一张表的帧
+    disconnect(m_blockLoadedConnection);
+    disconnect(m_modelResetConnection);
+    m_frameStats.reset();
+    if (!m_virtualModel)
+        return;
+
+    m_virtualModel->setFrameCountersEnabled(m_frameStatsEnabled);
+    if (m_frameStatsEnabled) {
+        m_blockLoadedConnection = connect(m_virtualModel, &VirtualTableModel::blockLoaded, this,
+            [this](int startRow, int endRow) { m_frameStats.blockArrived(startRow, endRow); });
+        m_modelResetConnection = connect(m_virtualModel, &QAbstractItemModel::modelReset, this,
+            [this]() { m_frameStats.reset(); });
+    }
+}
+
+void VirtualGridView::paintEvent(QPaintEvent* event)
+{
+    if (m_frameStatsEnabled) {
+        m_frameStats.beginFrame();
+    }
+
+    // 每帧最多计算一次可见范围，加载请求在绘制单元格之前发出
+    if (m_visibleRangeDirty) {
+        updateVisibleRange();
+    }
+
+    QPainter painter(viewport());
+    paintCells(&painter, event->rect());
+
+    if (m_frameStatsEnabled && m_virtualModel && m_rowHeight > 0) {
+        const qint64 lastRow = std::max(0, m_virtualModel->rowCount() - 1);
+        int firstRow = static_cast<int>(std::min(lastRow, m_scrollMapper.rowAtOffset(m_scrollOffset)));
+        int endRow = static_cast<int>(std::min(lastRow, m_scrollMapper.rowAtOffset(m_scrollOffset + std::max(1, viewport()->height()) - 1)));
+        m_frameStats.endFrame(m_virtualModel->takeFrameCounters(), firstRow, endRow);
+        if (m_frameStatsOverlayVisible) {
+            m_frameStats.paintOverlay(&painter, viewport()->rect());
+        }
+    }
+}
+
+void VirtualGridView::paintCells(QPainter* painter, const QRect& rect)
+{
+    const QRect area = viewport()->rect();
+    painter->fillRect(rect, palette().brush(QPalette::Base));
+
+    if (!m_virtualModel || m_rowHeight <= 0)
+        return;
+
+    const int rowCount = m_virtualModel->rowCount();
+    const int columnCount = m_horizontalHeader->count();
+    if (rowCount <= 0 || columnCount <= 0)
+        return;
+
+    // 可见行完全由偏移算出，不需要查询任何表头
+    int row = static_cast<int>(m_scrollMapper.rowAtOffset(m_scrollOffset));
+    int y = -static_cast<int>(m_scrollOffset % m_rowHeight);
+
+    // 可见列
+    int firstVisual = m_horizontalHeader->visualIndexAt(0);
+    int lastVisual = m_horizontalHeader->visualIndexAt(area.width() - 1);
+    if (firstVisual < 0)
+        return;
+    if (lastVisual < 0)
+        lastVisual = columnCount - 1;
+
+    // 所有单元格共享的样式选项
+    QStyleOptionViewItem baseOption;
+    baseOption.initFrom(this);
+    baseOption.state &= ~QStyle::State_HasFocus;
+    baseOption.font = font();
+    baseOption.displayAlignment = Qt::AlignLeft | Qt::AlignVCenter;
+    baseOption.textElideMode = Qt::ElideRight;
+    baseOption.features = QStyleOptionViewItem::HasDisplay;
+    baseOption.widget = this;
+
+    const QBrush alternateBrush = palette().brush(QPalette::AlternateBase);
+
+    for (; row < rowCount && y < area.height(); ++row, y += m_rowHeight) {
+        // 交替行背景
+        if (row & 1) {
+            painter->fillRect(QRect(0, y, area.width(), m_rowHeight), alternateBrush);
+        }
+
+        for (int visual = firstVisual; visual <= lastVisual; ++visual) {
+            int column = m_horizontalHeader->logicalIndex(visual);
+            if (m_horizontalHeader->isSectionHidden(column))
+                continue;
+
+            QStyleOptionViewItem option = baseOption;
+            option.rect = QRect(m_horizontalHeader->sectionViewportPosition(column), y,
+                m_horizontalHeader->sectionSize(column), m_rowHeight);
+            m_delegate->paint(painter, option, m_virtualModel->index(row, column));
+        }
+    }
+}
+
+void VirtualGridView::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    m_visibleRangeDirty = true;
+    updateGeometries();
+}
+
+void VirtualGridView::wheelEvent(QWheelEvent* event)
+{
+    // 优先使用触控板的像素增量，否则按滚轮行数换算
+    qint64 dy = 0;
+    int dx = 0;
+    if (!event->pixelDelta().isNull()) {
+        dy = event->pixelDelta().y();
+        dx = event->pixelDelta().x();
+    } else {
+        dy = static_cast<qint64>(event->angleDelta().y()) * QApplication::wheelScrollLines() * m_rowHeight / 120;
+        dx = event->angleDelta().x() * horizontalScrollBar()->singleStep() / 120;
+    }
+
+    if (dy != 0) {
+        applyScrollOffset(m_scrollOffset - dy, true);
+    }
+    if (dx != 0) {
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - dx);
+    }
+
+    event->accept();
+}
+
+void VirtualGridView::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::SelectAll)) {
+        if (m_selectionModel) {
+            m_selectionModel->selectAllRows();
+        }
+        event->accept();
+        return;
+    }
+
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        event->accept();
+        return;
+    }
+
+    switch (event->key()) {
+    case Qt::Key_Up:
+        applyScrollOffset(m_scrollOffset - m_rowHeight, true);
+        break;
+    case Qt::Key_Down:
+        applyScrollOffset(m_scrollOffset + m_rowHeight, true);
+        break;
+    case Qt::Key_PageUp:
+        applyScrollOffset(m_scrollOffset - viewport()->height(), true);
+        break;
+    case Qt::Key_PageDown:
+        applyScrollOffset(m_scrollOffset + viewport()->height(), true);
+        break;
+    case Qt::Key_Home:
+        applyScrollOffset(0, true);
+        break;
+    case Qt::Key_End:
+        applyScrollOffset(m_scrollMapper.maxOffset(), true);
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+        return;
+    }
+
+    event->accept();
+}
+
+void VirtualGridView::mousePressEvent(QMouseEvent* event)
+{
+    int row = rowAt(event->pos().y());
+    if (event->button() != Qt::LeftButton || !m_selectionModel || row < 0) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    // 与QTableView的ExtendedSelection一致：Ctrl切换单行，Shift从锚点扩展
+    QModelIndex index = m_virtualModel->index(row, 0);
+    QItemSelectionModel::SelectionFlags rows = QItemSelectionModel::Rows;
+    if ((event->modifiers() & Qt::ShiftModifier) && m_anchorRow >= 0) {
+        QItemSelection selection(m_virtualModel->index(std::min(m_anchorRow, row), 0),
+            m_virtualModel->index(std::max(m_anchorRow, row), 0));
+        QItemSelectionModel::SelectionFlags command = (event->modifiers() & Qt::ControlModifier)
+            ? QItemSelectionModel::Select
+            : QItemSelectionModel::ClearAndSelect;
+        m_selectionModel->select(selection, command | rows);
+    } else if (event->modifiers() & Qt::ControlModifier) {
+        m_selectionModel->select(index, QItemSelectionModel::Toggle | rows);
+        m_anchorRow = row;
+    } else {
+        m_selectionModel->select(index, QItemSelectionModel::ClearAndSelect | rows);
+        m_anchorRow = row;
+    }
+    m_selectionModel->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+    event->accept();
+}
+
+void VirtualGridView::scrollContentsBy(int dx, int dy)
+{
+    if (dx != 0) {
+        m_horizontalHeader->setOffset(horizontalScrollBar()->value());
+        viewport()->update();
+    }
+
+    // 拖动滚动条时从滚动条值反算64位偏移
+    if (dy != 0 && !m_syncingScrollBar) {
+        applyScrollOffset(m_scrollMapper.offsetForValue(verticalScrollBar()->value()), false);
+    }
+}
+
+void VirtualGridView::onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (m_rowHeight <= 0)
+        return;
+
+    // 只在变化区域与视口相交时重绘
+    qint64 firstRow = m_scrollOffset / m_rowHeight;
+    qint64 lastRow = (m_scrollOffset + viewport()->height()) / m_rowHeight;
+    if (bottomRight.row() >= firstRow && topLeft.row() <= lastRow) {
+        viewport()->update();
+    }
+}
+
+void VirtualGridView::onModelReset()
+{
+    m_scrollOffset = 0;
+    m_visibleStartRow = -1;
+    m_visibleEndRow = -1;
+
+    updateGeometries();
+    applyScrollOffset(0, true);
+}
+
+void VirtualGridView::updateGeometries()
+{
+    // 行号区域和表头放在视口边距内
+    int rowHeaderWidth = rowNumberWidth();
+    int headerHeight = m_horizontalHeader->sizeHint().height();
+    setViewportMargins(rowHeaderWidth, headerHeight, 0, 0);
+
+    QRect viewportGeometry = viewport()->geometry();
+    m_horizontalHeader->setGeometry(viewportGeometry.left(), viewportGeometry.top() - headerHeight,
+        viewportGeometry.width(), headerHeight);
+    m_rowHeader->setGeometry(viewportGeometry.left() - rowHeaderWidth, viewportGeometry.top(),
+        rowHeaderWidth, viewportGeometry.height());
+
+    updateScrollBars();
+    viewport()->update();
+    m_rowHeader->update();
+}
+
+void VirtualGridView::paintRowNumbers(QPainter* painter, const QRect& rect) const
+{
+    painter->fillRect(rect, palette().brush(QPalette::Button));
+    painter->setPen(palette().color(QPalette::Mid));
+    painter->drawLine(rect.topRight(), rect.bottomRight());
+
+    if (!m_virtualModel || m_rowHeight <= 0)
+        return;
+
+    const int rowCount = m_virtualModel->rowCount();
+    int row = static_cast<int>(m_scrollOffset / m_rowHeight);
+    int y = -static_cast<int>(m_scrollOffset % m_rowHeight);
+
+    painter->setPen(palette().color(QPalette::ButtonText));
+    for (; row < rowCount && y < rect.height(); ++row, y += m_rowHeight) {
+        QRect textRect(rect.left(), y, rect.width() - 6, m_rowHeight);
+        painter->drawText(textRect, Qt::AlignRight | Qt::AlignVCenter,
+            QString::number(static_cast<qint64>(row) + 1));
+    }
+}
+
+int VirtualGridView::rowAt(int y) const
+{
+    if (!m_virtualModel || m_rowHeight <= 0 || y < 0)
+        return -1;
+
+    qint64 row = m_scrollMapper.rowAtOffset(m_scrollOffset + y);
+    return row < m_virtualModel->rowCount() ? static_cast<int>(row) : -1;
+}
+
+int VirtualGridView::rowNumberWidth() const
+{
+    int rowCount = m_virtualModel ? m_virtualModel->rowCount() : 0;
+    return fontMetrics().horizontalAdvance(QString::number(std::max(rowCount, 1000))) + 12;
+}
+
+void VirtualGridView::syncScrollMapper()
+{
+    m_scrollMapper.setRowCount(m_virtualModel ? m_virtualModel->rowCount() : 0);
+    m_scrollMapper.setRowHeight(m_rowHeight);
+    m_scrollMapper.setViewportHeight(viewport()->height());
+}
+
+void VirtualGridView::updateScrollBars()
+{
+    syncScrollMapper();
+    m_scrollOffset = m_scrollMapper.clampOffset(m_scrollOffset);
+
+    // 超出int范围后滚动条按比例缩放，滑块拖动为粗粒度定位
+    QScrollBar* verticalBar = verticalScrollBar();
+    m_syncingScrollBar = true;
+    verticalBar->setRange(0, m_scrollMapper.maximumValue());
+    verticalBar->setPageStep(m_scrollMapper.pageStep());
+    verticalBar->setSingleStep(m_scrollMapper.singleStep());
+    verticalBar->setValue(m_scrollMapper.valueForOffset(m_scrollOffset));
+    m_syncingScrollBar = false;
+
+    QScrollBar* horizontalBar = horizontalScrollBar();
+    horizontalBar->setRange(0, std::max(0, m_horizontalHeader->length() - viewport()->width()));
+    horizontalBar->setPageStep(viewport()->width());
+    horizontalBar->setSingleStep(20);
+}
+
+void VirtualGridView::applyScrollOffset(qint64 offset, bool syncScrollBar)
+{
+    offset = m_scrollMapper.clampOffset(offset);
+    qint64 delta = offset - m_scrollOffset;
+    m_scrollOffset = offset;
+
+    // 更新滚动速度到模型，速度带方向，向下为正
+    if (delta == 0) {
+        m_scrollSpeed = 0.0;
+    } else if (m_virtualModel) {
+        if (m_scrollTimer.isValid() && m_scrollTimer.elapsed() > 0) {
+            m_scrollSpeed = static_cast<double>(delta) / (m_scrollTimer.elapsed() / 1000.0);
+            m_virtualModel->setScrollSpeed(std::abs(m_scrollSpeed));
+        }
+        m_scrollTimer.restart();
+    }
+
+    // 记录滚动事件，用于统计滚动到数据的延迟
+    if (delta != 0 && m_frameStatsEnabled) {
+        m_frameStats.markScrolled();
+    }
+
+    if (syncScrollBar) {
+        m_syncingScrollBar = true;
+        verticalScrollBar()->setValue(m_scrollMapper.valueForOffset(m_scrollOffset));
+        m_syncingScrollBar = false;
+    }
+
+    // 可见范围在本帧绘制前更新
+    m_visibleRangeDirty = true;
+    viewport()->update();
+    m_rowHeader->update();
+}
+
+void VirtualGridView::updateVisibleRange()
+{
+    m_visibleRangeDirty = false;
+
+    if (!m_virtualModel || m_rowHeight <= 0)
+        return;
+
+    const int rowCount = m_virtualModel->rowCount();
+    if (rowCount <= 0)
+        return;
+
+    // O(1)计算可见行
+    qint64 firstRow = m_scrollMapper.rowAtOffset(m_scrollOffset);
+    qint64 lastRow = m_scrollMapper.rowAtOffset(m_scrollOffset + std::max(1, viewport()->height()) - 1);
+
+    // 按预测的下一帧位置向滚动方向扩展，停止滚动200ms后不再预测
+    double speed = (m_scrollTimer.isValid() && m_scrollTimer.elapsed() < 200) ? m_scrollSpeed : 0.0;
+    QScreen* screen = QGuiApplication::primaryScreen();
+    double refreshRate = (screen && screen->refreshRate() > 0.0) ? screen->refreshRate() : 60.0;
+    qint64 leadRows = static_cast<qint64>(std::ceil(std::abs(speed) / refreshRate / m_rowHeight));
+    if (speed > 0) {
+        lastRow += leadRows;
+    } else if (speed < 0) {
+        firstRow -= leadRows;
+    }
+
+    int startRow = static_cast<int>(std::max<qint64>(0, firstRow - m_bufferSize));
+    int endRow = static_cast<int>(std::min<qint64>(rowCount - 1, lastRow + m_bufferSize));
+
+    // 如果可见区域没有变化，不需要更新
+    if (startRow == m_visibleStartRow && endRow == m_visibleEndRow)
+        return;
+
+    m_visibleStartRow = startRow;
+    m_visibleEndRow = endRow;
+    m_virtualModel->setVisibleRange(startRow, endRow);
+}
@@ -0,0 +1,284 @@
+#ifndef VIRTUALGRIDVIEW_H
+#define VIRTUALGRIDVIEW_H
+
+#include "VirtualTableDelegate.h"
+#include "VirtualTableModel.h"
+#include "VirtualScrollMapper.h"
+#include "VirtualSelectionModel.h"
+#include "VirtualViewHelper.h"
+#include "FrameStats.h"
+#include <QAbstractScrollArea>
+#include <QElapsedTimer>
+#include <QHeaderView>
+
+class VirtualGridRowHeader;
+
+/**
+ * @brief 固定行高的轻量级虚拟表格视图
+ *
+ * QTableView的垂直QHeaderView为每一行保存状态，并用int保存像素位置，
+ * 行数乘以行高超过int范围（20像素行高约1亿行）后就会溢出。
+ * 这个视图只针对行高统一的场景：可见行完全由算术计算得到，
+ * 垂直滚动位置使用64位像素偏移并映射到有限的滚动条范围，行号由视图自己绘制。
+ * 列仍使用QHeaderView管理，列数通常很少，不存在溢出问题。
+ */
+class VirtualGridView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit VirtualGridView(QWidget* parent = nullptr);
+    ~VirtualGridView() override;
+
+    /**
+     * @brief 设置虚拟表格模型
+     * @param model 虚拟表格模型指针
+     */
+    void setVirtualModel(VirtualTableModel* model);
+
+    /**
+     * @brief 获取虚拟表格模型
+     * @return 模型指针
+     */
+    VirtualTableModel* virtualModel() const;
+
+    /**
+     * @brief 获取列表头
+     * @return 水平表头
+     */
+    QHeaderView* horizontalHeader() const;
+
+    /**
+     * @brief 设置行高
+     * @param rowHeight 行高（像素）
+     */
+    void setRowHeight(int rowHeight);
+
+    /**
+     * @brief 获取行高
+     * @return 行高（像素）
+     */
+    int rowHeight() const;
+
+    /**
+     * @brief 设置缓冲区大小（行数）
+     * @param bufferSize 缓冲区大小
+     */
+    void setBufferSize(int bufferSize);
+
+    /**
+     * @brief 跳转到指定行，并将其放在视口中间
+     * @param rowIndex 目标行索引
+     */
+    void jumpToRow(int rowIndex);
+
+    /**
+     * @brief 按列值跳转，有列索引时立即跳转；没有索引时在后台用区间统计查找，找到后再跳转
+     * @param column 列索引，需先调用VirtualTableModel::buildColumnIndex()或buildZoneMap()
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 跳转到的行；在后台查找时返回VirtualTableModel::SearchPending，结果由模型的firstRowFound()通知；
+     *         没有索引和区间统计或找不到时返回-1
+     */
+    int jumpToValue(int column, const QString& value, ColumnIndex::Match match = ColumnIndex::Match::Equal);
+
+    /**
+     * @brief 获取当前垂直滚动偏移
+     * @return 64位像素偏移
+     */
+    qint64 scrollOffset() const;
+
+    /**
+     * @brief 设置垂直滚动偏移
+     * @param offset 64位像素偏移
+     */
+    void setScrollOffset(qint64 offset);
+
+    /**
+     * @brief 获取当前可见的起始行索引（含缓冲区）
+     * @return 起始行索引
+     */
+    int visibleStartRow() const;
+
+    /**
+     * @brief 获取当前可见的结束行索引（含缓冲区）
+     * @return 结束行索引
+     */
+    int visibleEndRow() const;
+
+    /**
+     * @brief 获取行区间选择模型
+     * @return 选择模型，未设置模型时返回nullptr
+     */
+    VirtualSelectionModel* virtualSelectionModel() const;
+
+    /**
+     * @brief 反选所有行
+     */
+    void invertSelection();
+
+    /**
+     * @brief 在后台抽样估算列宽并应用到列表头
+     *
+     * 设置模型时会自动调用一次，不需要加载全部数据
+     */
+    void resizeColumnsToSampledContents();
+
+    /**
+     * @brief 在后台把选中行以TSV格式复制到剪贴板，未选中时不复制
+     *
+     * 直接从数据源流式读取，不经过模型的块缓存，Ctrl+C会调用此方法；
+     * 超过TableExporter::MaxClipboardRows行时不复制，通过exporter()的finished()报告原因
+     */
+    void copySelection();
+
+    /**
+     * @brief 获取复制使用的导出器，可用于连接进度信号或取消复制
+     * @return 导出器
+     */
+    TableExporter* exporter() const;
+
+    /**
+     * @brief 启用或禁用逐帧性能统计
+     *
+     * 启用后模型会统计data()调用，每帧结束时记录绘制耗时、占位符和掉帧，
+     * 并输出到virtualtable.frames日志分类
+     * @param enabled 是否启用
+     */
+    void setFrameStatsEnabled(bool enabled);
+
+    /**
+     * @brief 是否启用了逐帧性能统计
+     * @return 是否启用
+     */
+    bool isFrameStatsEnabled() const;
+
+    /**
+     * @brief 设置是否在视口右上角显示性能叠加层（需要先启用统计）
+     * @param visible 是否显示
+     */
+    void setFrameStatsOverlayVisible(bool visible);
+
+    /**
+     * @brief 获取逐帧性能统计
+     * @return 统计对象
+     */
+    const FrameStats& frameStats() const;
+
+    /**
+     * @brief 输出绘制耗时直方图并清空统计
+     */
+    void dumpFrameStats();
+
+protected:
+    // 重写的事件处理方法
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private slots:
+    /**
+     * @brief 模型数据变化时重绘受影响的可见区域
+     */
+    void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+    /**
+     * @brief 模型重置后重新计算布局
+     */
+    void onModelReset();
+
+    /**
+     * @brief 重新计算表头、行号区域和滚动条
+     */
+    void updateGeometries();
+
+private:
+    friend class VirtualGridRowHeader;
+
+    /**
+     * @brief 绘制行号区域
+     * @param painter 绘制器
+     * @param rect 行号区域矩形
+     */
+    void paintRowNumbers(QPainter* painter, const QRect& rect) const;
+
+    /**
+     * @brief 计算行号区域宽度
+     * @return 宽度（像素）
+     */
+    int rowNumberWidth() const;
+
+    /**
+     * @brief 同步滚动映射的行数、行高和视口高度
+     */
+    void syncScrollMapper();
+
+    /**
+     * @brief 更新滚动条范围和步长
+     */
+    void updateScrollBars();
+
+    /**
+     * @brief 更新偏移并同步滚动条、行号区域和模型可见范围
+     * @param offset 新的像素偏移
+     * @param syncScrollBar 是否回写滚动条
+     */
+    void applyScrollOffset(qint64 offset, bool syncScrollBar);
+
+    /**
+     * @brief 根据当前偏移和预测的下一帧位置通知模型可见范围
+     */
+    void updateVisibleRange();
+
+    /**
+     * @brief 绘制可见单元格
+     * @param painter 视口的绘制器
+     * @param rect 需要重绘的区域
+     */
+    void paintCells(QPainter* painter, const QRect& rect);
+
+    /**
+     * @brief 清空统计，让当前模型按统计开关记录data()调用，并连接块加载和模型重置信号
+     */
+    void syncFrameCounters();
+
+    /**
+     * @brief 视口坐标所在的行
+     * @param y 视口纵坐标
+     * @return 行索引，超出数据范围时返回-1
+     */
+    int rowAt(int y) const;
+
+    // 私有成员变量
+    VirtualTableModel* m_virtualModel; // 虚拟表格模型
+    VirtualTableDelegate* m_delegate; // 单元格绘制代理
+    VirtualSelectionModel* m_selectionModel; // 行区间选择模型
+    int m_anchorRow; // Shift扩展选择的锚点行
+    VirtualViewHelper* m_helper; // 抽样列宽和复制选中行
+    QMetaObject::Connection m_pendingJump; // 等待后台按值查找结果的连接
+    QHeaderView* m_horizontalHeader; // 列表头
+    VirtualGridRowHeader* m_rowHeader; // 行号区域
+    int m_rowHeight; // 行高
+    int m_bufferSize; // 缓冲区大小（行数）
+    VirtualScrollMapper m_scrollMapper; // 64位偏移与滚动条值之间的映射
+    qint64 m_scrollOffset; // 64位垂直像素偏移
+    double m_scrollSpeed; // 当前滚动速度（像素/秒，向下为正）
+    bool m_syncingScrollBar; // 正在回写滚动条，忽略由此产生的滚动事件
+    bool m_visibleRangeDirty; // 可见范围是否需要在下一帧绘制前更新
+    int m_visibleStartRow; // 当前可见的起始行索引（含缓冲区）
+    int m_visibleEndRow; // 当前可见的结束行索引（含缓冲区）
+    QElapsedTimer m_scrollTimer; // 滚动时间计时器，用于计算滚动速度
+    FrameStats m_frameStats; // 逐帧性能统计
+    bool m_frameStatsEnabled; // 是否启用逐帧性能统计
+    bool m_frameStatsOverlayVisible; // 是否显示性能叠加层
+    QMetaObject::Connection m_blockLoadedConnection; // 块加载信号连接，用于统计滚动到数据的延迟
+    QMetaObject::Connection m_modelResetConnection; // 模型重置（更换数据源）信号连接，用于清空统计
+};
+
+#endif // VIRTUALGRIDVIEW_H
@@ -0,0 +1,100 @@
+#include "VirtualScrollMapper.h"
+#include <algorithm>
+#include <cmath>
+
+VirtualScrollMapper::VirtualScrollMapper()
+    : m_rowCount(0)
+    , m_rowHeight(1)
+    , m_viewportHeight(0)
+{
+}
+
+void VirtualScrollMapper::setRowCount(qint64 rowCount)
+{
+    m_rowCount = std::max<qint64>(0, rowCount);
+}
+
+void VirtualScrollMapper::setRowHeight(int rowHeight)
+{
+    m_rowHeight = std::max(1, rowHeight);
+}
+
+void VirtualScrollMapper::setViewportHeight(int viewportHeight)
+{
+    m_viewportHeight = std::max(0, viewportHeight);
+}
+
+int VirtualScrollMapper::rowHeight() const
+{
+    return m_rowHeight;
+}
+
+qint64 VirtualScrollMapper::contentHeight() const
+{
+    return m_rowCount * m_rowHeight;
+}
+
+qint64 VirtualScrollMapper::maxOffset() const
+{
+    return std::max<qint64>(0, contentHeight() - m_viewportHeight);
+}
+
+qint64 VirtualScrollMapper::clampOffset(qint64 offset) const
+{
+    return std::max<qint64>(0, std::min(offset, maxOffset()));
+}
+
+bool VirtualScrollMapper::isExact() const
+{
+    return maxOffset() <= MaxScrollBarValue;
+}
+
+int VirtualScrollMapper::maximumValue() const
+{
+    return isExact() ? static_cast<int>(maxOffset()) : MaxScrollBarValue;
+}
+
+int VirtualScrollMapper::pageStep() const
+{
+    if (isExact())
+        return m_viewportHeight;
+
+    double scale = static_cast<double>(MaxScrollBarValue) / maxOffset();
+    return std::max(1, static_cast<int>(m_viewportHeight * scale));
+}
+
+int VirtualScrollMapper::singleStep() const
+{
+    if (isExact())
+        return m_rowHeight;
+
+    double scale = static_cast<double>(MaxScrollBarValue) / maxOffset();
+    return std::max(1, static_cast<int>(m_rowHeight * scale));
+}
+
+int VirtualScrollMapper::valueForOffset(qint64 offset) const
+{
+    offset = clampOffset(offset);
+    if (isExact())
+        return static_cast<int>(offset);
+
+    return static_cast<int>(std::llround(static_cast<double>(offset) / maxOffset() * MaxScrollBarValue));
+}
+
+qint64 VirtualScrollMapper::offsetForValue(int value) const
+{
+    if (isExact())
+        return clampOffset(value);
+
+    return clampOffset(std::llround(static_cast<double>(value) / MaxScrollBarValue * maxOffset()));
+}
+
+qint64 VirtualScrollMapper::rowAtOffset(qint64 offset) const
+{
+    return std::max<qint64>(0, offset) / m_rowHeight;
+}
+
+qint64 VirtualScrollMapper::offsetForRow(qint64 row) const
+{
+    return row * m_rowHeight;
+}
@@ -0,0 +1,127 @@
+#ifndef VIRTUALSCROLLMAPPER_H
+#define VIRTUALSCROLLMAPPER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief 64位滚动坐标映射类
+ *
+ * QScrollBar的值是int，固定行高时行数乘以行高很容易超过int范围。
+ * 这个类维护64位的逻辑像素偏移，并把它映射到有限的滚动条范围：
+ * 内容高度在范围内时一个滚动条单位就是一个像素；超出后按比例缩放，
+ * 拖动滑块只能粗略定位，而滚轮、方向键等步进操作直接修改逻辑偏移，保持像素精确。
+ */
+class VirtualScrollMapper {
+public:
+    /**
+     * @brief 滚动条可表示的最大值，超过后按比例映射
+     */
+    static constexpr int MaxScrollBarValue = 1 << 30;
+
+    /**
+     * @brief 构造函数
+     */
+    VirtualScrollMapper();
+
+    /**
+     * @brief 设置总行数
+     * @param rowCount 总行数
+     */
+    void setRowCount(qint64 rowCount);
+
+    /**
+     * @brief 设置行高
+     * @param rowHeight 行高（像素）
+     */
+    void setRowHeight(int rowHeight);
+
+    /**
+     * @brief 设置视口高度
+     * @param viewportHeight 视口高度（像素）
+     */
+    void setViewportHeight(int viewportHeight);
+
+    /**
+     * @brief 获取行高
+     * @return 行高（像素）
+     */
+    int rowHeight() const;
+
+    /**
+     * @brief 内容总高度
+     * @return 64位像素高度
+     */
+    qint64 contentHeight() const;
+
+    /**
+     * @brief 最大滚动偏移
+     * @return 64位像素偏移
+     */
+    qint64 maxOffset() const;
+
+    /**
+     * @brief 把偏移限制在有效范围内
+     * @param offset 像素偏移
+     * @return 限制后的偏移
+     */
+    qint64 clampOffset(qint64 offset) const;
+
+    /**
+     * @brief 一个滚动条单位是否正好对应一个像素
+     * @return 是否为精确映射
+     */
+    bool isExact() const;
+
+    /**
+     * @brief 滚动条最大值
+     * @return 滚动条最大值
+     */
+    int maximumValue() const;
+
+    /**
+     * @brief 滚动条翻页步长（视口高度对应的滚动条单位）
+     * @return 翻页步长
+     */
+    int pageStep() const;
+
+    /**
+     * @brief 滚动条单步步长（一行对应的滚动条单位）
+     * @return 单步步长
+     */
+    int singleStep() const;
+
+    /**
+     * @brief 把逻辑偏移映射到滚动条值
+     * @param offset 像素偏移
+     * @return 滚动条值
+     */
+    int valueForOffset(qint64 offset) const;
+
+    /**
+     * @brief 把滚动条值映射回逻辑偏移（缩放时为粗粒度映射）
+     * @param value 滚动条值
+     * @return 像素偏移
+     */
+    qint64 offsetForValue(int value) const;
+
+    /**
+     * @brief 偏移所在的行
+     * @param offset 像素偏移
+     * @return 行索引
+     */
+    qint64 rowAtOffset(qint64 offset) const;
+
+    /**
+     * @brief 行顶部的偏移
+     * @param row 行索引
+     * @return 像素偏移
+     */
+    qint64 offsetForRow(qint64 row) const;
+
+private:
+    qint64 m_rowCount; // 总行数
+    int m_rowHeight; // 行高
+    int m_viewportHeight; // 视口高度
+};
+
+#endif // VIRTUALSCROLLMAPPER_H
@@ -0,0 +1,151 @@
+#include "VirtualSelectionModel.h"
+
+VirtualSelectionModel::VirtualSelectionModel(QAbstractItemModel* model, QObject* parent)
+    : QItemSelectionModel(model, parent)
+    , m_currentCommand(QItemSelectionModel::NoUpdate)
+{
+}
+
+void VirtualSelectionModel::select(const QModelIndex& index, QItemSelectionModel::SelectionFlags command)
+{
+    QItemSelection selection;
+    if (index.isValid())
+        selection.select(index, index);
+    select(selection, command);
+}
+
+void VirtualSelectionModel::select(const QItemSelection& selection, QItemSelectionModel::SelectionFlags command)
+{
+    if (command == QItemSelectionModel::NoUpdate)
+        return;
+
+    // 需要重绘的行：新选择、被替换的进行中选择，以及清除时的全部旧选择
+    RowRangeSet changed;
+    RowRangeSet rows;
+    for (const QItemSelectionRange& range : selection) {
+        if (!range.isValid())
+            continue;
+        rows.addRange(range.top(), range.bottom());
+        changed.addRange(range.top(), range.bottom());
+    }
+    for (const RowRangeSet::Range& range : m_currentRows.ranges())
+        changed.addRange(range.first, range.last);
+
+    if (command & QItemSelectionModel::Clear) {
+        for (const RowRangeSet::Range& range : m_rows.ranges())
+            changed.addRange(range.first, range.last);
+        m_rows.clear();
+        m_currentRows.clear();
+    }
+
+    // 与基类一致：不带Current的命令先确定上一次的进行中选择，本次选择成为新的进行中选择
+    if (!(command & QItemSelectionModel::Current))
+        commitCurrentSelection();
+
+    if (command & (QItemSelectionModel::Toggle | QItemSelectionModel::Select | QItemSelectionModel::Deselect)) {
+        m_currentRows = rows;
+        m_currentCommand = command;
+    } else {
+        m_currentRows.clear();
+    }
+
+    // 视图只用这两个参数计算刷新区域，这里把所有可能变化的行都作为selected发出
+    if (!changed.isEmpty())
+        emit selectionChanged(toItemSelection(changed), QItemSelection());
+}
+
+void VirtualSelectionModel::clear()
+{
+    select(QItemSelection(), QItemSelectionModel::Clear);
+    clearCurrentIndex();
+}
+
+void VirtualSelectionModel::reset()
+{
+    m_rows.clear();
+    m_currentRows.clear();
+    m_currentCommand = QItemSelectionModel::NoUpdate;
+    QItemSelectionModel::reset();
+}
+
+bool VirtualSelectionModel::containsRow(int row) const
+{
+    bool selected = m_rows.contains(row);
+    if (!m_currentRows.contains(row))
+        return selected;
+
+    if (m_currentCommand & QItemSelectionModel::Deselect)
+        return false;
+    if (m_currentCommand & QItemSelectionModel::Toggle)
+        return !selected;
+    return true;
+}
+
+qint64 VirtualSelectionModel::selectedRowCount() const
+{
+    return selectedRowSet().rowCount();
+}
+
+RowRangeSet VirtualSelectionModel::selectedRowSet() const
+{
+    if (m_currentRows.isEmpty())
+        return m_rows;
+
+    RowRangeSet rows = m_rows;
+    for (const RowRangeSet::Range& range : m_currentRows.ranges())
+        applyRange(rows, range.first, range.last, m_currentCommand);
+    return rows;
+}
+
+void VirtualSelectionModel::selectAllRows()
+{
+    if (!model() || model()->rowCount() <= 0)
+        return;
+
+    QItemSelection selection;
+    selection.select(model()->index(0, 0), model()->index(model()->rowCount() - 1, 0));
+    select(selection, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+}
+
+void VirtualSelectionModel::invertSelection()
+{
+    if (!model() || model()->rowCount() <= 0)
+        return;
+
+    commitCurrentSelection();
+    m_rows.invert(model()->rowCount());
+
+    RowRangeSet all;
+    all.addRange(0, model()->rowCount() - 1);
+    emit selectionChanged(toItemSelection(all), QItemSelection());
+}
+
+void VirtualSelectionModel::commitCurrentSelection()
+{
+    for (const RowRangeSet::Range& range : m_currentRows.ranges())
+        applyRange(m_rows, range.first, range.last, m_currentCommand);
+    m_currentRows.clear();
+    m_currentCommand = QItemSelectionModel::NoUpdate;
+}
+
+void VirtualSelectionModel::applyRange(RowRangeSet& rows, int first, int last, QItemSelectionModel::SelectionFlags command)
+{
+    if (command & QItemSelectionModel::Deselect)
+        rows.removeRange(first, last);
+    else if (command & QItemSelectionModel::Toggle)
+        rows.toggleRange(first, last);
+    else if (command & QItemSelectionModel::Select)
+        rows.addRange(first, last);
+}
+
+QItemSelection VirtualSelectionModel::toItemSelection(const RowRangeSet& rows) const
+{
+    QItemSelection selection;
+    if (!model())
+        return selection;
+
+    int lastColumn = qMax(0, model()->columnCount() - 1);
+    for (const RowRangeSet::Range& range : rows.ranges())
+        selection.select(model()->index(range.first, 0), model()->index(range.last, lastColumn));
+    return selection;
+}
@@ -0,0 +1,107 @@
+#ifndef VIRTUALSELECTIONMODEL_H
+#define VIRTUALSELECTIONMODEL_H
+
+#include "RowRangeSet.h"
+#include <QItemSelectionModel>
+
+/**
+ * @brief 按行区间保存选择的选择模型
+ *
+ * QItemSelectionModel把选择保存为QItemSelectionRange列表，查询时逐个比较，
+ * 全选后按住Ctrl点选、反选等操作会让区间数和查询代价一起膨胀。
+ * 这个类接管select()，只在RowRangeSet中记录整行选择，不再写入基类的区间列表，
+ * 因此基类的isSelected()、selectedRows()等非虚函数不反映选择状态，
+ * 需要使用containsRow()、selectedRowSet()查询。
+ */
+class VirtualSelectionModel : public QItemSelectionModel {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param model 数据模型
+     * @param parent 父对象
+     */
+    explicit VirtualSelectionModel(QAbstractItemModel* model, QObject* parent = nullptr);
+
+    /**
+     * @brief 选择单个索引所在的行
+     * @param index 模型索引
+     * @param command 选择命令
+     */
+    void select(const QModelIndex& index, QItemSelectionModel::SelectionFlags command) override;
+
+    /**
+     * @brief 选择区间覆盖的所有行
+     * @param selection 选择区间
+     * @param command 选择命令
+     */
+    void select(const QItemSelection& selection, QItemSelectionModel::SelectionFlags command) override;
+
+    /**
+     * @brief 清除选择和当前索引
+     */
+    void clear() override;
+
+    /**
+     * @brief 重置选择模型（不发送信号）
+     */
+    void reset() override;
+
+    /**
+     * @brief 判断行是否被选中，O(log n)
+     * @param row 行索引
+     * @return 是否被选中
+     */
+    bool containsRow(int row) const;
+
+    /**
+     * @brief 选中的总行数
+     * @return 行数
+     */
+    qint64 selectedRowCount() const;
+
+    /**
+     * @brief 获取选中行的区间集合
+     * @return 行区间集合
+     */
+    RowRangeSet selectedRowSet() const;
+
+    /**
+     * @brief 选中所有行
+     */
+    void selectAllRows();
+
+    /**
+     * @brief 反选
+     */
+    void invertSelection();
+
+private:
+    /**
+     * @brief 把进行中的选择（拖动、Shift扩展）合并到已确定的选择
+     */
+    void commitCurrentSelection();
+
+    /**
+     * @brief 按选择命令把行区间应用到集合
+     * @param rows 目标集合
+     * @param first 起始行
+     * @param last 结束行（包含）
+     * @param command 选择命令
+     */
+    static void applyRange(RowRangeSet& rows, int first, int last, QItemSelectionModel::SelectionFlags command);
+
+    /**
+     * @brief 把行区间集合转换为整行的QItemSelection，用于通知视图刷新
+     * @param rows 行区间集合
+     * @return 选择区间
+     */
+    QItemSelection toItemSelection(const RowRangeSet& rows) const;
+
+    RowRangeSet m_rows; // 已确定的选择
+    RowRangeSet m_currentRows; // 进行中的选择
+    QItemSelectionModel::SelectionFlags m_currentCommand; // 进行中选择的命令
+};
+
+#endif // VIRTUALSELECTIONMODEL_H
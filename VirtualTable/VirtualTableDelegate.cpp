@@ -0,0 +1,152 @@
+#include "VirtualTableDelegate.h"
+#include "VirtualSelectionModel.h"
+#include "VirtualTableModel.h"
+#include <QApplication>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QStyle>
+
+VirtualTableDelegate::VirtualTableDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+    , m_selectionModel(nullptr)
+    , m_lastVirtualModel(nullptr)
+    , m_fontHeight(0)
+    , m_textMargin(-1)
+{
+    // 默认缓存2万个单元格，足够覆盖几个满屏（100x40）的重绘
+    m_textCache.setMaxCost(20000);
+}
+
+VirtualTableDelegate::~VirtualTableDelegate()
+{
+}
+
+void VirtualTableDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+    const QModelIndex& index) const
+{
+    // 非普通单元格交给样式引擎处理
+    const VirtualTableModel* model = plainCellModel(index);
+    if (!model) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    syncFont(option.font);
+
+    const QWidget* widget = option.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+
+    // 文本边距与QCommonStyle保持一致，只在首次绘制时读取
+    if (m_textMargin < 0) {
+        m_textMargin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    }
+
+    // 计算调色板颜色组
+    QPalette::ColorGroup group = QPalette::Disabled;
+    if (option.state & QStyle::State_Enabled) {
+        group = (option.state & QStyle::State_Active) ? QPalette::Normal : QPalette::Inactive;
+    }
+
+    // 选中背景直接填充，交替行背景已由视图绘制
+    // 行区间选择不写入QItemSelectionModel的区间列表，视图给出的State_Selected不完整，需要再查一次
+    const bool selected = (option.state & QStyle::State_Selected)
+        || (m_selectionModel && m_selectionModel->containsRow(index.row()));
+    // 条件格式样式在加载线程中已算好，这里只查表
+    const ConditionalFormat::Style* cellStyle = selected ? nullptr : model->cellStyle(index.row(), index.column());
+    if (selected) {
+        painter->fillRect(option.rect, option.palette.brush(group, QPalette::Highlight));
+    } else if (cellStyle && cellStyle->background.isValid()) {
+        painter->fillRect(option.rect, cellStyle->background);
+    }
+
+    // 绘制缓存的文本：直接引用块内的显示文本，不经过QVariant，也不复制字符串
+    static const QString placeholder = QStringLiteral("......");
+    const QString* displayText = model->displayText(index.row(), index.column());
+    const QString& text = displayText ? *displayText : placeholder;
+    QRect textRect = option.rect.adjusted(m_textMargin, 0, -m_textMargin, 0);
+    if (!text.isEmpty() && textRect.width() > 0) {
+        const QStaticText& staticText = cachedText(index, text, textRect.width(), option);
+        if (cellStyle && cellStyle->foreground.isValid()) {
+            painter->setPen(cellStyle->foreground);
+        } else {
+            painter->setPen(option.palette.color(group, selected ? QPalette::HighlightedText : QPalette::Text));
+        }
+        painter->setFont(option.font);
+        int y = textRect.top() + (textRect.height() - m_fontHeight) / 2;
+        painter->drawStaticText(textRect.left(), y, staticText);
+    }
+
+    // 焦点框只出现在一个单元格上，仍使用样式绘制
+    if (option.state & QStyle::State_HasFocus) {
+        QStyleOptionFocusRect focusOption;
+        focusOption.QStyleOption::operator=(option);
+        focusOption.state |= QStyle::State_KeyboardFocusChange;
+        focusOption.backgroundColor = option.palette.color(group, selected ? QPalette::Highlight : QPalette::Window);
+        style->drawPrimitive(QStyle::PE_FrameFocusRect, &focusOption, painter, widget);
+    }
+}
+
+void VirtualTableDelegate::setCacheCapacity(int cellCount)
+{
+    if (cellCount > 0) {
+        m_textCache.setMaxCost(cellCount);
+    }
+}
+
+void VirtualTableDelegate::clearCache()
+{
+    m_textCache.clear();
+}
+
+void VirtualTableDelegate::setSelectionModel(const VirtualSelectionModel* selectionModel)
+{
+    m_selectionModel = selectionModel;
+}
+
+const VirtualTableModel* VirtualTableDelegate::plainCellModel(const QModelIndex& index) const
+{
+    if (index.model() != m_lastModel) {
+        m_lastModel = index.model();
+        m_lastVirtualModel = qobject_cast<const VirtualTableModel*>(m_lastModel.data());
+    }
+    return m_lastVirtualModel;
+}
+
+void VirtualTableDelegate::syncFont(const QFont& font) const
+{
+    if (m_fontHeight > 0 && font == m_cacheFont)
+        return;
+
+    // 字体变化后所有排版结果都失效
+    m_cacheFont = font;
+    m_fontHeight = QFontMetrics(font).height();
+    m_textCache.clear();
+}
+
+const QStaticText& VirtualTableDelegate::cachedText(const QModelIndex& index, const QString& text,
+    int width, const QStyleOptionViewItem& option) const
+{
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(index.row())) << 32)
+        | static_cast<quint32>(index.column());
+
+    // 文本和列宽都未变化时直接复用
+    CachedText* entry = m_textCache.object(key);
+    if (entry && entry->width == width && entry->text == text) {
+        return entry->staticText;
+    }
+
+    // 重新省略并排版
+    QFontMetrics metrics(option.font);
+    QString elided = metrics.elidedText(text, option.textElideMode, width);
+
+    entry = new CachedText;
+    entry->text = text;
+    entry->width = width;
+    entry->staticText.setText(elided);
+    entry->staticText.setTextFormat(Qt::PlainText);
+    entry->staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    entry->staticText.prepare(QTransform(), option.font);
+    m_textCache.insert(key, entry);
+
+    return entry->staticText;
+}
@@ -0,0 +1,99 @@
+#ifndef VIRTUALTABLEDELEGATE_H
+#define VIRTUALTABLEDELEGATE_H
+
+#include <QCache>
+#include <QFont>
+#include <QPointer>
+#include <QStaticText>
+#include <QString>
+#include <QStyledItemDelegate>
+
+class VirtualSelectionModel;
+class VirtualTableModel;
+
+/**
+ * @brief 虚拟表格专用的高性能单元格绘制代理
+ *
+ * 默认的QStyledItemDelegate每次重绘都会经过样式引擎、QTextLayout排版和省略号计算。
+ * 这个代理对普通文本单元格走快速路径：按（单元格，列宽）缓存已排版的QStaticText，
+ * 只在列宽或文本变化时重新计算省略号，其余情况直接绘制缓存结果。
+ * 非VirtualTableModel提供的单元格仍交给QStyledItemDelegate处理。
+ */
+class VirtualTableDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit VirtualTableDelegate(QObject* parent = nullptr);
+    ~VirtualTableDelegate() override;
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+        const QModelIndex& index) const override;
+
+    /**
+     * @brief 设置文本缓存容量
+     * @param cellCount 最多缓存的单元格数
+     */
+    void setCacheCapacity(int cellCount);
+
+    /**
+     * @brief 清空文本缓存
+     */
+    void clearCache();
+
+    /**
+     * @brief 设置行区间选择模型，绘制时按行查询选中状态
+     * @param selectionModel 选择模型，为nullptr时只使用视图提供的选中状态
+     */
+    void setSelectionModel(const VirtualSelectionModel* selectionModel);
+
+private:
+    /**
+     * @brief 缓存的单元格文本
+     */
+    struct CachedText {
+        QString text; // 原始文本，用于检测数据变化
+        int width; // 排版时的可用宽度
+        QStaticText staticText; // 省略后的已排版文本
+    };
+
+    /**
+     * @brief 获取可以走快速绘制路径的模型
+     *
+     * VirtualTableModel只提供纯文本数据，没有图标、复选框等需要样式引擎的元素，
+     * 它的单元格直接读取块内预先生成的显示文本
+     * @param index 模型索引
+     * @return 模型指针，不是VirtualTableModel时返回nullptr
+     */
+    const VirtualTableModel* plainCellModel(const QModelIndex& index) const;
+
+    /**
+     * @brief 字体变化时重置缓存和字体度量
+     * @param font 当前绘制字体
+     */
+    void syncFont(const QFont& font) const;
+
+    /**
+     * @brief 获取单元格的已排版文本，必要时重新省略和排版
+     * @param index 模型索引
+     * @param text 单元格文本
+     * @param width 可用宽度
+     * @param option 样式选项
+     * @return 已排版文本
+     */
+    const QStaticText& cachedText(const QModelIndex& index, const QString& text,
+        int width, const QStyleOptionViewItem& option) const;
+
+    const VirtualSelectionModel* m_selectionModel; // 行区间选择模型
+    mutable QCache<quint64, CachedText> m_textCache; // 单元格文本缓存，键为（行，列）
+    mutable QPointer<const QAbstractItemModel> m_lastModel; // 上一次判断过的模型，避免每个单元格都做qobject_cast
+    mutable const VirtualTableModel* m_lastVirtualModel; // m_lastModel对应的VirtualTableModel
+    mutable QFont m_cacheFont; // 缓存对应的字体
+    mutable int m_fontHeight; // 缓存字体的行高
+    mutable int m_textMargin; // 文本左右边距，首次绘制时从样式读取
+};
+
+#endif // VIRTUALTABLEDELEGATE_H
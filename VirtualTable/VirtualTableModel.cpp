@@ -15,21 +15,34 @@ VirtualTableModel::VirtualTableModel(QObject* parent)
     , m_scrollSpeed(0.0)
     , m_preloadBlocksAhead(2)
     , m_preloadBlocksBehind(1)
+    , m_loadGeneration(0)
+    , m_loadThroughput(0.0)
+    , m_formatGeneration(0)
+    , m_frameCountersEnabled(false)
+    , m_zoneMapTask(nullptr)
+    , m_searchTask(nullptr)
+    , m_searchCancelled(std::make_shared<std::atomic<bool>>(false))
+    , m_loadAllTask(nullptr)
+    , m_indexCancelled(std::make_shared<std::atomic<bool>>(false))
 {
     // 根据预加载策略初始化预加载块数
     updatePreloadBlockCounts();
+
+    // 高优先级线程池只用于可见区域和惯性滚动目标
+    m_priorityPool.setMaxThreadCount(2);
+    m_loadClock.start();
 }
 
 VirtualTableModel::~VirtualTableModel()
 {
+    // 流水线不引用模型，取消后在后台自行退出
+    cancelLoadAll();
+
     // 取消所有正在进行的加载任务
-    for (auto it = m_loadTasks.begin(); it != m_loadTasks.end(); ++it) {
-        if (it.value() && it.value()->isRunning()) {
-            it.value()->cancel();
-            delete it.value();
-        }
-    }
-    m_loadTasks.clear();
+    cancelLoadTasks();
+
+    // 线程池析构时等待索引任务结束，先让它们尽快退出
+    m_indexCancelled->store(true);
 }
 
 int VirtualTableModel::rowCount(const QModelIndex& parent) const
@@ -47,6 +60,24 @@ int VirtualTableModel::columnCount(const QModelIndex& parent) const
 }
 
 QVariant VirtualTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!m_frameCountersEnabled)
+        return cellData(index, role, nullptr);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool placeholder = false;
+    QVariant value = cellData(index, role, &placeholder);
+
+    ++m_frameCounters.dataCalls;
+    m_frameCounters.dataNs += timer.nsecsElapsed();
+    if (placeholder) {
+        ++m_frameCounters.placeholders;
+    }
+    return value;
+}
+
+QVariant VirtualTableModel::cellData(const QModelIndex& index, int role, bool* placeholder) const
 {
     if (!index.isValid() || !m_dataSource)
         return QVariant();
@@ -57,6 +88,15 @@ QVariant VirtualTableModel::data(const QModelIndex& index, int role) const
     if (row < 0 || row >= m_dataSource->rowCount() || col < 0 || col >= m_dataSource->columnCount())
         return QVariant();
 
+    if (role == Qt::BackgroundRole || role == Qt::ForegroundRole) {
+        // 条件格式已在加载线程中算好，这里只查表
+        const ConditionalFormat::Style* style = cellStyle(row, col);
+        if (!style)
+            return QVariant();
+        const QColor& color = (role == Qt::BackgroundRole) ? style->background : style->foreground;
+        return color.isValid() ? QVariant(color) : QVariant();
+    }
+
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         // 获取数据所在的块
         int blockIndex = getBlockIndex(row);
@@ -71,18 +111,20 @@ QVariant VirtualTableModel::data(const QModelIndex& index, int role) const
                 DataBlock& block = const_cast<DataBlock&>(it.value());
                 block.lastAccessTime = QDateTime::currentMSecsSinceEpoch();
 
-                // 返回数据
-                if (rowInBlock < block.data.size()) {
-                    const QList<QVariant>& rowData = block.data[rowInBlock];
-                    if (col < rowData.size()) {
-                        return rowData[col];
-                    }
+                // 块只保留格式化后的显示文本，编辑角色也返回它
+                int offset = rowInBlock * block.columnCount + col;
+                if (col < block.columnCount && offset < block.displayText.size()) {
+                    return block.displayText[offset];
                 }
+                return QVariant();
             }
         }
 
         // 如果块未加载，触发加载并返回占位符
         const_cast<VirtualTableModel*>(this)->loadBlock(blockIndex, true);
+        if (placeholder) {
+            *placeholder = true;
+        }
         return QString("......");
     }
 
@@ -114,9 +156,12 @@ QVariant VirtualTableModel::headerData(int section, Qt::Orientation orientation,
 void VirtualTableModel::setDataSource(std::shared_ptr<DataSource> source)
 {
     beginResetModel();
+    cancelLoadTasks();
     m_dataSource = source;
     m_dataBlocks.clear();
-    m_loadTasks.clear();
+    cancelIndexTasks();
+    cancelLoadAll();
+    m_frameCounters = FrameCounters(); // 旧数据源的统计不计入新表
     endResetModel();
 
     emit loadingStatusChanged(LoadingStatus::Idle);
@@ -129,9 +174,9 @@ void VirtualTableModel::setBlockSize(int blockSize)
 
     if (blockSize != m_blockSize) {
         beginResetModel();
+        cancelLoadTasks();
         m_blockSize = blockSize;
         m_dataBlocks.clear();
-        m_loadTasks.clear();
         endResetModel();
     }
 }
@@ -239,27 +284,552 @@ void VirtualTableModel::setScrollSpeed(double speed)
     }
 }
 
-void VirtualTableModel::onBlockLoaded(int blockIndex, const QList<QList<QVariant>>& data)
+void VirtualTableModel::prefetchRows(int startRow, int endRow)
 {
     if (!m_dataSource)
         return;
 
+    startRow = std::max(0, startRow);
+    endRow = std::min(m_dataSource->rowCount() - 1, endRow);
+    if (startRow > endRow)
+        return;
+
+    for (int blockIndex = getBlockIndex(startRow); blockIndex <= getBlockIndex(endRow); ++blockIndex) {
+        loadBlock(blockIndex, true);
+    }
+}
+
+std::shared_ptr<DataSource> VirtualTableModel::dataSource() const
+{
+    return m_dataSource;
+}
+
+double VirtualTableModel::loadThroughput() const
+{
+    return m_loadThroughput;
+}
+
+bool VirtualTableModel::loadAll(qint64 memoryBudget)
+{
+    if (!m_dataSource || memoryBudget <= 0)
+        return false;
+    if (m_loadAllTask || isFullyLoaded())
+        return true;
+
+    std::shared_ptr<DataSource> source = m_dataSource;
+    auto cache = std::make_shared<ColumnarCache>(source->rowCount(), source->columnCount(), memoryBudget);
+    m_tableCache = cache;
+
+    // 进度和取消都通过任务状态传递，后台线程不引用模型
+    QFutureInterface<bool> task;
+    task.setProgressRange(0, 100);
+    task.reportStarted();
+
+    m_loadAllTask = new QFutureWatcher<bool>(this);
+    connect(m_loadAllTask, &QFutureWatcher<bool>::finished, this, &VirtualTableModel::onLoadAllFinished);
+    connect(m_loadAllTask, &QFutureWatcher<bool>::progressValueChanged, this, &VirtualTableModel::loadingProgress);
+    setLoadingStatus(LoadingStatus::LoadingAll);
+    emit loadingProgress(0);
+    m_loadAllTask->setFuture(task.future());
+
+    QtConcurrent::run([source, cache, task]() mutable {
+        const bool success = runLoadAll(source, cache, task);
+        task.reportResult(success);
+        task.reportFinished();
+    });
+    return true;
+}
+
+void VirtualTableModel::cancelLoadTasks()
+{
+    // 加载线程只持有数据源的副本，不必等待；断开后旧结果不会再写入新表的块
+    for (auto it = m_loadTasks.begin(); it != m_loadTasks.end(); ++it) {
+        if (it.value()) {
+            disconnect(it.value(), nullptr, this, nullptr);
+            it.value()->cancel();
+            it.value()->deleteLater();
+        }
+    }
+    m_loadTasks.clear();
+    m_loadStartTimes.clear();
+    ++m_loadGeneration;
+}
+
+void VirtualTableModel::cancelLoadAll()
+{
+    if (m_loadAllTask) {
+        // 不等待流水线退出，断开后它的结果到达时直接丢弃
+        m_loadAllTask->cancel();
+        disconnect(m_loadAllTask, nullptr, this, nullptr);
+        m_loadAllTask->deleteLater();
+        m_loadAllTask = nullptr;
+        setLoadingStatus(LoadingStatus::Idle);
+    }
+    m_tableCache.reset();
+}
+
+bool VirtualTableModel::isFullyLoaded() const
+{
+    return !m_loadAllTask && m_tableCache && m_tableCache->isComplete();
+}
+
+bool VirtualTableModel::runLoadAll(std::shared_ptr<DataSource> source, std::shared_ptr<ColumnarCache> cache,
+    QFutureInterface<bool>& task)
+{
+    const int rowCount = source->rowCount();
+    const int chunkCount = (rowCount + ColumnarCache::ChunkRows - 1) / ColumnarCache::ChunkRows;
+
+    // 两级流水线：转换当前段时，下一段已经在另一个线程中读取
+    auto fetch = [source, rowCount](int chunk) {
+        return QtConcurrent::run([source, rowCount, chunk]() {
+            const int startRow = chunk * ColumnarCache::ChunkRows;
+            return source->loadData(startRow, std::min(ColumnarCache::ChunkRows, rowCount - startRow));
+        });
+    };
+
+    QFuture<QList<QList<QVariant>>> pending;
+    if (chunkCount > 0) {
+        pending = fetch(0);
+    }
+
+    int lastProgress = 0;
+    bool ok = true;
+    for (int chunk = 0; chunk < chunkCount && ok; ++chunk) {
+        const QList<QList<QVariant>> rows = pending.result();
+        if (task.isCanceled()) {
+            ok = false;
+            break;
+        }
+        if (chunk + 1 < chunkCount) {
+            pending = fetch(chunk + 1);
+        }
+
+        ok = cache->storeChunk(chunk, rows);
+
+        int progress = static_cast<int>((chunk + 1) * 100LL / chunkCount);
+        if (progress != lastProgress) {
+            lastProgress = progress;
+            task.setProgressValue(progress);
+        }
+    }
+
+    // 取消或出错时可能还有一段在读取
+    pending.waitForFinished();
+    return ok && !task.isCanceled();
+}
+
+void VirtualTableModel::onLoadAllFinished()
+{
+    const bool success = m_loadAllTask->result();
+    m_loadAllTask->deleteLater();
+    m_loadAllTask = nullptr;
+
+    // 失败时释放不完整的缓存
+    if (!success) {
+        m_tableCache.reset();
+    }
+    setLoadingStatus(LoadingStatus::Idle);
+}
+
+const QString* VirtualTableModel::displayText(int row, int column) const
+{
+    if (!m_dataSource || row < 0 || column < 0)
+        return nullptr;
+
+    QElapsedTimer timer;
+    if (m_frameCountersEnabled) {
+        timer.start();
+        ++m_frameCounters.dataCalls;
+    }
+
+    const QString* text = nullptr;
+    int blockIndex = getBlockIndex(row);
+    {
+        QMutexLocker locker(&m_dataMutex);
+        auto it = m_dataBlocks.constFind(blockIndex);
+        if (it != m_dataBlocks.constEnd() && it.value().isValid) {
+            const DataBlock& block = it.value();
+            int rowInBlock = row - block.startRow;
+            if (column < block.columnCount) {
+                int offset = rowInBlock * block.columnCount + column;
+                if (offset >= 0 && offset < block.displayText.size()) {
+                    text = &block.displayText[offset];
+                }
+            }
+        }
+    }
+
+    if (!text && row < m_dataSource->rowCount()) {
+        const_cast<VirtualTableModel*>(this)->loadBlock(blockIndex, true);
+        if (m_frameCountersEnabled) {
+            ++m_frameCounters.placeholders;
+        }
+    }
+
+    if (m_frameCountersEnabled) {
+        m_frameCounters.dataNs += timer.nsecsElapsed();
+    }
+    return text;
+}
+
+void VirtualTableModel::buildDisplayText(DataBlock& block, const QList<QList<QVariant>>& rows, const QVector<ColumnFormat>& formats)
+{
+    int columnCount = 0;
+    for (const QList<QVariant>& row : rows) {
+        columnCount = std::max(columnCount, row.size());
+    }
+
+    // 行优先连续存放，绘制时按偏移直接取用
+    block.columnCount = columnCount;
+    block.displayText.clear();
+    block.displayText.resize(rows.size() * columnCount);
+    QString* out = block.displayText.data();
+    for (int column = 0; column < columnCount; ++column) {
+        // 每列的格式准备工作只做一次，再对整列批量格式化
+        const ColumnFormat format = column < formats.size() ? formats[column] : ColumnFormat();
+        format.formatColumn(rows, column, out + column, columnCount);
+    }
+}
+
+void VirtualTableModel::buildStyleIndices(DataBlock& block, const QList<QList<QVariant>>& rows, const ConditionalFormat& format)
+{
+    // 没有规则时不占用内存
+    if (format.isEmpty()) {
+        block.styleIndices.clear();
+        return;
+    }
+
+    block.styleIndices.fill(0, rows.size() * block.columnCount);
+    format.evaluate(rows, block.columnCount, block.styleIndices.data());
+}
+
+void VirtualTableModel::setConditionalFormat(const ConditionalFormat& format)
+{
+    m_conditionalFormat = format;
+    ++m_formatGeneration;
+
+    reloadStaleBlocks();
+}
+
+const ConditionalFormat& VirtualTableModel::conditionalFormat() const
+{
+    return m_conditionalFormat;
+}
+
+const ConditionalFormat::Style* VirtualTableModel::cellStyle(int row, int column) const
+{
+    if (m_conditionalFormat.isEmpty() || row < 0 || column < 0)
+        return nullptr;
+
+    QMutexLocker locker(&m_dataMutex);
+    auto it = m_dataBlocks.constFind(getBlockIndex(row));
+    if (it == m_dataBlocks.constEnd() || !it.value().isValid)
+        return nullptr;
+
+    const DataBlock& block = it.value();
+    if (column >= block.columnCount)
+        return nullptr;
+
+    int offset = (row - block.startRow) * block.columnCount + column;
+    if (offset < 0 || offset >= block.styleIndices.size())
+        return nullptr;
+
+    return m_conditionalFormat.style(block.styleIndices[offset]);
+}
+
+bool VirtualTableModel::buildColumnIndex(int column)
+{
+    if (!m_dataSource || column < 0 || column >= m_dataSource->columnCount())
+        return false;
+    if (m_columnIndexes.contains(column) || m_indexTasks.contains(column))
+        return true;
+
+    std::shared_ptr<DataSource> source = m_dataSource;
+    std::shared_ptr<std::atomic<bool>> cancelled = m_indexCancelled;
+    QThreadPool* pool = &m_indexPool;
+
+    auto watcher = new QFutureWatcher<std::shared_ptr<ColumnIndex>>(this);
+    m_indexTasks.insert(column, watcher);
+    connect(watcher, &QFutureWatcher<std::shared_ptr<ColumnIndex>>::finished, this, [this, column, watcher]() {
+        m_indexTasks.remove(column);
+        std::shared_ptr<ColumnIndex> index = watcher->result();
+        watcher->deleteLater();
+        if (index) {
+            m_columnIndexes.insert(column, index);
+        }
+        emit columnIndexReady(column, index != nullptr);
+    });
+
+    watcher->setFuture(QtConcurrent::run(pool, [source, column, cancelled, pool]() {
+        // 数据源文件旁边有未过期的索引时直接读取
+        const QString path = source->persistentPath();
+        const int rowCount = source->rowCount();
+        std::shared_ptr<ColumnIndex> index = ColumnIndex::load(path, column, rowCount);
+        if (index)
+            return index;
+
+        index = ColumnIndex::build(source, column, pool, *cancelled);
+        if (index && !path.isEmpty()) {
+            index->save(path, rowCount);
+        }
+        return index;
+    }));
+    return true;
+}
+
+std::shared_ptr<const ColumnIndex> VirtualTableModel::columnIndex(int column) const
+{
+    return m_columnIndexes.value(column);
+}
+
+bool VirtualTableModel::isBuildingColumnIndex(int column) const
+{
+    return m_indexTasks.contains(column);
+}
+
+bool VirtualTableModel::buildZoneMap()
+{
+    if (!m_dataSource)
+        return false;
+    if (m_zoneMap || m_zoneMapTask)
+        return true;
+
+    std::shared_ptr<DataSource> source = m_dataSource;
+    std::shared_ptr<std::atomic<bool>> cancelled = m_indexCancelled;
+    QThreadPool* pool = &m_indexPool;
+
+    m_zoneMapTask = new QFutureWatcher<std::shared_ptr<ZoneMap>>(this);
+    connect(m_zoneMapTask, &QFutureWatcher<std::shared_ptr<ZoneMap>>::finished, this, [this]() {
+        std::shared_ptr<ZoneMap> zoneMap = m_zoneMapTask->result();
+        m_zoneMapTask->deleteLater();
+        m_zoneMapTask = nullptr;
+        m_zoneMap = zoneMap;
+        emit zoneMapReady(zoneMap != nullptr);
+    });
+
+    m_zoneMapTask->setFuture(QtConcurrent::run(pool, [source, cancelled, pool]() {
+        // 数据源文件旁边有未过期的统计时直接读取
+        const QString path = source->persistentPath();
+        std::shared_ptr<ZoneMap> zoneMap = ZoneMap::load(path, source->rowCount(), source->columnCount());
+        if (zoneMap)
+            return zoneMap;
+
+        zoneMap = ZoneMap::build(source, pool, *cancelled);
+        if (zoneMap && !path.isEmpty()) {
+            zoneMap->save(path);
+        }
+        return zoneMap;
+    }));
+    return true;
+}
+
+void VirtualTableModel::setZoneMap(std::shared_ptr<const ZoneMap> zoneMap)
+{
+    if (!m_dataSource || !zoneMap || zoneMap->rowCount() != m_dataSource->rowCount()
+        || zoneMap->columnCount() != m_dataSource->columnCount())
+        return;
+
+    m_zoneMap = zoneMap;
+}
+
+std::shared_ptr<const ZoneMap> VirtualTableModel::zoneMap() const
+{
+    return m_zoneMap;
+}
+
+int VirtualTableModel::findFirstRow(int column, const QString& value, ColumnIndex::Match match) const
+{
+    if (!m_dataSource || column < 0 || column >= m_dataSource->columnCount())
+        return -1;
+
+    std::shared_ptr<const ColumnIndex> index = columnIndex(column);
+    return index ? index->findFirstRow(value, match) : -1;
+}
+
+bool VirtualTableModel::searchFirstRow(int column, const QString& value, ColumnIndex::Match match)
+{
+    if (!m_dataSource || column < 0 || column >= m_dataSource->columnCount())
+        return false;
+
+    std::shared_ptr<const ColumnIndex> index = columnIndex(column);
+    std::shared_ptr<const ZoneMap> zoneMap = m_zoneMap;
+    if (!index && !zoneMap)
+        return false;
+
+    // 只保留最新的查找
+    if (m_searchTask) {
+        m_searchCancelled->store(true);
+        disconnect(m_searchTask, nullptr, this, nullptr);
+        m_searchTask->deleteLater();
+    }
+    m_searchCancelled = std::make_shared<std::atomic<bool>>(false);
+
+    std::shared_ptr<DataSource> source = m_dataSource;
+    std::shared_ptr<std::atomic<bool>> cancelled = m_indexCancelled;
+    std::shared_ptr<std::atomic<bool>> searchCancelled = m_searchCancelled;
+
+    m_searchTask = new QFutureWatcher<int>(this);
+    connect(m_searchTask, &QFutureWatcher<int>::finished, this, [this, column]() {
+        const int row = m_searchTask->result();
+        m_searchTask->deleteLater();
+        m_searchTask = nullptr;
+        emit firstRowFound(column, row);
+    });
+
+    m_searchTask->setFuture(QtConcurrent::run(&m_indexPool, [source, index, zoneMap, column, value, match, cancelled, searchCancelled]() {
+        if (index)
+            return index->findFirstRow(value, match);
+
+        // 按行号顺序只读取可能匹配的段，遇到第一个匹配即返回
+        const RowRangeSet candidates = zoneMap->candidateRows(column, value, match);
+        for (const RowRangeSet::Range& range : candidates.ranges()) {
+            for (qint64 start = range.first; start <= range.last; start += ZoneMap::ZoneRows) {
+                if (*cancelled || *searchCancelled)
+                    return -1;
+                const int count = static_cast<int>(std::min<qint64>(ZoneMap::ZoneRows, range.last - start + 1));
+                const QList<QList<QVariant>> rows = source->loadData(static_cast<int>(start), count);
+                for (int i = 0; i < rows.size(); ++i) {
+                    const QList<QVariant>& rowData = rows[i];
+                    const QString cell = column < rowData.size() ? rowData[column].toString() : QString();
+                    if (zoneMap->matches(column, cell, value, match))
+                        return static_cast<int>(start) + i;
+                }
+            }
+        }
+        return -1;
+    }));
+    return true;
+}
+
+void VirtualTableModel::cancelIndexTasks()
+{
+    // 旧数据源的索引任务继续在线程池中退出，结果直接丢弃
+    m_indexCancelled->store(true);
+    m_indexCancelled = std::make_shared<std::atomic<bool>>(false);
+    for (auto watcher : m_indexTasks) {
+        disconnect(watcher, nullptr, this, nullptr);
+        watcher->deleteLater();
+    }
+    m_indexTasks.clear();
+    m_columnIndexes.clear();
+
+    if (m_zoneMapTask) {
+        disconnect(m_zoneMapTask, nullptr, this, nullptr);
+        m_zoneMapTask->deleteLater();
+        m_zoneMapTask = nullptr;
+    }
+    m_zoneMap.reset();
+
+    if (m_searchTask) {
+        disconnect(m_searchTask, nullptr, this, nullptr);
+        m_searchTask->deleteLater();
+        m_searchTask = nullptr;
+    }
+}
+
+void VirtualTableModel::setColumnFormat(int column, const ColumnFormat& format)
+{
+    if (column < 0 || columnFormat(column) == format)
+        return;
+
+    if (column >= m_columnFormats.size()) {
+        m_columnFormats.resize(column + 1);
+    }
+    m_columnFormats[column] = format;
+    ++m_formatGeneration;
+
+    reloadStaleBlocks();
+}
+
+ColumnFormat VirtualTableModel::columnFormat(int column) const
+{
+    return (column >= 0 && column < m_columnFormats.size()) ? m_columnFormats[column] : ColumnFormat();
+}
+
+void VirtualTableModel::clearColumnFormats()
+{
+    if (m_columnFormats.isEmpty())
+        return;
+
+    m_columnFormats.clear();
+    ++m_formatGeneration;
+    reloadStaleBlocks();
+}
+
+void VirtualTableModel::reloadStaleBlocks()
+{
+    if (!m_dataSource)
+        return;
+
+    // 块不保留原始数据，格式变化后从缓存或数据源重新加载，加载完成前继续显示旧文本
+    QList<int> staleBlocks;
+    {
+        QMutexLocker locker(&m_dataMutex);
+        for (auto it = m_dataBlocks.constBegin(); it != m_dataBlocks.constEnd(); ++it) {
+            if (it.value().isValid && it.value().formatGeneration != m_formatGeneration) {
+                staleBlocks.append(it.key());
+            }
+        }
+    }
+
+    for (int blockIndex : staleBlocks) {
+        loadBlock(blockIndex, true);
+    }
+}
+
+void VirtualTableModel::setFrameCountersEnabled(bool enabled)
+{
+    m_frameCountersEnabled = enabled;
+    m_frameCounters = FrameCounters();
+}
+
+FrameCounters VirtualTableModel::takeFrameCounters()
+{
+    FrameCounters counters = m_frameCounters;
+    m_frameCounters = FrameCounters();
+    return counters;
+}
+
+void VirtualTableModel::onBlockLoaded(int blockIndex, int loadGeneration, const DataBlock& loaded)
+{
+    // 数据源或块大小已经变化，结果属于旧表
+    if (!m_dataSource || loadGeneration != m_loadGeneration)
+        return;
+
+    // 统计加载吞吐量（包含排队时间，反映数据实际可用的速度）
+    auto startIt = m_loadStartTimes.find(blockIndex);
+    if (startIt != m_loadStartTimes.end()) {
+        qint64 elapsedNs = m_loadClock.nsecsElapsed() - startIt.value();
+        m_loadStartTimes.erase(startIt);
+        if (elapsedNs > 0 && loaded.count > 0) {
+            double sample = loaded.count * 1e9 / elapsedNs;
+            m_loadThroughput = (m_loadThroughput <= 0.0) ? sample : 0.8 * m_loadThroughput + 0.2 * sample;
+        }
+    }
+
     QMutexLocker locker(&m_dataMutex);
 
     // 更新数据块
     DataBlock& block = getBlock(blockIndex);
-    block.data = data;
+    block.count = loaded.count;
+    block.displayText = loaded.displayText;
+    block.columnCount = loaded.columnCount;
+    block.formatGeneration = loaded.formatGeneration;
+    block.styleIndices = loaded.styleIndices;
     block.isValid = true;
     block.lastAccessTime = QDateTime::currentMSecsSinceEpoch();
+    // 加载期间列格式或条件格式发生了变化，先显示这次的结果，稍后重新加载
+    const bool stale = block.formatGeneration != m_formatGeneration;
 
     // 计算受影响的行范围
     int startRow = blockIndex * m_blockSize;
-    int endRow = std::min(startRow + data.size() - 1, m_dataSource->rowCount() - 1);
+    int endRow = std::min(startRow + loaded.count - 1, m_dataSource->rowCount() - 1);
 
     // 通知视图数据已更改
     QModelIndex topLeft = createIndex(startRow, 0);
     QModelIndex bottomRight = createIndex(endRow, m_dataSource->columnCount() - 1);
     emit dataChanged(topLeft, bottomRight);
+    emit blockLoaded(startRow, endRow);
 
     // 检查是否所有可见块都已加载
     bool allVisibleLoaded = true;
@@ -280,6 +850,11 @@ void VirtualTableModel::onBlockLoaded(int blockIndex, const QList<QList<QVariant
 
     // 从加载任务表中移除已完成的任务
     m_loadTasks.remove(blockIndex);
+    locker.unlock();
+
+    if (stale) {
+        loadBlock(blockIndex, true);
+    }
 }
 
 int VirtualTableModel::getBlockIndex(int row) const
@@ -294,8 +869,6 @@ DataBlock& VirtualTableModel::getBlock(int blockIndex)
         DataBlock block;
         block.startRow = blockIndex * m_blockSize;
         block.count = m_blockSize;
-        block.isValid = false;
-        block.lastAccessTime = 0;
         m_dataBlocks[blockIndex] = block;
     }
     return m_dataBlocks[blockIndex];
@@ -310,7 +883,7 @@ void VirtualTableModel::loadBlock(int blockIndex, bool priority)
     {
         QMutexLocker locker(&m_dataMutex);
         auto it = m_dataBlocks.find(blockIndex);
-        if (it != m_dataBlocks.end() && it.value().isValid) {
+        if (it != m_dataBlocks.end() && it.value().isValid && it.value().formatGeneration == m_formatGeneration) {
             // 块已加载，更新访问时间
             it.value().lastAccessTime = QDateTime::currentMSecsSinceEpoch();
             return;
@@ -338,17 +911,34 @@ void VirtualTableModel::loadBlock(int blockIndex, bool priority)
     if (count <= 0)
         return;
 
-    // 创建加载任务
-    auto loadFunction = [this, startRow, count]() {
-        return m_dataSource->loadData(startRow, count);
+    // 创建加载任务，显示文本也在加载线程中生成，绘制时不再转换
+    // 加载全部后从列式缓存读取（包括已写入临时文件的段），比重新解析数据源快
+    // 加载线程只使用捕获的数据源副本，界面线程切换数据源时不会产生竞争
+    auto loadFunction = [source = m_dataSource, startRow, count, cache = m_tableCache, formats = m_columnFormats,
+                            conditional = m_conditionalFormat, generation = m_formatGeneration]() {
+        // 原始数据只在生成显示文本和样式索引期间存在，块中不再保留
+        QList<QList<QVariant>> rows;
+        if (!cache || !cache->readRows(startRow, count, &rows)) {
+            rows = source->loadData(startRow, count);
+        }
+        DataBlock block;
+        block.startRow = startRow;
+        block.count = rows.size();
+        block.isValid = true;
+        buildDisplayText(block, rows, formats);
+        buildStyleIndices(block, rows, conditional);
+        block.formatGeneration = generation;
+        return block;
     };
 
-    QFuture<QList<QList<QVariant>>> future = QtConcurrent::run(QThreadPool::globalInstance(), loadFunction);
-    QFutureWatcher<QList<QList<QVariant>>>* watcher = new QFutureWatcher<QList<QList<QVariant>>>(this);
+    // 高优先级请求使用独立线程池，不会排在预加载任务之后
+    QThreadPool* pool = priority ? &m_priorityPool : QThreadPool::globalInstance();
+    QFuture<DataBlock> future = QtConcurrent::run(pool, loadFunction);
+    QFutureWatcher<DataBlock>* watcher = new QFutureWatcher<DataBlock>(this);
 
-    connect(watcher, &QFutureWatcher<QList<QList<QVariant>>>::finished, this, [this, blockIndex, watcher]() {
+    connect(watcher, &QFutureWatcher<DataBlock>::finished, this, [this, blockIndex, watcher, loadGeneration = m_loadGeneration]() {
         if (watcher->future().isResultReadyAt(0)) {
-            onBlockLoaded(blockIndex, watcher->future().result());
+            onBlockLoaded(blockIndex, loadGeneration, watcher->future().result());
         }
         watcher->deleteLater();
     });
@@ -357,6 +947,7 @@ void VirtualTableModel::loadBlock(int blockIndex, bool priority)
 
     // 存储加载任务（存储指针而不是值）
     m_loadTasks[blockIndex] = watcher;
+    m_loadStartTimes[blockIndex] = m_loadClock.nsecsElapsed();
 }
 
 void VirtualTableModel::preloadBlocks(int centerBlockIndex)
@@ -489,6 +1080,10 @@ void VirtualTableModel::updatePreloadBlockCounts()
 
 void VirtualTableModel::setLoadingStatus(LoadingStatus status)
 {
+    // "加载全部"期间保持LoadingAll，可见区域的加载不覆盖它
+    if (m_loadAllTask && status != LoadingStatus::LoadingAll)
+        return;
+
     if (m_loadingStatus != status) {
         m_loadingStatus = status;
         emit loadingStatusChanged(status);
@@ -1,13 +1,24 @@
 #ifndef VIRTUALTABLEMODEL_H
 #define VIRTUALTABLEMODEL_H
 
+#include "ColumnFormat.h"
+#include "ColumnarCache.h"
+#include "ColumnIndex.h"
+#include "ConditionalFormat.h"
 #include "DataSource.h"
+#include "FrameStats.h"
+#include "ZoneMap.h"
 #include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QFutureInterface>
 #include <QFutureWatcher>
 #include <QHash>
 #include <QList>
 #include <QMutex>
+#include <QThreadPool>
 #include <QVariant>
+#include <QVector>
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -34,11 +45,14 @@ enum class LoadingStatus {
  * @brief 数据块结构，用于存储和管理数据块
  */
 struct DataBlock {
-    int startRow; // 块起始行索引
-    int count; // 块包含的行数
-    QList<QList<QVariant>> data; // 块数据
-    bool isValid; // 块数据是否有效
-    qint64 lastAccessTime; // 最后访问时间
+    int startRow = 0; // 块起始行索引
+    int count = 0; // 块包含的行数
+    QVector<QString> displayText; // 显示文本，按行优先排列（行 * 列数 + 列），在加载线程中生成，原始数据生成后即释放
+    int columnCount = 0; // 显示文本的列数
+    QVector<quint8> styleIndices; // 条件格式样式索引，布局与displayText相同，没有规则时为空
+    int formatGeneration = 0; // 生成显示文本和样式索引时格式的版本，过期时重新加载
+    bool isValid = false; // 块数据是否有效
+    qint64 lastAccessTime = 0; // 最后访问时间
 };
 
 /**
@@ -71,6 +85,12 @@ public:
      */
     void setDataSource(std::shared_ptr<DataSource> source);
 
+    /**
+     * @brief 获取数据源
+     * @return 数据源指针
+     */
+    std::shared_ptr<DataSource> dataSource() const;
+
     /**
      * @brief 设置数据块大小
      * @param blockSize 块大小
@@ -108,6 +128,176 @@ public:
      */
     void setScrollSpeed(double speed);
 
+    /**
+     * @brief 立即以高优先级请求指定范围的数据
+     *
+     * 用于惯性滚动：手指离开时就已知道停止位置，可以在视图到达之前开始加载目标块
+     * @param startRow 起始行
+     * @param endRow 结束行
+     */
+    void prefetchRows(int startRow, int endRow);
+
+    /**
+     * @brief 获取最近测得的数据块加载吞吐量
+     * @return 每秒加载的行数，尚未测量时为0
+     */
+    double loadThroughput() const;
+
+    /**
+     * @brief 在后台把整个数据源读入列式缓存（"加载全部"模式）
+     *
+     * 后台流水线一边从数据源顺序读取下一段，一边把当前段转换为列式存储；
+     * 内存超出预算时最久未访问的段写入临时文件。进度通过loadingProgress()报告，
+     * 期间加载状态为LoadingAll。完成后加载线程直接从缓存读取块，不再解析数据源。
+     * @param memoryBudget 列式缓存的内存预算（字节）
+     * @return 是否成功启动或已经全部加载
+     */
+    bool loadAll(qint64 memoryBudget = 512LL * 1024 * 1024);
+
+    /**
+     * @brief 取消"加载全部"并释放列式缓存
+     */
+    void cancelLoadAll();
+
+    /**
+     * @brief 是否已全部加载到列式缓存
+     * @return 是否全部加载
+     */
+    bool isFullyLoaded() const;
+
+    /**
+     * @brief 启用或禁用data()调用统计
+     * @param enabled 是否启用
+     */
+    void setFrameCountersEnabled(bool enabled);
+
+    /**
+     * @brief 取出自上次调用以来的data()统计并清零
+     * @return 统计结果
+     */
+    FrameCounters takeFrameCounters();
+
+    /**
+     * @brief 直接获取单元格的显示文本，绘制热路径使用，不经过QVariant
+     *
+     * 返回块内预先生成的字符串指针，不复制也不分配内存。只能在界面线程调用，
+     * 指针在块被清理（下一次setVisibleRange）之前有效，应立即使用。
+     * 块未加载时触发加载并返回nullptr，调用方显示占位符。
+     * @param row 行索引
+     * @param column 列索引
+     * @return 显示文本指针，未加载时为nullptr
+     */
+    const QString* displayText(int row, int column) const;
+
+    /**
+     * @brief 设置列的显示格式
+     *
+     * 之后加载的块在加载线程中按格式批量生成显示文本；已加载的块立即重新格式化这一列
+     * @param column 列索引
+     * @param format 显示格式
+     */
+    void setColumnFormat(int column, const ColumnFormat& format);
+
+    /**
+     * @brief 获取列的显示格式
+     * @param column 列索引
+     * @return 显示格式，未设置时为原样显示
+     */
+    ColumnFormat columnFormat(int column) const;
+
+    /**
+     * @brief 清除所有列格式
+     */
+    void clearColumnFormats();
+
+    /**
+     * @brief 设置条件格式
+     *
+     * 规则在加载线程中按块批量计算，已加载的块立即重新计算
+     * @param format 条件格式
+     */
+    void setConditionalFormat(const ConditionalFormat& format);
+
+    /**
+     * @brief 获取条件格式
+     * @return 条件格式
+     */
+    const ConditionalFormat& conditionalFormat() const;
+
+    /**
+     * @brief 直接获取单元格的条件格式样式，绘制热路径使用，只读取已加载的块
+     * @param row 行索引
+     * @param column 列索引
+     * @return 样式指针，没有样式或块未加载时为nullptr
+     */
+    const ConditionalFormat::Style* cellStyle(int row, int column) const;
+
+    /**
+     * @brief 在后台为一列建立二级索引
+     *
+     * 数据源文件旁边有未过期的索引文件时直接读取，否则并行建立后保存，完成后发出columnIndexReady()
+     * @param column 列索引
+     * @return 是否已有索引或成功启动
+     */
+    bool buildColumnIndex(int column);
+
+    /**
+     * @brief 获取列的二级索引
+     * @param column 列索引
+     * @return 索引，尚未建立时为nullptr
+     */
+    std::shared_ptr<const ColumnIndex> columnIndex(int column) const;
+
+    /**
+     * @brief 是否正在为一列建立索引
+     * @param column 列索引
+     * @return 是否正在建立
+     */
+    bool isBuildingColumnIndex(int column) const;
+
+    /**
+     * @brief 在后台统计各段的最小值、最大值和空值数
+     *
+     * 数据源文件旁边有未过期的统计文件时直接读取，否则并行统计后保存，完成后发出zoneMapReady()
+     * @return 是否已有统计或成功启动
+     */
+    bool buildZoneMap();
+
+    /**
+     * @brief 设置已有的区间统计，行数或列数与数据源不一致时忽略
+     * @param zoneMap 区间统计
+     */
+    void setZoneMap(std::shared_ptr<const ZoneMap> zoneMap);
+
+    /**
+     * @brief 获取区间统计
+     * @return 区间统计，尚未统计时为nullptr
+     */
+    std::shared_ptr<const ZoneMap> zoneMap() const;
+
+    static constexpr int SearchPending = -2; // jumpToValue()的返回值：没有列索引，正在后台按区间统计查找
+
+    /**
+     * @brief 用列索引查找满足条件的第一行，一次二分查找，可以在界面线程中调用
+     * @param column 列索引
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 行号，没有列索引或找不到时返回-1
+     */
+    int findFirstRow(int column, const QString& value, ColumnIndex::Match match = ColumnIndex::Match::Equal) const;
+
+    /**
+     * @brief 在后台查找满足条件的第一行，完成后发出firstRowFound()
+     *
+     * 有列索引时直接二分查找；否则按区间统计只读取可能匹配的段，未排序的列可能要读取大部分数据，
+     * 因此在索引线程池中进行。新的查找会取消尚未完成的查找
+     * @param column 列索引
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 是否成功启动，没有列索引也没有区间统计时返回false
+     */
+    bool searchFirstRow(int column, const QString& value, ColumnIndex::Match match = ColumnIndex::Match::Equal);
+
 signals:
     /**
      * @brief 数据加载进度信号
@@ -121,16 +311,84 @@ signals:
      */
     void loadingStatusChanged(LoadingStatus status);
 
+    /**
+     * @brief 数据块加载完成信号
+     * @param startRow 块起始行
+     * @param endRow 块结束行
+     */
+    void blockLoaded(int startRow, int endRow);
+
+    /**
+     * @brief 列索引建立完成信号
+     * @param column 列索引
+     * @param success 是否成功
+     */
+    void columnIndexReady(int column, bool success);
+
+    /**
+     * @brief 区间统计完成信号
+     * @param success 是否成功
+     */
+    void zoneMapReady(bool success);
+
+    /**
+     * @brief 后台查找完成信号
+     * @param column 查找的列
+     * @param row 满足条件的第一行，找不到时为-1
+     */
+    void firstRowFound(int column, int row);
+
 private slots:
     /**
      * @brief 处理数据块加载完成
      * @param blockIndex 块索引
-     * @param data 加载的数据
+     * @param loadGeneration 发起加载时的加载任务版本，与当前版本不同时丢弃结果
+     * @param loaded 加载的数据块
      */
-    void onBlockLoaded(int blockIndex, const QList<QList<QVariant>>& data);
+    void onBlockLoaded(int blockIndex, int loadGeneration, const DataBlock& loaded);
 
 private:
     // 私有方法
+    /**
+     * @brief 获取单元格数据，data()在此基础上增加统计
+     * @param index 模型索引
+     * @param role 数据角色
+     * @param placeholder 输出参数，数据块未加载而返回占位符时置为true
+     * @return 单元格数据
+     */
+    QVariant cellData(const QModelIndex& index, int role, bool* placeholder) const;
+
+    /**
+     * @brief 在加载线程中生成块的显示文本
+     * @param block 刚加载的数据块
+     * @param rows 块的原始数据
+     * @param formats 各列的显示格式
+     */
+    static void buildDisplayText(DataBlock& block, const QList<QList<QVariant>>& rows, const QVector<ColumnFormat>& formats);
+
+    /**
+     * @brief 在加载线程中计算块的条件格式样式索引
+     * @param block 已生成显示文本的数据块
+     * @param rows 块的原始数据
+     * @param format 条件格式
+     */
+    static void buildStyleIndices(DataBlock& block, const QList<QList<QVariant>>& rows, const ConditionalFormat& format);
+
+    /**
+     * @brief 取消所有索引和区间统计任务并丢弃已有结果，数据源变化时调用
+     */
+    void cancelIndexTasks();
+
+    /**
+     * @brief 断开并取消所有块加载任务，之后到达的旧结果被丢弃，数据源或块大小变化时调用
+     */
+    void cancelLoadTasks();
+
+    /**
+     * @brief 列格式或条件格式变化后重新加载已加载的块，新文本生成前继续显示旧文本
+     */
+    void reloadStaleBlocks();
+
     /**
      * @brief 获取指定行所在的数据块索引
      * @param row 行索引
@@ -152,6 +410,21 @@ private:
      */
     void loadBlock(int blockIndex, bool priority = false);
 
+    /**
+     * @brief 在后台线程中执行"加载全部"流水线
+     * @param source 数据源
+     * @param cache 列式缓存
+     * @param task 任务状态，用于报告进度和检查取消，不引用模型，取消后模型不必等待
+     * @return 是否全部完成
+     */
+    static bool runLoadAll(std::shared_ptr<DataSource> source, std::shared_ptr<ColumnarCache> cache,
+        QFutureInterface<bool>& task);
+
+    /**
+     * @brief 处理"加载全部"结束
+     */
+    void onLoadAllFinished();
+
     /**
      * @brief 预加载数据块
      * @param centerBlockIndex 中心块索引（通常是可见区域的中心）
@@ -193,7 +466,27 @@ private:
     double m_scrollSpeed; // 当前滚动速度
     int m_preloadBlocksAhead; // 前方预加载块数
     int m_preloadBlocksBehind; // 后方预加载块数
-    QHash<int, QFutureWatcher<QList<QList<QVariant>>>*> m_loadTasks; // 加载任务表（存储指针）
+    QHash<int, QFutureWatcher<DataBlock>*> m_loadTasks; // 加载任务表（存储指针）
+    int m_loadGeneration; // 块加载任务的版本，数据源或块大小变化时递增
+    QElapsedTimer m_loadClock; // 加载计时时钟
+    QHash<int, qint64> m_loadStartTimes; // 各块开始加载的时间（纳秒）
+    double m_loadThroughput; // 加载吞吐量（行/秒），指数平滑
+    QVector<ColumnFormat> m_columnFormats; // 各列的显示格式
+    ConditionalFormat m_conditionalFormat; // 条件格式
+    int m_formatGeneration; // 列格式和条件格式的版本，块的格式过期时重新加载
+    bool m_frameCountersEnabled; // 是否统计data()调用
+    mutable FrameCounters m_frameCounters; // data()调用统计
+    QHash<int, std::shared_ptr<const ColumnIndex>> m_columnIndexes; // 已建立的列索引
+    QHash<int, QFutureWatcher<std::shared_ptr<ColumnIndex>>*> m_indexTasks; // 正在建立的列索引
+    std::shared_ptr<const ZoneMap> m_zoneMap; // 区间统计
+    QFutureWatcher<std::shared_ptr<ZoneMap>>* m_zoneMapTask; // 正在进行的区间统计
+    QFutureWatcher<int>* m_searchTask; // 正在进行的按值查找
+    std::shared_ptr<std::atomic<bool>> m_searchCancelled; // 当前查找的取消标志
+    std::shared_ptr<std::atomic<bool>> m_indexCancelled; // 当前数据源的索引和区间统计任务取消标志
+    QThreadPool m_indexPool; // 建立索引使用的线程池，不与数据块加载争抢全局线程池
+    std::shared_ptr<ColumnarCache> m_tableCache; // "加载全部"模式的列式缓存
+    QFutureWatcher<bool>* m_loadAllTask; // 正在进行的"加载全部"流水线
+    QThreadPool m_priorityPool; // 高优先级加载线程池，可见区域和惯性目标不排在预加载之后（声明在最后，因而最先析构，先等待其中的任务结束）
 };
 
 #endif // VIRTUALTABLEMODEL_H
@@ -1,20 +1,90 @@
 #include "VirtualTableView.h"
+#include <QApplication>
 #include <QDebug>
+#include <QGuiApplication>
 #include <QHeaderView>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScreen>
 #include <QScrollBar>
 #include <QWheelEvent>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+/**
+ * @brief 行表头：内容超出int像素范围时QHeaderView的section位置会溢出，改为按视图的64位偏移绘制和响应点击
+ */
+class VirtualTableRowHeader : public QHeaderView {
+public:
+    explicit VirtualTableRowHeader(VirtualTableView* view)
+        : QHeaderView(Qt::Vertical, view)
+        , m_view(view)
+    {
+        // 与QTableView默认的行表头一致
+        setSectionsClickable(true);
+        setHighlightSections(true);
+    }
+
+protected:
+    void paintEvent(QPaintEvent* event) override
+    {
+        if (!m_view->isBeyondHeaderRange()) {
+            QHeaderView::paintEvent(event);
+            return;
+        }
+
+        QPainter painter(viewport());
+        const int rowHeight = m_view->m_fixedRowHeight;
+        int row = static_cast<int>(m_view->m_scrollOffset / rowHeight);
+        int y = -static_cast<int>(m_view->m_scrollOffset % rowHeight);
+        for (; row < count() && y < viewport()->height(); ++row, y += rowHeight) {
+            painter.save();
+            paintSection(&painter, QRect(0, y, viewport()->width(), rowHeight), row);
+            painter.restore();
+        }
+    }
+
+    void mousePressEvent(QMouseEvent* event) override
+    {
+        if (!m_view->isBeyondHeaderRange() || event->button() != Qt::LeftButton) {
+            QHeaderView::mousePressEvent(event);
+            return;
+        }
+
+        // QTableView收到sectionPressed后选中整行
+        qint64 row = (m_view->m_scrollOffset + std::max(0, event->pos().y())) / m_view->m_fixedRowHeight;
+        if (row < count()) {
+            emit sectionPressed(static_cast<int>(row));
+        }
+        event->accept();
+    }
+
+private:
+    VirtualTableView* m_view;
+};
 
 VirtualTableView::VirtualTableView(QWidget* parent)
     : QTableView(parent)
     , m_virtualModel(nullptr)
+    , m_delegate(new VirtualTableDelegate(this))
+    , m_selectionModel(nullptr)
+    , m_helper(nullptr)
     , m_bufferSize(50)
     , m_fixedRowHeight(0)
     , m_visibleStartRow(0)
     , m_visibleEndRow(0)
-    , m_lastScrollPos(0)
+    , m_scrollOffset(0)
+    , m_syncingScrollBar(false)
+    , m_lastRowPosition(0.0)
     , m_currentScrollSpeed(0.0)
     , m_isInitializing(true)
+    , m_visibleRangeDirty(false)
+    , m_kineticScrollingEnabled(false)
+    , m_flingVelocity(0.0)
+    , m_frameStatsEnabled(false)
+    , m_frameStatsOverlayVisible(false)
 {
     // 设置表格属性
     setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
@@ -24,52 +94,51 @@ VirtualTableView::VirtualTableView(QWidget* parent)
     setSelectionBehavior(QAbstractItemView::SelectRows);
     setShowGrid(false);
     setSortingEnabled(false); // 禁用排序，由模型处理
+    setVerticalHeader(new VirtualTableRowHeader(this));
 
     // 启用交替行颜色
     setAlternatingRowColors(true);
 
-    // 配置更新定时器
-    m_updateTimer.setSingleShot(true);
-    m_updateTimer.setInterval(50); // 20fps更新频率
-    connect(&m_updateTimer, &QTimer::timeout, this, &VirtualTableView::updateVisibleData);
+    // 使用带文本缓存的绘制代理，避免每次重绘都重新排版
+    setItemDelegate(m_delegate);
+    m_helper = new VirtualViewHelper(this, horizontalHeader());
 
     // 配置滚动速度定时器
     m_scrollSpeedTimer.setSingleShot(true);
     m_scrollSpeedTimer.setInterval(200); // 200ms后重置滚动速度
     connect(&m_scrollSpeedTimer, &QTimer::timeout, this, &VirtualTableView::handleScrollSpeedTimeout);
 
-    // 连接滚动条信号
-    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
-        // 计算滚动速度
-        if (m_scrollTimer.isValid()) {
-            qint64 elapsed = m_scrollTimer.elapsed();
-            if (elapsed > 0) {
-                int delta = value - m_lastScrollPos;
-                m_currentScrollSpeed = static_cast<double>(delta) / (elapsed / 1000.0);
-
-                // 更新滚动速度到模型
-                if (m_virtualModel) {
-                    m_virtualModel->setScrollSpeed(std::abs(m_currentScrollSpeed));
-                }
-
-                // 重启滚动速度定时器
-                m_scrollSpeedTimer.start();
-            }
-        }
-
-        m_lastScrollPos = value;
-        m_scrollTimer.restart();
+    // 固定行高时单步和翻页按精确像素移动，不经过滚动条的粗粒度映射
+    connect(verticalScrollBar(), &QScrollBar::actionTriggered, this, [this](int action) {
+        if (m_fixedRowHeight <= 0)
+            return;
 
-        // 延迟更新可见数据
-        if (!m_updateTimer.isActive()) {
-            m_updateTimer.start();
+        qint64 delta = 0;
+        switch (action) {
+        case QAbstractSlider::SliderSingleStepAdd:
+            delta = m_fixedRowHeight;
+            break;
+        case QAbstractSlider::SliderSingleStepSub:
+            delta = -m_fixedRowHeight;
+            break;
+        case QAbstractSlider::SliderPageStepAdd:
+            delta = viewport()->height();
+            break;
+        case QAbstractSlider::SliderPageStepSub:
+            delta = -viewport()->height();
+            break;
+        default:
+            return;
         }
+
+        // 撤销滚动条自己的步进，改为按像素移动
+        verticalScrollBar()->setSliderPosition(verticalScrollBar()->value());
+        applyScrollOffset(m_scrollOffset + delta, true);
     });
 }
 
 VirtualTableView::~VirtualTableView()
 {
-    m_updateTimer.stop();
     m_scrollSpeedTimer.stop();
 }
 
@@ -79,26 +148,127 @@ void VirtualTableView::setVirtualModel(VirtualTableModel* model)
     if (m_virtualModel == model)
         return;
 
-    // 设置新模型
-    if (model) {
-        m_virtualModel = model;
-        setModel(model);
-        // 如果已经显示，更新可见数据
-        if (isVisible()) {
-            // 延迟更新，确保视图已经完全设置好
-            QTimer::singleShot(10, this, &VirtualTableView::updateVisibleData);
-        }
+    // 旧模型不再为这个视图统计data()调用
+    if (m_virtualModel) {
+        m_virtualModel->setFrameCountersEnabled(false);
+    }
+
+    // 设置新模型（传入空指针时解除模型），旧模型的查找结果不再跳转
+    disconnect(m_pendingJump);
+    m_virtualModel = model;
+    m_scrollOffset = 0;
+    QItemSelectionModel* oldSelectionModel = selectionModel();
+    setModel(model);
+
+    // 用行区间选择模型替换setModel创建的默认选择模型，全选、反选的代价与行数无关
+    QItemSelectionModel* defaultSelectionModel = selectionModel();
+    m_selectionModel = model ? new VirtualSelectionModel(model, this) : nullptr;
+    if (m_selectionModel) {
+        setSelectionModel(m_selectionModel);
+        delete defaultSelectionModel;
+    }
+    m_delegate->setSelectionModel(m_selectionModel);
+    delete oldSelectionModel;
+
+    syncFrameCounters();
+
+    // 抽样估算列宽，只读取少量分布在全表的行
+    m_helper->setModel(model, m_selectionModel);
+
+    // 如果已经显示，在下一帧更新可见数据
+    if (model && isVisible()) {
+        scheduleVisibleDataUpdate();
+    }
+}
+
+VirtualSelectionModel* VirtualTableView::virtualSelectionModel() const
+{
+    return m_selectionModel;
+}
+
+void VirtualTableView::invertSelection()
+{
+    if (m_selectionModel) {
+        m_selectionModel->invertSelection();
+    }
+}
+
+void VirtualTableView::resizeColumnsToSampledContents()
+{
+    m_helper->resizeColumnsToSampledContents();
+}
+
+void VirtualTableView::setFrameStatsEnabled(bool enabled)
+{
+    if (m_frameStatsEnabled == enabled)
+        return;
+
+    m_frameStatsEnabled = enabled;
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        m_frameStats.setRefreshRate(screen->refreshRate());
+    }
+    syncFrameCounters();
+    viewport()->update();
+}
+
+bool VirtualTableView::isFrameStatsEnabled() const
+{
+    return m_frameStatsEnabled;
+}
+
+void VirtualTableView::setFrameStatsOverlayVisible(bool visible)
+{
+    m_frameStatsOverlayVisible = visible;
+    viewport()->update();
+}
+
+const FrameStats& VirtualTableView::frameStats() const
+{
+    return m_frameStats;
+}
+
+void VirtualTableView::dumpFrameStats()
+{
+    m_frameStats.dumpHistogram();
+    m_frameStats.reset();
+}
+
+void VirtualTableView::syncFrameCounters()
+{
+    // 换模型或换数据源后统计从头开始，不混入上一张表的帧
+    disconnect(m_blockLoadedConnection);
+    disconnect(m_modelResetConnection);
+    m_frameStats.reset();
+    if (!m_virtualModel)
+        return;
+
+    m_virtualModel->setFrameCountersEnabled(m_frameStatsEnabled);
+    if (m_frameStatsEnabled) {
+        m_blockLoadedConnection = connect(m_virtualModel, &VirtualTableModel::blockLoaded, this,
+            [this](int startRow, int endRow) { m_frameStats.blockArrived(startRow, endRow); });
+        m_modelResetConnection = connect(m_virtualModel, &QAbstractItemModel::modelReset, this,
+            [this]() { m_frameStats.reset(); });
     }
 }
 
+void VirtualTableView::copySelection()
+{
+    m_helper->copySelection();
+}
+
+TableExporter* VirtualTableView::exporter() const
+{
+    return m_helper->exporter();
+}
+
 void VirtualTableView::setBufferSize(int bufferSize)
 {
     if (bufferSize > 0 && bufferSize != m_bufferSize) {
         m_bufferSize = bufferSize;
 
-        // 如果已经显示，更新可见数据
+        // 如果已经显示，在下一帧更新可见数据
         if (isVisible() && m_virtualModel) {
-            updateVisibleData();
+            scheduleVisibleDataUpdate();
         }
     }
 }
@@ -106,6 +276,8 @@ void VirtualTableView::setBufferSize(int bufferSize)
 void VirtualTableView::setFixedRowHeight(int rowHeight)
 {
     if (rowHeight >= 0 && rowHeight != m_fixedRowHeight) {
+        // 保持顶部行不变
+        const int topRow = static_cast<int>(firstVisibleRowPosition());
         m_fixedRowHeight = rowHeight;
 
         if (m_fixedRowHeight > 0) {
@@ -118,9 +290,17 @@ void VirtualTableView::setFixedRowHeight(int rowHeight)
             verticalHeader()->setDefaultSectionSize(verticalHeader()->minimumSectionSize());
         }
 
-        // 如果已经显示，更新可见数据
+        updateScrollMapping();
+        if (m_fixedRowHeight > 0) {
+            m_scrollOffset = m_scrollMapper.offsetForRow(topRow);
+            updateVerticalScrollBar();
+        } else if (m_virtualModel && topRow < m_virtualModel->rowCount()) {
+            scrollTo(m_virtualModel->index(topRow, 0), QAbstractItemView::PositionAtTop);
+        }
+
+        // 如果已经显示，在下一帧更新可见数据
         if (isVisible() && m_virtualModel) {
-            updateVisibleData();
+            scheduleVisibleDataUpdate();
         }
     }
 }
@@ -135,10 +315,42 @@ void VirtualTableView::jumpToRow(int rowIndex, bool scrollToVisible)
 
     // 如果需要滚动到可见区域
     if (scrollToVisible) {
-        scrollTo(m_virtualModel->index(rowIndex, 0), QAbstractItemView::PositionAtCenter);
+        if (m_fixedRowHeight > 0) {
+            // 固定行高时直接计算64位偏移，不依赖表头的int像素位置
+            updateScrollMapping();
+            applyScrollOffset(m_scrollMapper.offsetForRow(rowIndex) - (viewport()->height() - m_fixedRowHeight) / 2, true);
+        } else {
+            scrollTo(m_virtualModel->index(rowIndex, 0), QAbstractItemView::PositionAtCenter);
+        }
     }
 }
 
+int VirtualTableView::jumpToValue(int column, const QString& value, ColumnIndex::Match match)
+{
+    if (!m_virtualModel)
+        return -1;
+
+    disconnect(m_pendingJump);
+    int row = m_virtualModel->findFirstRow(column, value, match);
+    if (row >= 0) {
+        jumpToRow(row);
+        setCurrentIndex(m_virtualModel->index(row, column));
+        return row;
+    }
+
+    // 没有列索引时在后台查找，界面线程不读取数据
+    if (m_virtualModel->columnIndex(column) || !m_virtualModel->searchFirstRow(column, value, match))
+        return -1;
+    m_pendingJump = connect(m_virtualModel, &VirtualTableModel::firstRowFound, this, [this](int foundColumn, int foundRow) {
+        disconnect(m_pendingJump);
+        if (foundRow >= 0 && m_virtualModel) {
+            jumpToRow(foundRow);
+            setCurrentIndex(m_virtualModel->index(foundRow, foundColumn));
+        }
+    });
+    return VirtualTableModel::SearchPending;
+}
+
 int VirtualTableView::visibleStartRow() const
 {
     return m_visibleStartRow;
@@ -149,30 +361,286 @@ int VirtualTableView::visibleEndRow() const
     return m_visibleEndRow;
 }
 
+double VirtualTableView::firstVisibleRowPosition() const
+{
+    if (!m_virtualModel || m_virtualModel->rowCount() == 0)
+        return 0.0;
+
+    // 固定行高：整数部分是首行索引，小数部分是首行已滚出视口的比例
+    if (m_fixedRowHeight > 0) {
+        qint64 offset = scrollOffset();
+        int rowHeight = m_scrollMapper.rowHeight();
+        return static_cast<double>(offset / rowHeight) + static_cast<double>(offset % rowHeight) / rowHeight;
+    }
+
+    // 可变行高：由首行在视口中的位置计算
+    int row = rowAt(0);
+    if (row < 0)
+        return 0.0;
+
+    int height = rowHeight(row);
+    if (height <= 0)
+        return row;
+    return row + static_cast<double>(-rowViewportPosition(row)) / height;
+}
+
+void VirtualTableView::setKineticScrollingEnabled(bool enabled)
+{
+    if (enabled == m_kineticScrollingEnabled)
+        return;
+
+    m_kineticScrollingEnabled = enabled;
+
+    if (enabled) {
+        QScroller::grabGesture(viewport(), QScroller::TouchGesture);
+        QScroller* scroller = QScroller::scroller(viewport());
+        m_defaultScrollerProperties = scroller->scrollerProperties();
+        connect(scroller, &QScroller::stateChanged, this, &VirtualTableView::onScrollerStateChanged,
+            Qt::UniqueConnection);
+    } else {
+        QScroller::ungrabGesture(viewport());
+    }
+}
+
+bool VirtualTableView::isKineticScrollingEnabled() const
+{
+    return m_kineticScrollingEnabled;
+}
+
+qint64 VirtualTableView::scrollOffset() const
+{
+    // 固定行高时滚动条值在超大表格下是缩放后的位置，以64位偏移为准
+    if (m_fixedRowHeight > 0)
+        return m_scrollOffset;
+    return verticalScrollBar()->value();
+}
+
+QModelIndex VirtualTableView::indexAt(const QPoint& point) const
+{
+    if (!isBeyondHeaderRange() || !m_virtualModel)
+        return QTableView::indexAt(point);
+
+    int column = columnAt(point.x());
+    if (point.y() < 0 || column < 0)
+        return QModelIndex();
+    qint64 row = m_scrollMapper.rowAtOffset(m_scrollOffset + point.y());
+    if (row >= m_virtualModel->rowCount())
+        return QModelIndex();
+    return m_virtualModel->index(static_cast<int>(row), column);
+}
+
+QRect VirtualTableView::visualRect(const QModelIndex& index) const
+{
+    if (!isBeyondHeaderRange() || !index.isValid())
+        return QTableView::visualRect(index);
+
+    // 远离视口的行限制在int范围内，只用于判断是否可见
+    qint64 y = m_scrollMapper.offsetForRow(index.row()) - m_scrollOffset;
+    y = qBound<qint64>(-m_fixedRowHeight, y, viewport()->height() + m_fixedRowHeight);
+    return QRect(columnViewportPosition(index.column()), static_cast<int>(y),
+        columnWidth(index.column()), m_fixedRowHeight);
+}
+
+void VirtualTableView::scrollTo(const QModelIndex& index, ScrollHint hint)
+{
+    if (m_fixedRowHeight <= 0 || !index.isValid()) {
+        QTableView::scrollTo(index, hint);
+        return;
+    }
+
+    // 水平方向交给QTableView，它对垂直滚动条的修改忽略，垂直方向按64位偏移计算
+    m_syncingScrollBar = true;
+    QTableView::scrollTo(index, hint);
+    m_syncingScrollBar = false;
+
+    const qint64 top = m_scrollMapper.offsetForRow(index.row());
+    const int viewportHeight = viewport()->height();
+    qint64 offset = m_scrollOffset;
+    switch (hint) {
+    case QAbstractItemView::PositionAtTop:
+        offset = top;
+        break;
+    case QAbstractItemView::PositionAtBottom:
+        offset = top + m_fixedRowHeight - viewportHeight;
+        break;
+    case QAbstractItemView::PositionAtCenter:
+        offset = top - (viewportHeight - m_fixedRowHeight) / 2;
+        break;
+    case QAbstractItemView::EnsureVisible:
+        if (top < offset) {
+            offset = top;
+        } else if (top + m_fixedRowHeight > offset + viewportHeight) {
+            offset = top + m_fixedRowHeight - viewportHeight;
+        }
+        break;
+    }
+    applyScrollOffset(offset, true);
+}
+
+QModelIndex VirtualTableView::moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers)
+{
+    // QTableView按表头位置计算翻页的目标行，超出表头范围时改为按视口行数翻页
+    if (!isBeyondHeaderRange() || !m_virtualModel
+        || (cursorAction != QAbstractItemView::MovePageUp && cursorAction != QAbstractItemView::MovePageDown)) {
+        return QTableView::moveCursor(cursorAction, modifiers);
+    }
+
+    QModelIndex current = currentIndex();
+    int pageRows = std::max(1, viewport()->height() / m_fixedRowHeight);
+    int row = current.isValid() ? current.row() : 0;
+    if (cursorAction == QAbstractItemView::MovePageDown) {
+        row = std::min(row + pageRows, m_virtualModel->rowCount() - 1);
+    } else {
+        row = std::max(row - pageRows, 0);
+    }
+    return m_virtualModel->index(row, current.isValid() ? current.column() : 0);
+}
+
+void VirtualTableView::setSelection(const QRect& rect, QItemSelectionModel::SelectionFlags command)
+{
+    if (!isBeyondHeaderRange() || !m_virtualModel || !selectionModel()) {
+        QTableView::setSelection(rect, command);
+        return;
+    }
+
+    // 按整行选择，行由64位偏移算出
+    QRect area = rect.normalized();
+    const qint64 lastRow = m_virtualModel->rowCount() - 1;
+    int top = static_cast<int>(std::min(lastRow, m_scrollMapper.rowAtOffset(m_scrollOffset + std::max(0, area.top()))));
+    int bottom = static_cast<int>(std::min(lastRow, m_scrollMapper.rowAtOffset(m_scrollOffset + std::max(0, area.bottom()))));
+    QItemSelection selection(m_virtualModel->index(top, 0),
+        m_virtualModel->index(bottom, m_virtualModel->columnCount() - 1));
+    selectionModel()->select(selection, command);
+}
+
+QRegion VirtualTableView::visualRegionForSelection(const QItemSelection& selection) const
+{
+    // 选择的是整行，超出表头范围时直接重绘整个视口
+    if (!isBeyondHeaderRange())
+        return QTableView::visualRegionForSelection(selection);
+    return QRegion(viewport()->rect());
+}
+
 void VirtualTableView::wheelEvent(QWheelEvent* event)
 {
-    // 处理滚轮事件
-    QTableView::wheelEvent(event);
+    // 触控板惯性阶段可能需要限速
+    if (m_kineticScrollingEnabled && handleKineticWheel(event))
+        return;
+
+    // 可变行高时滚动本身会经过scrollContentsBy标记可见范围
+    if (m_fixedRowHeight <= 0) {
+        QTableView::wheelEvent(event);
+        return;
+    }
+
+    // 固定行高时直接移动64位偏移，优先使用触控板的像素增量，否则按滚轮行数换算
+    qint64 dy = 0;
+    int dx = 0;
+    if (!event->pixelDelta().isNull()) {
+        dy = event->pixelDelta().y();
+        dx = event->pixelDelta().x();
+    } else {
+        dy = static_cast<qint64>(event->angleDelta().y()) * QApplication::wheelScrollLines() * m_fixedRowHeight / 120;
+        dx = event->angleDelta().x() * horizontalScrollBar()->singleStep() / 120;
+    }
+
+    if (dy != 0) {
+        applyScrollOffset(m_scrollOffset - dy, true);
+    }
+    if (dx != 0) {
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - dx);
+    }
+    event->accept();
+}
+
+void VirtualTableView::mousePressEvent(QMouseEvent* event)
+{
+    // QAbstractItemView按基类isSelected()把Ctrl点击的Toggle改写为Select或Deselect，
+    // 而行区间选择不写入基类，已选中的行需要在这里直接取消选择
+    QModelIndex index = indexAt(event->pos());
+    if (m_selectionModel && index.isValid() && event->button() == Qt::LeftButton
+        && (event->modifiers() & Qt::ControlModifier) && !(event->modifiers() & Qt::ShiftModifier)
+        && m_selectionModel->containsRow(index.row())) {
+        m_selectionModel->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+        m_selectionModel->select(index, QItemSelectionModel::Deselect | QItemSelectionModel::Rows);
+        event->accept();
+        return;
+    }
+
+    QTableView::mousePressEvent(event);
+}
 
-    // 延迟更新可见数据
-    if (!m_updateTimer.isActive()) {
-        m_updateTimer.start();
+void VirtualTableView::keyPressEvent(QKeyEvent* event)
+{
+    // QTableView默认不处理复制，选中行可能有上千万，交给后台导出
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        event->accept();
+        return;
     }
+
+    QTableView::keyPressEvent(event);
 }
 
 void VirtualTableView::scrollContentsBy(int dx, int dy)
 {
+    // 固定行高时垂直位置由64位偏移决定，只有拖动滑块等直接修改滚动条的操作才从滚动条值反算
+    if (m_fixedRowHeight > 0 && dy != 0) {
+        if (dx != 0) {
+            QTableView::scrollContentsBy(dx, 0);
+        }
+        if (!m_syncingScrollBar) {
+            applyScrollOffset(m_scrollMapper.offsetForValue(verticalScrollBar()->value()), false);
+        }
+        return;
+    }
+
     // 处理滚动内容事件
     QTableView::scrollContentsBy(dx, dy);
 
     // 更新滚动速度
     if (dy != 0) {
-        updateScrollSpeed(dy);
+        updateScrollSpeed();
+    }
+
+    if (m_frameStatsEnabled) {
+        m_frameStats.markScrolled();
+
+        // 视口滚动是位图平移，叠加层会被一起平移，需要整体重绘
+        if (m_frameStatsOverlayVisible) {
+            viewport()->update();
+        }
+    }
+
+    // 可见范围在本帧绘制前更新
+    scheduleVisibleDataUpdate();
+}
+
+void VirtualTableView::paintEvent(QPaintEvent* event)
+{
+    // 每帧最多计算一次可见范围，并在绘制单元格之前发出加载请求，
+    // 这样滚动发生的同一帧内模型就已经开始加载新露出的数据块
+    if (m_frameStatsEnabled) {
+        m_frameStats.beginFrame();
+    }
+
+    if (m_visibleRangeDirty) {
+        updateVisibleData();
     }
 
-    // 延迟更新可见数据
-    if (!m_updateTimer.isActive()) {
-        m_updateTimer.start();
+    if (isBeyondHeaderRange() && m_virtualModel) {
+        paintRowsByOffset(event);
+    } else {
+        QTableView::paintEvent(event);
+    }
+
+    if (m_frameStatsEnabled && m_virtualModel) {
+        QPair<int, int> rows = calculateVisibleRows();
+        m_frameStats.endFrame(m_virtualModel->takeFrameCounters(), rows.first, rows.second);
+        if (m_frameStatsOverlayVisible) {
+            QPainter painter(viewport());
+            m_frameStats.paintOverlay(&painter, viewport()->rect());
+        }
     }
 }
 
@@ -181,9 +649,9 @@ void VirtualTableView::resizeEvent(QResizeEvent* event)
     // 处理窗口大小变化事件
     QTableView::resizeEvent(event);
 
-    // 更新可见数据
+    // 在下一帧更新可见数据
     if (isVisible() && m_virtualModel) {
-        updateVisibleData();
+        scheduleVisibleDataUpdate();
     }
 }
 
@@ -195,12 +663,27 @@ void VirtualTableView::showEvent(QShowEvent* event)
     // 初始化时更新可见数据
     if (m_isInitializing && m_virtualModel) {
         m_isInitializing = false;
-        QTimer::singleShot(0, this, &VirtualTableView::updateVisibleData);
+        scheduleVisibleDataUpdate();
+    }
+}
+
+void VirtualTableView::updateGeometries()
+{
+    updateScrollMapping();
+
+    // QTableView按表头的int长度设置垂直滚动条，固定行高时改由64位映射设置，期间的滚动忽略
+    m_syncingScrollBar = true;
+    QTableView::updateGeometries();
+    m_syncingScrollBar = false;
+    if (m_fixedRowHeight > 0) {
+        updateVerticalScrollBar();
     }
 }
 
 void VirtualTableView::updateVisibleData()
 {
+    m_visibleRangeDirty = false;
+
     if (!m_virtualModel)
         return;
 
@@ -209,6 +692,14 @@ void VirtualTableView::updateVisibleData()
     int startRow = visibleRows.first;
     int endRow = visibleRows.second;
 
+    // 按预测的下一帧位置向滚动方向扩展，提前请求即将露出的行
+    int leadRows = predictedLeadRows();
+    if (leadRows > 0) {
+        endRow += leadRows;
+    } else {
+        startRow += leadRows;
+    }
+
     // 添加缓冲区
     startRow = qMax(0, startRow - m_bufferSize);
     endRow = qMin(m_virtualModel->rowCount() - 1, endRow + m_bufferSize);
@@ -225,6 +716,24 @@ void VirtualTableView::updateVisibleData()
     m_virtualModel->setVisibleRange(startRow, endRow);
 }
 
+void VirtualTableView::onScrollerStateChanged(QScroller::State state)
+{
+    QScroller* scroller = QScroller::scroller(viewport());
+
+    if (state == QScroller::Pressed) {
+        // 每次手势开始时按最新的吞吐量调整速度上限
+        updateScrollerProperties();
+    } else if (state == QScroller::Scrolling) {
+        // 手指离开后进入惯性阶段，finalPosition就是停止位置（滚动条单位）
+        qreal finalY = scroller->finalPosition().y();
+        qint64 targetOffset = static_cast<qint64>(finalY);
+        if (m_fixedRowHeight > 0) {
+            targetOffset = m_scrollMapper.offsetForValue(static_cast<int>(qBound<qreal>(0, finalY, m_scrollMapper.maximumValue())));
+        }
+        requestFlingTarget(targetOffset);
+    }
+}
+
 void VirtualTableView::handleScrollSpeedTimeout()
 {
     // 重置滚动速度
@@ -239,32 +748,32 @@ QPair<int, int> VirtualTableView::calculateVisibleRows() const
     if (!m_virtualModel || m_virtualModel->rowCount() == 0)
         return qMakePair(0, 0);
 
-    // 获取视口矩形
-    QRect viewportRect = viewport()->rect();
+    const int rowCount = m_virtualModel->rowCount();
+    const int viewportHeight = std::max(1, viewport()->height());
 
-    // 获取第一个可见单元格的索引
-    QModelIndex topLeft = indexAt(QPoint(0, 0));
-    int startRow = (topLeft.isValid()) ? topLeft.row() : 0;
+    // 固定行高：由64位逻辑偏移O(1)算出首末可见行，不查询表头
+    if (m_fixedRowHeight > 0) {
+        qint64 offset = scrollOffset();
+        qint64 firstRow = m_scrollMapper.rowAtOffset(offset);
+        qint64 lastRow = m_scrollMapper.rowAtOffset(offset + viewportHeight - 1);
+        int startRow = static_cast<int>(std::min<qint64>(firstRow, rowCount - 1));
+        int endRow = static_cast<int>(std::min<qint64>(lastRow, rowCount - 1));
+        return qMakePair(startRow, endRow);
+    }
 
-    // 获取最后一个可见单元格的索引
-    QModelIndex bottomRight = indexAt(QPoint(viewportRect.width() - 1, viewportRect.height() - 1));
-    int endRow = (bottomRight.isValid()) ? bottomRight.row() : 0;
+    // 可变行高：通过表头查找视口顶部和底部的行
+    int startRow = rowAt(0);
+    int endRow = rowAt(viewportHeight - 1);
 
-    // 如果无法通过indexAt获取有效索引，使用滚动条位置计算
-    if (startRow == 0 && endRow == 0 && m_virtualModel->rowCount() > 0) {
-        int scrollValue = verticalScrollBar()->value();
-        int viewportHeight = viewportRect.height();
-        int rowHeight = (m_fixedRowHeight > 0) ? m_fixedRowHeight : verticalHeader()->defaultSectionSize();
-
-        if (rowHeight > 0) {
-            startRow = scrollValue / rowHeight;
-            endRow = startRow + (viewportHeight / rowHeight) + 1;
-        }
-    }
+    // 视口底部在最后一行之下时rowAt返回-1，此时可见区域一直延伸到最后一行
+    if (startRow < 0)
+        startRow = 0;
+    if (endRow < 0)
+        endRow = rowCount - 1;
 
     // 确保行索引在有效范围内
-    startRow = qMax(0, startRow);
-    endRow = qMin(m_virtualModel->rowCount() - 1, endRow);
+    startRow = qMin(startRow, rowCount - 1);
+    endRow = qMin(endRow, rowCount - 1);
 
     // 确保endRow至少等于startRow
     if (endRow < startRow)
@@ -273,22 +782,276 @@ QPair<int, int> VirtualTableView::calculateVisibleRows() const
     return qMakePair(startRow, endRow);
 }
 
-void VirtualTableView::updateScrollSpeed(int deltaY)
+void VirtualTableView::updateScrollSpeed()
 {
+    double rowPosition = firstVisibleRowPosition();
+
     if (m_scrollTimer.isValid()) {
         qint64 elapsed = m_scrollTimer.elapsed();
-        if (elapsed > 0) {
-            m_currentScrollSpeed = static_cast<double>(deltaY) / (elapsed / 1000.0);
 
-            // 更新滚动速度到模型
-            if (m_virtualModel) {
-                m_virtualModel->setScrollSpeed(std::abs(m_currentScrollSpeed));
-            }
+        // 同一毫秒内的多次滚动累积到下一次计算
+        if (elapsed <= 0)
+            return;
 
-            // 重启滚动速度定时器
-            m_scrollSpeedTimer.start();
+        // 由带小数的首行位置计算行速度，再换算为像素速度，向下滚动为正
+        double rowsPerSecond = (rowPosition - m_lastRowPosition) / (elapsed / 1000.0);
+        m_currentScrollSpeed = rowsPerSecond * m_scrollMapper.rowHeight();
+
+        // 更新滚动速度到模型
+        if (m_virtualModel) {
+            m_virtualModel->setScrollSpeed(std::abs(m_currentScrollSpeed));
         }
+
+        // 重启滚动速度定时器
+        m_scrollSpeedTimer.start();
     }
 
+    m_lastRowPosition = rowPosition;
     m_scrollTimer.restart();
 }
+
+void VirtualTableView::scheduleVisibleDataUpdate()
+{
+    m_visibleRangeDirty = true;
+    viewport()->update();
+}
+
+int VirtualTableView::predictedLeadRows() const
+{
+    int rowHeight = m_scrollMapper.rowHeight();
+    if (m_currentScrollSpeed == 0.0 || rowHeight <= 0)
+        return 0;
+
+    // 以屏幕刷新间隔作为一帧的时长
+    QScreen* screen = QGuiApplication::primaryScreen();
+    double refreshRate = screen ? screen->refreshRate() : 60.0;
+    if (refreshRate <= 0.0)
+        refreshRate = 60.0;
+
+    double leadPixels = m_currentScrollSpeed / refreshRate;
+    int leadRows = static_cast<int>(std::ceil(std::abs(leadPixels) / rowHeight));
+    return leadPixels > 0 ? leadRows : -leadRows;
+}
+
+void VirtualTableView::updateScrollMapping()
+{
+    int rowHeight = (m_fixedRowHeight > 0) ? m_fixedRowHeight : verticalHeader()->defaultSectionSize();
+    m_scrollMapper.setRowCount(m_virtualModel ? m_virtualModel->rowCount() : 0);
+    m_scrollMapper.setRowHeight(rowHeight);
+    m_scrollMapper.setViewportHeight(viewport()->height());
+}
+
+bool VirtualTableView::isBeyondHeaderRange() const
+{
+    // QHeaderView的section位置是int，内容更高时会溢出
+    return m_fixedRowHeight > 0 && m_scrollMapper.contentHeight() > std::numeric_limits<int>::max();
+}
+
+void VirtualTableView::updateVerticalScrollBar()
+{
+    m_scrollOffset = m_scrollMapper.clampOffset(m_scrollOffset);
+
+    // 超出滚动条范围后按比例缩放，滑块拖动为粗粒度定位
+    QScrollBar* verticalBar = verticalScrollBar();
+    m_syncingScrollBar = true;
+    verticalBar->setRange(0, m_scrollMapper.maximumValue());
+    verticalBar->setPageStep(m_scrollMapper.pageStep());
+    verticalBar->setSingleStep(m_scrollMapper.singleStep());
+    verticalBar->setValue(m_scrollMapper.valueForOffset(m_scrollOffset));
+    m_syncingScrollBar = false;
+
+    syncHeaderOffset();
+}
+
+void VirtualTableView::applyScrollOffset(qint64 offset, bool syncScrollBar)
+{
+    offset = m_scrollMapper.clampOffset(offset);
+    const bool moved = offset != m_scrollOffset;
+    m_scrollOffset = offset;
+
+    if (syncScrollBar) {
+        m_syncingScrollBar = true;
+        verticalScrollBar()->setValue(m_scrollMapper.valueForOffset(m_scrollOffset));
+        m_syncingScrollBar = false;
+    }
+
+    if (!moved)
+        return;
+
+    syncHeaderOffset();
+    updateScrollSpeed();
+
+    if (m_frameStatsEnabled) {
+        m_frameStats.markScrolled();
+
+        // 视口滚动是位图平移，叠加层会被一起平移，需要整体重绘
+        if (m_frameStatsOverlayVisible) {
+            viewport()->update();
+        }
+    }
+
+    // 可见范围在本帧绘制前更新
+    scheduleVisibleDataUpdate();
+}
+
+void VirtualTableView::syncHeaderOffset()
+{
+    // 超出表头范围时行的位置由偏移直接算出，整体重绘
+    if (isBeyondHeaderRange()) {
+        viewport()->update();
+        verticalHeader()->viewport()->update();
+        return;
+    }
+
+    // 在表头范围内时表头偏移就是逻辑偏移，QTableView照常绘制和定位
+    int offset = static_cast<int>(m_scrollOffset);
+    int delta = verticalHeader()->offset() - offset;
+    if (delta != 0) {
+        verticalHeader()->setOffset(offset);
+        viewport()->scroll(0, delta);
+    }
+}
+
+void VirtualTableView::paintRowsByOffset(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    const QRect area = viewport()->rect();
+    painter.fillRect(event->rect(), palette().brush(QPalette::Base));
+
+    const int rowCount = m_virtualModel->rowCount();
+    QHeaderView* header = horizontalHeader();
+    const int columnCount = header->count();
+    if (rowCount <= 0 || columnCount <= 0)
+        return;
+
+    // 可见列
+    int firstVisual = header->visualIndexAt(0);
+    int lastVisual = header->visualIndexAt(area.width() - 1);
+    if (firstVisual < 0)
+        return;
+    if (lastVisual < 0)
+        lastVisual = columnCount - 1;
+
+    // 可见行完全由偏移算出，不查询行表头
+    int row = static_cast<int>(m_scrollMapper.rowAtOffset(m_scrollOffset));
+    int y = -static_cast<int>(m_scrollOffset % m_fixedRowHeight);
+
+    const QStyleOptionViewItem baseOption = viewOptions();
+    const QBrush alternateBrush = palette().brush(QPalette::AlternateBase);
+    const QModelIndex current = currentIndex();
+
+    for (; row < rowCount && y < area.height(); ++row, y += m_fixedRowHeight) {
+        // 交替行背景
+        if (alternatingRowColors() && (row & 1)) {
+            painter.fillRect(QRect(0, y, area.width(), m_fixedRowHeight), alternateBrush);
+        }
+
+        for (int visual = firstVisual; visual <= lastVisual; ++visual) {
+            int column = header->logicalIndex(visual);
+            if (header->isSectionHidden(column))
+                continue;
+
+            QModelIndex index = m_virtualModel->index(row, column);
+            QStyleOptionViewItem option = baseOption;
+            option.rect = QRect(header->sectionViewportPosition(column), y, header->sectionSize(column), m_fixedRowHeight);
+            if (index == current && hasFocus()) {
+                option.state |= QStyle::State_HasFocus;
+            }
+            itemDelegate(index)->paint(&painter, option, index);
+        }
+    }
+}
+
+void VirtualTableView::requestFlingTarget(qint64 targetOffset)
+{
+    if (!m_virtualModel)
+        return;
+
+    // 目标视口范围加上缓冲区，交给模型以高优先级加载
+    targetOffset = m_scrollMapper.clampOffset(targetOffset);
+    qint64 firstRow = m_scrollMapper.rowAtOffset(targetOffset);
+    qint64 lastRow = m_scrollMapper.rowAtOffset(targetOffset + std::max(1, viewport()->height()) - 1);
+    int startRow = static_cast<int>(std::max<qint64>(0, firstRow - m_bufferSize));
+    int endRow = static_cast<int>(std::min<qint64>(m_virtualModel->rowCount() - 1, lastRow + m_bufferSize));
+    m_virtualModel->prefetchRows(startRow, endRow);
+}
+
+double VirtualTableView::maxFlingSpeed() const
+{
+    if (!m_virtualModel)
+        return 0.0;
+
+    // 允许惯性速度略高于加载速度，预加载缓冲区可以吸收差额
+    double throughput = m_virtualModel->loadThroughput();
+    if (throughput <= 0.0)
+        return 0.0;
+    return throughput * m_scrollMapper.rowHeight() * 2.0;
+}
+
+void VirtualTableView::updateScrollerProperties()
+{
+    QScroller* scroller = QScroller::scroller(viewport());
+    QScrollerProperties properties = m_defaultScrollerProperties;
+
+    double maxSpeed = maxFlingSpeed();
+    if (maxSpeed > 0.0) {
+        // QScroller的速度单位是米/秒
+        double pixelsPerMeter = logicalDpiY() / 0.0254;
+        double defaultMaxVelocity = m_defaultScrollerProperties.scrollMetric(QScrollerProperties::MaximumVelocity).toDouble();
+        double maxVelocity = std::min(defaultMaxVelocity, maxSpeed / pixelsPerMeter);
+        properties.setScrollMetric(QScrollerProperties::MaximumVelocity, maxVelocity);
+    }
+
+    scroller->setScrollerProperties(properties);
+}
+
+bool VirtualTableView::handleKineticWheel(QWheelEvent* event)
+{
+    // 只有触控板（带像素增量）才有惯性阶段
+    if (event->pixelDelta().isNull())
+        return false;
+
+    qint64 elapsedNs = m_flingTimer.isValid() ? m_flingTimer.nsecsElapsed() : 0;
+    m_flingTimer.restart();
+
+    // 像素增量为正表示内容向下移动，即逻辑偏移减小
+    double sampleVelocity = 0.0;
+    if (elapsedNs > 0) {
+        sampleVelocity = -event->pixelDelta().y() * 1e9 / elapsedNs;
+    }
+
+    switch (event->phase()) {
+    case Qt::ScrollBegin:
+        m_flingVelocity = 0.0;
+        return false;
+    case Qt::ScrollUpdate:
+        // 平滑手指拖动时的速度
+        m_flingVelocity = 0.7 * m_flingVelocity + 0.3 * sampleVelocity;
+        return false;
+    case Qt::ScrollEnd:
+        // 手指离开，按指数衰减估算系统惯性的停止位置（衰减时间常数约0.5秒）
+        if (std::abs(m_flingVelocity) > 300.0) {
+            requestFlingTarget(scrollOffset() + static_cast<qint64>(m_flingVelocity * 0.5));
+        }
+        return false;
+    case Qt::ScrollMomentum: {
+        // 惯性速度超过加载能力时按比例缩小本次位移
+        double maxSpeed = maxFlingSpeed();
+        if (maxSpeed <= 0.0 || std::abs(sampleVelocity) <= maxSpeed) {
+            return false;
+        }
+
+        double scale = maxSpeed / std::abs(sampleVelocity);
+        int dy = static_cast<int>(std::lround(event->pixelDelta().y() * scale));
+        if (m_fixedRowHeight > 0) {
+            applyScrollOffset(m_scrollOffset - dy, true);
+        } else {
+            verticalScrollBar()->setValue(verticalScrollBar()->value() - dy);
+        }
+        event->accept();
+        return true;
+    }
+    default:
+        return false;
+    }
+}
@@ -1,16 +1,26 @@
 #ifndef VIRTUALTABLEVIEW_H
 #define VIRTUALTABLEVIEW_H
 
+#include "VirtualTableDelegate.h"
 #include "VirtualTableModel.h"
+#include "VirtualScrollMapper.h"
+#include "VirtualSelectionModel.h"
+#include "VirtualViewHelper.h"
+#include "FrameStats.h"
 #include <QElapsedTimer>
+#include <QScroller>
 #include <QTableView>
 #include <QTimer>
 
+class VirtualTableRowHeader;
+
 /**
  * @brief 虚拟表格视图类，继承自QTableView
  * 
  * 这个类负责处理滚动事件，计算可见区域，并与VirtualTableModel交互
- * 实现千万级数据的高效滚动和显示
+ * 实现千万级数据的高效滚动和显示。
+ * 固定行高时垂直位置是64位像素偏移，经VirtualScrollMapper映射到滚动条：滚轮、方向键和翻页精确到像素，
+ * 拖动滑块在超大表格下为粗粒度定位；内容高度超出表头的int像素范围后，行的位置、绘制和点击都由偏移直接计算
  */
 class VirtualTableView : public QTableView {
     Q_OBJECT
@@ -48,6 +58,16 @@ public:
      */
     void jumpToRow(int rowIndex, bool scrollToVisible = true);
 
+    /**
+     * @brief 按列值跳转，有列索引时立即跳转；没有索引时在后台用区间统计查找，找到后再跳转
+     * @param column 列索引，需先调用VirtualTableModel::buildColumnIndex()或buildZoneMap()
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 跳转到的行；在后台查找时返回VirtualTableModel::SearchPending，结果由模型的firstRowFound()通知；
+     *         没有索引和区间统计或找不到时返回-1
+     */
+    int jumpToValue(int column, const QString& value, ColumnIndex::Match match = ColumnIndex::Match::Equal);
+
     /**
      * @brief 获取当前可见的起始行索引
      * @return 起始行索引
@@ -60,12 +80,124 @@ public:
      */
     int visibleEndRow() const;
 
+    /**
+     * @brief 获取带小数的首个可见行位置
+     *
+     * 整数部分是首个可见行的索引，小数部分是该行已滚出视口顶部的比例，
+     * 用于平滑滚动预测和滚动速度计算
+     * @return 首行位置（行）
+     */
+    double firstVisibleRowPosition() const;
+
+    /**
+     * @brief 启用或禁用惯性滚动
+     *
+     * 触摸屏手势使用QScroller，触控板的惯性阶段由滚轮事件的phase驱动。
+     * 惯性开始时立即以高优先级请求目标位置的数据块；
+     * 当模型实测的加载吞吐量跟不上时，温和地限制惯性速度，避免整屏占位符
+     * @param enabled 是否启用
+     */
+    void setKineticScrollingEnabled(bool enabled);
+
+    /**
+     * @brief 是否启用了惯性滚动
+     * @return 是否启用
+     */
+    bool isKineticScrollingEnabled() const;
+
+    /**
+     * @brief 获取行区间选择模型
+     *
+     * 视图的选择全部保存在这个模型的行区间中，
+     * 查询选中状态请使用containsRow()和selectedRowSet()
+     * @return 选择模型，未设置模型时返回nullptr
+     */
+    VirtualSelectionModel* virtualSelectionModel() const;
+
+    /**
+     * @brief 反选所有行
+     */
+    void invertSelection();
+
+    /**
+     * @brief 在后台抽样估算列宽并应用到列表头
+     *
+     * 设置模型时会自动调用一次，不需要加载全部数据
+     */
+    void resizeColumnsToSampledContents();
+
+    /**
+     * @brief 在后台把选中行以TSV格式复制到剪贴板，未选中时不复制
+     *
+     * 直接从数据源流式读取，不经过模型的块缓存，Ctrl+C会调用此方法；
+     * 超过TableExporter::MaxClipboardRows行时不复制，通过exporter()的finished()报告原因
+     */
+    void copySelection();
+
+    /**
+     * @brief 获取复制使用的导出器，可用于连接进度信号或取消复制
+     * @return 导出器
+     */
+    TableExporter* exporter() const;
+
+    /**
+     * @brief 启用或禁用逐帧性能统计
+     *
+     * 启用后模型会统计data()调用，每帧结束时记录绘制耗时、占位符和掉帧，
+     * 并输出到virtualtable.frames日志分类
+     * @param enabled 是否启用
+     */
+    void setFrameStatsEnabled(bool enabled);
+
+    /**
+     * @brief 是否启用了逐帧性能统计
+     * @return 是否启用
+     */
+    bool isFrameStatsEnabled() const;
+
+    /**
+     * @brief 设置是否在视口右上角显示性能叠加层（需要先启用统计）
+     * @param visible 是否显示
+     */
+    void setFrameStatsOverlayVisible(bool visible);
+
+    /**
+     * @brief 获取逐帧性能统计
+     * @return 统计对象
+     */
+    const FrameStats& frameStats() const;
+
+    /**
+     * @brief 输出绘制耗时直方图并清空统计
+     */
+    void dumpFrameStats();
+
+    /**
+     * @brief 获取当前垂直滚动的逻辑像素偏移
+     * @return 64位像素偏移，超大表格下不受滚动条int范围限制
+     */
+    qint64 scrollOffset() const;
+
+    // 固定行高且内容超出表头的int像素范围时按64位偏移定位
+    QModelIndex indexAt(const QPoint& point) const override;
+    QRect visualRect(const QModelIndex& index) const override;
+    void scrollTo(const QModelIndex& index, ScrollHint hint = EnsureVisible) override;
+
 protected:
     // 重写的事件处理方法
     void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
     void scrollContentsBy(int dx, int dy) override;
+    void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void showEvent(QShowEvent* event) override;
+    QModelIndex moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers) override;
+    void setSelection(const QRect& rect, QItemSelectionModel::SelectionFlags command) override;
+    QRegion visualRegionForSelection(const QItemSelection& selection) const override;
+
+protected slots:
+    void updateGeometries() override;
 
 private slots:
     /**
@@ -78,7 +210,15 @@ private slots:
      */
     void handleScrollSpeedTimeout();
 
+    /**
+     * @brief 处理QScroller状态变化，在惯性开始时请求目标数据
+     * @param state 新状态
+     */
+    void onScrollerStateChanged(QScroller::State state);
+
 private:
+    friend class VirtualTableRowHeader;
+
     // 私有方法
     /**
      * @brief 计算当前可见区域的行范围
@@ -87,23 +227,112 @@ private:
     QPair<int, int> calculateVisibleRows() const;
 
     /**
-     * @brief 更新滚动速度
-     * @param deltaY 垂直滚动距离
+     * @brief 根据逻辑滚动偏移的变化更新滚动速度
+     */
+    void updateScrollSpeed();
+
+    /**
+     * @brief 标记可见范围需要更新，并请求重绘，实际计算在下一帧绘制前进行
+     */
+    void scheduleVisibleDataUpdate();
+
+    /**
+     * @brief 根据当前滚动速度预测下一帧需要额外覆盖的行数
+     * @return 预测行数，向下滚动为正，向上滚动为负
+     */
+    int predictedLeadRows() const;
+
+    /**
+     * @brief 以高优先级请求惯性滚动停止位置附近的数据
+     * @param targetOffset 预测的停止位置（逻辑像素偏移）
+     */
+    void requestFlingTarget(qint64 targetOffset);
+
+    /**
+     * @brief 根据模型加载吞吐量计算允许的最大惯性速度
+     * @return 像素/秒，吞吐量未知时返回0表示不限制
+     */
+    double maxFlingSpeed() const;
+
+    /**
+     * @brief 根据加载吞吐量更新QScroller的最大速度
+     */
+    void updateScrollerProperties();
+
+    /**
+     * @brief 处理触控板的惯性滚动事件
+     * @param event 滚轮事件
+     * @return 事件是否已被处理
+     */
+    bool handleKineticWheel(QWheelEvent* event);
+
+    /**
+     * @brief 清空统计，让当前模型按统计开关记录data()调用，并连接块加载和模型重置信号
+     */
+    void syncFrameCounters();
+
+    /**
+     * @brief 同步64位滚动映射的行数、行高和视口高度
+     */
+    void updateScrollMapping();
+
+    /**
+     * @brief 固定行高时内容高度是否超出表头的int像素范围，超出后不能再使用QTableView按表头计算的位置
+     * @return 是否超出
+     */
+    bool isBeyondHeaderRange() const;
+
+    /**
+     * @brief 按64位映射设置垂直滚动条的范围、步长和值（仅固定行高）
+     */
+    void updateVerticalScrollBar();
+
+    /**
+     * @brief 更新固定行高下的64位偏移，并同步滚动条、表头偏移和模型可见范围
+     * @param offset 新的像素偏移
+     * @param syncScrollBar 是否回写滚动条
+     */
+    void applyScrollOffset(qint64 offset, bool syncScrollBar);
+
+    /**
+     * @brief 把64位偏移同步到表头偏移；超出表头范围时只请求重绘
+     */
+    void syncHeaderOffset();
+
+    /**
+     * @brief 超出表头范围时按64位偏移逐行绘制可见单元格
+     * @param event 绘制事件
      */
-    void updateScrollSpeed(int deltaY);
+    void paintRowsByOffset(QPaintEvent* event);
 
     // 私有成员变量
     VirtualTableModel* m_virtualModel; // 虚拟表格模型
+    VirtualTableDelegate* m_delegate; // 单元格绘制代理
+    VirtualSelectionModel* m_selectionModel; // 行区间选择模型
+    VirtualViewHelper* m_helper; // 抽样列宽和复制选中行
+    QMetaObject::Connection m_pendingJump; // 等待后台按值查找结果的连接
     int m_bufferSize; // 缓冲区大小（行数）
     int m_fixedRowHeight; // 固定行高，如果为0则使用默认行高
     int m_visibleStartRow; // 当前可见的起始行索引
     int m_visibleEndRow; // 当前可见的结束行索引
-    QTimer m_updateTimer; // 更新可见区域的定时器
+    VirtualScrollMapper m_scrollMapper; // 逻辑像素偏移与滚动条值之间的映射
+    qint64 m_scrollOffset; // 固定行高时的64位垂直像素偏移
+    bool m_syncingScrollBar; // 正在回写滚动条，忽略由此产生的垂直滚动
     QTimer m_scrollSpeedTimer; // 滚动速度超时定时器
     QElapsedTimer m_scrollTimer; // 滚动时间计时器
-    int m_lastScrollPos; // 上一次滚动位置
-    double m_currentScrollSpeed; // 当前滚动速度（像素/秒）
+    double m_lastRowPosition; // 上一次的首行位置（带小数）
+    double m_currentScrollSpeed; // 当前滚动速度（像素/秒，向下为正）
     bool m_isInitializing; // 是否正在初始化
+    bool m_visibleRangeDirty; // 可见范围是否需要在下一帧绘制前更新
+    bool m_kineticScrollingEnabled; // 是否启用惯性滚动
+    QScrollerProperties m_defaultScrollerProperties; // QScroller的默认参数
+    QElapsedTimer m_flingTimer; // 触控板滚动事件间隔计时器
+    double m_flingVelocity; // 触控板手指离开前的滚动速度（像素/秒，向下为正）
+    FrameStats m_frameStats; // 逐帧性能统计
+    bool m_frameStatsEnabled; // 是否启用逐帧性能统计
+    bool m_frameStatsOverlayVisible; // 是否显示性能叠加层
+    QMetaObject::Connection m_blockLoadedConnection; // 块加载信号连接，用于统计滚动到数据的延迟
+    QMetaObject::Connection m_modelResetConnection; // 模型重置（更换数据源）信号连接，用于清空统计
 };
 
 #endif // VIRTUALTABLEVIEW_H
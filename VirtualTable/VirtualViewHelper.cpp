@@ -0,0 +1,66 @@
+#include "VirtualViewHelper.h"
+#include "VirtualSelectionModel.h"
+#include "VirtualTableModel.h"
+#include <QHeaderView>
+#include <QWidget>
+#include <algorithm>
+
+VirtualViewHelper::VirtualViewHelper(QWidget* view, QHeaderView* header)
+    : QObject(view)
+    , m_view(view)
+    , m_header(header)
+    , m_exporter(new TableExporter(this))
+    , m_widthEstimator(new ColumnWidthEstimator(this))
+{
+    connect(m_widthEstimator, &ColumnWidthEstimator::estimated, this, &VirtualViewHelper::applyColumnWidths);
+}
+
+VirtualViewHelper::~VirtualViewHelper()
+{
+}
+
+void VirtualViewHelper::setModel(VirtualTableModel* model, VirtualSelectionModel* selectionModel)
+{
+    m_model = model;
+    m_selectionModel = selectionModel;
+
+    // 抽样估算列宽，只读取少量分布在全表的行
+    if (model) {
+        resizeColumnsToSampledContents();
+    } else {
+        m_widthEstimator->cancel();
+    }
+}
+
+void VirtualViewHelper::resizeColumnsToSampledContents()
+{
+    if (!m_model || !m_model->dataSource())
+        return;
+
+    m_widthEstimator->estimate(m_model->dataSource(), m_view->font(), m_header->font());
+}
+
+void VirtualViewHelper::copySelection()
+{
+    // 选择模型给出选中行的区间，导出器只依赖数据源
+    if (!m_model || !m_model->dataSource() || !m_selectionModel)
+        return;
+
+    m_exporter->copyToClipboard(m_model->dataSource(), m_selectionModel->selectedRowSet());
+}
+
+TableExporter* VirtualViewHelper::exporter() const
+{
+    return m_exporter;
+}
+
+void VirtualViewHelper::applyColumnWidths(const QVector<int>& widths)
+{
+    if (!m_model)
+        return;
+
+    int columns = std::min(m_header->count(), widths.size());
+    for (int column = 0; column < columns; ++column) {
+        m_header->resizeSection(column, widths[column]);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef VIRTUALVIEWHELPER_H
+#define VIRTUALVIEWHELPER_H
+
+#include "ColumnWidthEstimator.h"
+#include "TableExporter.h"
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+class QHeaderView;
+class QWidget;
+class VirtualSelectionModel;
+class VirtualTableModel;
+
+/**
+ * @brief VirtualTableView和VirtualGridView共用的抽样列宽和复制选中行
+ *
+ * 两个视图各持有一个实例：列宽由ColumnWidthEstimator在后台抽样估算后应用到视图的列表头，
+ * 复制时把选择模型中的行区间交给TableExporter，导出器只依赖数据源
+ */
+class VirtualViewHelper : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param view 所属视图，提供单元格字体，同时作为父对象
+     * @param header 视图的列表头
+     */
+    VirtualViewHelper(QWidget* view, QHeaderView* header);
+    ~VirtualViewHelper() override;
+
+    /**
+     * @brief 设置视图当前的模型和选择模型，传入空指针时取消正在进行的列宽估算
+     * @param model 模型
+     * @param selectionModel 行区间选择模型
+     */
+    void setModel(VirtualTableModel* model, VirtualSelectionModel* selectionModel);
+
+    /**
+     * @brief 在后台抽样估算列宽，完成后应用到列表头
+     */
+    void resizeColumnsToSampledContents();
+
+    /**
+     * @brief 在后台把选中行以TSV格式复制到剪贴板，未选中时不复制
+     */
+    void copySelection();
+
+    /**
+     * @brief 获取复制使用的导出器
+     * @return 导出器
+     */
+    TableExporter* exporter() const;
+
+private:
+    /**
+     * @brief 把抽样估算的列宽应用到列表头
+     * @param widths 每列宽度
+     */
+    void applyColumnWidths(const QVector<int>& widths);
+
+    QWidget* m_view; // 所属视图
+    QHeaderView* m_header; // 视图的列表头
+    QPointer<VirtualTableModel> m_model; // 视图当前的模型
+    QPointer<VirtualSelectionModel> m_selectionModel; // 视图当前的选择模型
+    TableExporter* m_exporter; // 复制选中行使用的流式导出器
+    ColumnWidthEstimator* m_widthEstimator; // 抽样列宽估算
+};
+
+#endif // VIRTUALVIEWHELPER_H
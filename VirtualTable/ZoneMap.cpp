@@ -0,0 +1,278 @@
+#include "ZoneMap.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// 统计文件格式
+constexpr quint32 ZoneMapMagic = 0x56545A4D; // "VTZM"
+constexpr quint32 ZoneMapVersion = 1;
+
+// 每个任务处理的段数，一次loadData读取这些段的全部行
+constexpr int ZonesPerTask = 8;
+}
+
+ZoneMap::ZoneMap()
+    : m_rowCount(0)
+    , m_columnCount(0)
+{
+}
+
+int ZoneMap::zoneCount() const
+{
+    return static_cast<int>((static_cast<qint64>(m_rowCount) + ZoneRows - 1) / ZoneRows);
+}
+
+int ZoneMap::columnCount() const
+{
+    return m_columnCount;
+}
+
+int ZoneMap::rowCount() const
+{
+    return m_rowCount;
+}
+
+bool ZoneMap::isNumericColumn(int column) const
+{
+    return column >= 0 && column < m_numericColumns.size() && m_numericColumns[column];
+}
+
+int ZoneMap::nullCount(int zone, int column) const
+{
+    if (zone < 0 || zone >= zoneCount() || column < 0 || column >= m_columnCount)
+        return 0;
+    return this->zone(zone, column).nullCount;
+}
+
+RowRangeSet ZoneMap::candidateRows(int column, const QString& value, ColumnIndex::Match match) const
+{
+    RowRangeSet result;
+    if (column < 0 || column >= m_columnCount) {
+        if (m_rowCount > 0)
+            result.addRange(0, m_rowCount - 1);
+        return result;
+    }
+
+    const bool numeric = m_numericColumns[column];
+    const bool findNull = value.isEmpty() && match == ColumnIndex::Match::Equal;
+    double number = 0.0;
+    if (numeric && !findNull) {
+        bool ok = false;
+        number = value.trimmed().toDouble(&ok);
+        if (!ok)
+            return result;
+    }
+
+    const int zones = zoneCount();
+    for (int z = 0; z < zones; ++z) {
+        const Zone& stats = zone(z, column);
+
+        bool possible = false;
+        if (findNull) {
+            possible = stats.nullCount > 0;
+        } else if (stats.valueCount == 0) {
+            possible = false;
+        } else if (numeric) {
+            possible = (match == ColumnIndex::Match::Equal)
+                ? (stats.minimum <= number && number <= stats.maximum)
+                : stats.maximum >= number;
+        } else {
+            possible = (match == ColumnIndex::Match::Equal)
+                ? (stats.minimumText <= value && value <= stats.maximumText)
+                : stats.maximumText >= value;
+        }
+
+        if (possible) {
+            const int first = z * ZoneRows;
+            const int last = static_cast<int>(std::min<qint64>(static_cast<qint64>(first) + ZoneRows, m_rowCount)) - 1;
+            result.addRange(first, last);
+        }
+    }
+    return result;
+}
+
+bool ZoneMap::matches(int column, const QString& cell, const QString& value, ColumnIndex::Match match) const
+{
+    if (cell.isEmpty())
+        return value.isEmpty() && match == ColumnIndex::Match::Equal;
+
+    if (isNumericColumn(column)) {
+        bool ok = false;
+        const double number = value.trimmed().toDouble(&ok);
+        if (!ok)
+            return false;
+        const double cellNumber = cell.trimmed().toDouble();
+        return (match == ColumnIndex::Match::Equal) ? cellNumber == number : cellNumber >= number;
+    }
+
+    return (match == ColumnIndex::Match::Equal) ? cell == value : cell >= value;
+}
+
+std::shared_ptr<ZoneMap> ZoneMap::build(std::shared_ptr<DataSource> source, QThreadPool* pool,
+    const std::atomic<bool>& cancelled)
+{
+    if (!source)
+        return nullptr;
+
+    std::shared_ptr<ZoneMap> map(new ZoneMap);
+    map->m_rowCount = source->rowCount();
+    map->m_columnCount = source->columnCount();
+    const int zones = map->zoneCount();
+    const int columnCount = map->m_columnCount;
+    map->m_zones.resize(zones * columnCount);
+
+    // 各任务写入互不重叠的段，不需要加锁
+    Zone* output = map->m_zones.data();
+    const int rowCount = map->m_rowCount;
+    QVector<QFuture<void>> tasks;
+    for (int firstZone = 0; firstZone < zones; firstZone += ZonesPerTask) {
+        tasks.append(QtConcurrent::run(pool, [source, output, firstZone, zones, columnCount, rowCount, &cancelled]() {
+            if (cancelled)
+                return;
+            const int lastZone = std::min(firstZone + ZonesPerTask, zones);
+            const int startRow = firstZone * ZoneRows;
+            const int count = static_cast<int>(std::min<qint64>(static_cast<qint64>(lastZone) * ZoneRows, rowCount)) - startRow;
+            const QList<QList<QVariant>> rows = source->loadData(startRow, count);
+
+            for (int i = 0; i < rows.size(); ++i) {
+                const QList<QVariant>& rowData = rows[i];
+                Zone* zoneRow = output + static_cast<qint64>((startRow + i) / ZoneRows) * columnCount;
+                for (int column = 0; column < columnCount; ++column) {
+                    Zone& stats = zoneRow[column];
+                    const QString text = column < rowData.size() ? rowData[column].toString() : QString();
+                    if (text.isEmpty()) {
+                        ++stats.nullCount;
+                        continue;
+                    }
+
+                    if (stats.valueCount == 0) {
+                        stats.minimumText = text;
+                        stats.maximumText = text;
+                    } else if (text < stats.minimumText) {
+                        stats.minimumText = text;
+                    } else if (stats.maximumText < text) {
+                        stats.maximumText = text;
+                    }
+
+                    if (stats.numeric) {
+                        bool ok = false;
+                        const double number = text.trimmed().toDouble(&ok);
+                        if (ok && number == number) {
+                            stats.minimum = stats.valueCount == 0 ? number : std::min(stats.minimum, number);
+                            stats.maximum = stats.valueCount == 0 ? number : std::max(stats.maximum, number);
+                        } else {
+                            stats.numeric = false;
+                        }
+                    }
+                    ++stats.valueCount;
+                }
+            }
+        }));
+    }
+    for (QFuture<void>& task : tasks)
+        task.waitForFinished();
+
+    if (cancelled)
+        return nullptr;
+
+    map->updateNumericColumns();
+    return map;
+}
+
+QString ZoneMap::zoneMapPath(const QString& sourcePath)
+{
+    return sourcePath + QStringLiteral(".vtzone");
+}
+
+std::shared_ptr<ZoneMap> ZoneMap::load(const QString& sourcePath, int rowCount, int columnCount)
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    if (sourcePath.isEmpty() || !DataSource::persistentStamp(sourcePath, &size, &modified))
+        return nullptr;
+
+    QFile file(zoneMapPath(sourcePath));
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    // 文件头与数据源不一致时视为过期
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 storedSize = 0;
+    qint64 storedModified = 0;
+    qint32 storedRowCount = 0;
+    qint32 storedColumnCount = 0;
+    qint32 zoneRows = 0;
+    in >> magic >> version >> storedSize >> storedModified >> storedRowCount >> storedColumnCount >> zoneRows;
+    if (in.status() != QDataStream::Ok || magic != ZoneMapMagic || version != ZoneMapVersion
+        || storedSize != size || storedModified != modified || storedRowCount != rowCount
+        || storedColumnCount != columnCount || zoneRows != ZoneRows)
+        return nullptr;
+
+    std::shared_ptr<ZoneMap> map(new ZoneMap);
+    map->m_rowCount = rowCount;
+    map->m_columnCount = columnCount;
+    map->m_zones.resize(map->zoneCount() * columnCount);
+    for (Zone& stats : map->m_zones) {
+        in >> stats.minimum >> stats.maximum >> stats.minimumText >> stats.maximumText
+            >> stats.nullCount >> stats.valueCount >> stats.numeric;
+    }
+    if (in.status() != QDataStream::Ok)
+        return nullptr;
+
+    map->updateNumericColumns();
+    return map;
+}
+
+bool ZoneMap::save(const QString& sourcePath) const
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    if (sourcePath.isEmpty() || !DataSource::persistentStamp(sourcePath, &size, &modified))
+        return false;
+
+    // 先写临时文件再替换，中途失败不会留下损坏的统计
+    QSaveFile file(zoneMapPath(sourcePath));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << ZoneMapMagic << ZoneMapVersion << size << modified << static_cast<qint32>(m_rowCount)
+        << static_cast<qint32>(m_columnCount) << static_cast<qint32>(ZoneRows);
+    for (const Zone& stats : m_zones) {
+        out << stats.minimum << stats.maximum << stats.minimumText << stats.maximumText
+            << stats.nullCount << stats.valueCount << stats.numeric;
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+void ZoneMap::updateNumericColumns()
+{
+    m_numericColumns.fill(true, m_columnCount);
+    const int zones = zoneCount();
+    for (int z = 0; z < zones; ++z) {
+        for (int column = 0; column < m_columnCount; ++column) {
+            const Zone& stats = zone(z, column);
+            if (stats.valueCount > 0 && !stats.numeric)
+                m_numericColumns[column] = false;
+        }
+    }
+}
+
+const ZoneMap::Zone& ZoneMap::zone(int zone, int column) const
+{
+    return m_zones[zone * m_columnCount + column];
+}
@@ -0,0 +1,145 @@
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include "ColumnIndex.h"
+#include "DataSource.h"
+#include "RowRangeSet.h"
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief 区间统计（zone map），按固定行数分段记录每列的最小值、最大值和空值数
+ *
+ * 对id、注册时间这类基本有序的列，一个值只可能出现在少数几段中：
+ * 查找和筛选前先用candidateRows()排除不可能匹配的段，只读取剩下的几块，而不是扫描整个文件。
+ * 比较规则与ColumnIndex一致：一列的非空值全部是数字时按数值比较，否则按文本比较。
+ * 统计在线程池中按段并行计算，数据源有对应文件时保存在文件旁边，文件不变时直接读取。
+ */
+class ZoneMap {
+public:
+    /**
+     * @brief 每段的行数
+     */
+    static constexpr int ZoneRows = 8192;
+
+    /**
+     * @brief 获取段数
+     * @return 段数
+     */
+    int zoneCount() const;
+
+    /**
+     * @brief 获取列数
+     * @return 列数
+     */
+    int columnCount() const;
+
+    /**
+     * @brief 获取统计时数据源的行数
+     * @return 行数
+     */
+    int rowCount() const;
+
+    /**
+     * @brief 列的非空值是否全部为数字
+     * @param column 列索引
+     * @return 是否为数值列
+     */
+    bool isNumericColumn(int column) const;
+
+    /**
+     * @brief 获取一段中某列的空值数
+     * @param zone 段索引
+     * @param column 列索引
+     * @return 空值数
+     */
+    int nullCount(int zone, int column) const;
+
+    /**
+     * @brief 找出可能包含匹配值的行
+     * @param column 列索引
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 可能匹配的行区间，按段对齐；列无效时返回全部行
+     */
+    RowRangeSet candidateRows(int column, const QString& value, ColumnIndex::Match match) const;
+
+    /**
+     * @brief 判断单元格是否匹配，比较规则与candidateRows()一致
+     * @param column 列索引
+     * @param cell 单元格文本
+     * @param value 查找的值
+     * @param match 查找方式
+     * @return 是否匹配
+     */
+    bool matches(int column, const QString& cell, const QString& value, ColumnIndex::Match match) const;
+
+    /**
+     * @brief 在当前线程中统计，分段任务在线程池中并行执行
+     * @param source 数据源
+     * @param pool 线程池
+     * @param cancelled 取消标志
+     * @return 区间统计，取消时返回nullptr
+     */
+    static std::shared_ptr<ZoneMap> build(std::shared_ptr<DataSource> source, QThreadPool* pool,
+        const std::atomic<bool>& cancelled);
+
+    /**
+     * @brief 获取统计文件路径
+     * @param sourcePath 数据源文件路径
+     * @return 统计文件路径
+     */
+    static QString zoneMapPath(const QString& sourcePath);
+
+    /**
+     * @brief 从统计文件读取
+     * @param sourcePath 数据源文件路径
+     * @param rowCount 数据源当前行数
+     * @param columnCount 数据源当前列数
+     * @return 区间统计，文件不存在或已过期时返回nullptr
+     */
+    static std::shared_ptr<ZoneMap> load(const QString& sourcePath, int rowCount, int columnCount);
+
+    /**
+     * @brief 保存到数据源文件旁边的统计文件
+     * @param sourcePath 数据源文件路径
+     * @return 是否保存成功
+     */
+    bool save(const QString& sourcePath) const;
+
+private:
+    /**
+     * @brief 一段中一列的统计
+     */
+    struct Zone {
+        double minimum = 0.0; // 数值最小值
+        double maximum = 0.0; // 数值最大值
+        QString minimumText; // 文本最小值
+        QString maximumText; // 文本最大值
+        qint32 nullCount = 0; // 空值数
+        qint32 valueCount = 0; // 非空值数
+        bool numeric = true; // 非空值是否全部为数字
+    };
+
+    ZoneMap();
+
+    /**
+     * @brief 根据各段统计确定每列的比较方式
+     */
+    void updateNumericColumns();
+
+    /**
+     * @brief 获取一段中一列的统计
+     */
+    const Zone& zone(int zone, int column) const;
+
+    int m_rowCount; // 统计时的行数
+    int m_columnCount; // 列数
+    QVector<Zone> m_zones; // 各段统计，按段优先排列（段 * 列数 + 列）
+    QVector<bool> m_numericColumns; // 各列是否为数值列
+};
+
+#endif // ZONEMAP_H